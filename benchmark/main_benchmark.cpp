@@ -0,0 +1,481 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "xdisasm.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include "xdisasmgenerator.h"
+#include "xdisasmmodel.h"
+#include "xdisasmrowformatter.h"
+
+struct BENCHMARK_RESULT
+{
+    QString sType;
+    qint64 nFileSize;
+    qint64 nInstructions;
+    qint64 nExpectedInstructions;
+    qint64 nCalls; // call instructions
+    qint64 nExpectedCalls;
+    qint64 nJumps; // jump instructions
+    qint64 nExpectedJumps;
+    qint64 nPositions;
+    qint64 nTotalTime; // all times in nsec
+    qint64 nPhaseTime[XDisasm::__PHASE_SIZE]; // PHASE_STAT::nTime, -1 if the phase has not run
+    qint64 nSignatureTime;
+    qint64 nRows;
+    qint64 nRowsTime;
+    qint64 nFormatRows; // 16-byte data rows
+    qint64 nFormatTime;
+    qint64 nFormatLegacyTime; // XBinary::valueToHex and QByteArray::toHex
+    qint64 nLookups;
+    qint64 nPositionToAddressTime;
+    qint64 nAddressToPositionTime;
+    qint64 nPeakMemory;
+};
+
+static double perSecond(qint64 nCount, qint64 nTime)
+{
+    return (nCount*1000000000.0)/qMax(nTime,(qint64)1);
+}
+
+static quint64 nextRandom(quint64 *pnState)
+{
+    // LCG: the sequence must be the same between runs
+    *pnState=(*pnState)*6364136223846793005ULL+1442695040888963407ULL;
+
+    return (*pnState)>>33;
+}
+
+static bool runBenchmark(XDisasmGenerator::OPTIONS *pGeneratorOptions, qint64 nOpcodeLimit, QString sDirectory, qint32 nIterations, qint64 nRows, BENCHMARK_RESULT *pResult)
+{
+    bool bResult=false;
+
+    XBinary::FT fileType=pGeneratorOptions->fileType;
+
+    *pResult={};
+    pResult->sType=XBinary::fileTypeIdToString(fileType);
+
+    XDisasmGenerator::RESULT generatorResult={};
+
+    QString sFileName=QString("%1/%2_%3").arg(sDirectory).arg(pResult->sType).arg(pGeneratorOptions->nSize);
+
+    if(!XDisasmGenerator::isLayoutValid(pGeneratorOptions))
+    {
+        QTextStream(stderr)<<QString("%1 %2: %3").arg(pResult->sType).arg(pGeneratorOptions->nSize).arg("the image is too large for the headers")<<endl;
+
+        return false;
+    }
+
+    if(!XDisasmGenerator::generate(pGeneratorOptions,sFileName,&generatorResult))
+    {
+        return false;
+    }
+
+    QFile file;
+    file.setFileName(sFileName);
+
+    if(file.open(QIODevice::ReadOnly))
+    {
+        pResult->nFileSize=generatorResult.nFileSize;
+        pResult->nExpectedInstructions=generatorResult.nInstructions;
+        pResult->nExpectedCalls=generatorResult.nCalls;
+        pResult->nExpectedJumps=generatorResult.nJumps;
+
+        XDisasm::OPTIONS options={};
+        options.ft=fileType;
+        options.nImageBase=-1;
+        options.nOpcodeLimit=nOpcodeLimit;
+
+        XDisasm disasm;
+
+        pResult->nTotalTime=-1;
+
+        for(qint32 i=0;i<XDisasm::__PHASE_SIZE;i++)
+        {
+            pResult->nPhaseTime[i]=-1;
+        }
+
+        bResult=true;
+
+        // Every phase runs through processDisasm, the best time of each phase is reported
+        for(qint32 i=0;(i<nIterations)&&bResult;i++)
+        {
+            options.stats={};
+
+            QElapsedTimer timer;
+            timer.start();
+
+            disasm.setData(&file,&options,-1,XDisasm::DM_DISASM);
+            disasm.process();
+
+            qint64 nTime=timer.nsecsElapsed();
+
+            if((pResult->nTotalTime==-1)||(nTime<pResult->nTotalTime))
+            {
+                pResult->nTotalTime=nTime;
+            }
+
+            for(qint32 j=0;j<XDisasm::__PHASE_SIZE;j++)
+            {
+                const XDisasm::PHASE_STAT *pPhaseStat=&(options.stats.phaseStat[j]);
+
+                if(pPhaseStat->nCount&&((pResult->nPhaseTime[j]==-1)||(pPhaseStat->nTime<pResult->nPhaseTime[j])))
+                {
+                    pResult->nPhaseTime[j]=pPhaseStat->nTime;
+                }
+            }
+
+            bResult=options.stats.bInit;
+        }
+
+        if(bResult)
+        {
+            pResult->nInstructions=options.stats.mapRecords.count()-options.stats.nStringRecords;
+            pResult->nPositions=options.stats.nPositions;
+
+            QMapIterator<qint64,XDisasm::RECORD> iRecords(options.stats.mapRecords);
+            while(iRecords.hasNext())
+            {
+                iRecords.next();
+
+                if(iRecords.value().nFlags&XDisasm::RF_CALL)
+                {
+                    pResult->nCalls++;
+                }
+                else if(iRecords.value().nFlags&(XDisasm::RF_JUMP|XDisasm::RF_CONDJUMP))
+                {
+                    pResult->nJumps++;
+                }
+            }
+
+            // The generator knows every instruction, anything else is a bug or a limit
+            QString sType=QString("%1 %2").arg(pResult->sType).arg(pGeneratorOptions->nSize);
+
+            if(pResult->nInstructions!=pResult->nExpectedInstructions)
+            {
+                QTextStream(stderr)<<QString("%1: %2 %3, %4 %5").arg(sType).arg(pResult->nInstructions).arg("instructions").arg(pResult->nExpectedInstructions).arg("expected")<<endl;
+
+                bResult=false;
+            }
+
+            if(pResult->nCalls!=pResult->nExpectedCalls)
+            {
+                QTextStream(stderr)<<QString("%1: %2 %3, %4 %5").arg(sType).arg(pResult->nCalls).arg("calls").arg(pResult->nExpectedCalls).arg("expected")<<endl;
+
+                bResult=false;
+            }
+
+            if(pResult->nJumps!=pResult->nExpectedJumps)
+            {
+                QTextStream(stderr)<<QString("%1: %2 %3, %4 %5").arg(sType).arg(pResult->nJumps).arg("jumps").arg(pResult->nExpectedJumps).arg("expected")<<endl;
+
+                bResult=false;
+            }
+        }
+
+        if(bResult)
+        {
+            XDisasm::SIGNATURE_OPTIONS signatureOptions={};
+            signatureOptions.csarch=options.stats.csarch;
+            signatureOptions.csmode=options.stats.csmode;
+            signatureOptions.memoryMap=options.stats.memoryMap;
+            signatureOptions.pDevice=&file;
+            signatureOptions.nCount=100;
+            signatureOptions.sm=XDisasm::SM_NORMAL;
+
+            QElapsedTimer timerSignature;
+            timerSignature.start();
+
+            for(qint32 i=0;i<nIterations;i++)
+            {
+                XDisasm::getSignature(&signatureOptions,options.stats.nEntryPointAddress);
+            }
+
+            pResult->nSignatureTime=timerSignature.nsecsElapsed()/qMax(nIterations,1);
+
+            XDisasmModel::SHOWOPTIONS showOptions={};
+            showOptions.bShowLabels=true;
+
+            XDisasmModel model(&file,XDisasm::getSnapshot(&options),&showOptions,0);
+
+            pResult->nRows=qMin(nRows,pResult->nPositions);
+
+            QElapsedTimer timerRows;
+            timerRows.start();
+
+            for(qint64 i=0;i<pResult->nRows;i++)
+            {
+                model.getViewRecord(i);
+            }
+
+            pResult->nRowsTime=timerRows.nsecsElapsed();
+
+            // Address, offset and bytes of 16-byte data rows, the formatting part of getViewRecord
+            file.seek(0);
+            QByteArray baRows=file.read(qMin(nRows*16,file.size()));
+            pResult->nFormatRows=baRows.size()/16;
+
+            XDisasmRowFormatter formatter;
+
+            QElapsedTimer timerFormat;
+            timerFormat.start();
+
+            for(qint64 i=0;i<pResult->nFormatRows;i++)
+            {
+                formatter.addressToString(options.stats.nImageBase+i*16);
+                formatter.offsetToString(i*16);
+                formatter.bytesToString(baRows.constData()+i*16,16);
+            }
+
+            pResult->nFormatTime=timerFormat.nsecsElapsed();
+
+            timerFormat.start();
+
+            for(qint64 i=0;i<pResult->nFormatRows;i++)
+            {
+                XBinary::valueToHex((quint32)(options.stats.nImageBase+i*16));
+                XBinary::valueToHex((quint32)(i*16));
+                QString(baRows.mid(i*16,16).toHex());
+            }
+
+            pResult->nFormatLegacyTime=timerFormat.nsecsElapsed();
+
+            pResult->nLookups=nRows;
+
+            quint64 nState=1;
+
+            QElapsedTimer timerLookups;
+            timerLookups.start();
+
+            for(qint64 i=0;i<pResult->nLookups;i++)
+            {
+                model.positionToAddress(nextRandom(&nState)%qMax(pResult->nPositions,(qint64)1));
+            }
+
+            pResult->nPositionToAddressTime=timerLookups.nsecsElapsed();
+
+            nState=1;
+
+            qint64 nImageBase=options.stats.nImageBase;
+            qint64 nImageSize=qMax(options.stats.nImageSize,(qint64)1);
+
+            timerLookups.start();
+
+            for(qint64 i=0;i<pResult->nLookups;i++)
+            {
+                model.addressToPosition(nImageBase+(qint64)(nextRandom(&nState)%nImageSize));
+            }
+
+            pResult->nAddressToPositionTime=timerLookups.nsecsElapsed();
+        }
+
+        file.close();
+    }
+
+    file.remove();
+
+    pResult->nPeakMemory=XDisasm::getPeakMemoryUsage();
+
+    return bResult;
+}
+
+static QJsonObject resultToJson(BENCHMARK_RESULT *pResult)
+{
+    QJsonObject result;
+
+    result.insert("type",pResult->sType);
+    result.insert("file_size",pResult->nFileSize);
+    result.insert("instructions",pResult->nInstructions);
+    result.insert("expected_instructions",pResult->nExpectedInstructions);
+    result.insert("calls",pResult->nCalls);
+    result.insert("jumps",pResult->nJumps);
+    result.insert("positions",pResult->nPositions);
+    result.insert("total_ns",pResult->nTotalTime);
+
+    QJsonObject phases;
+
+    for(qint32 i=0;i<XDisasm::__PHASE_SIZE;i++)
+    {
+        if(pResult->nPhaseTime[i]!=-1)
+        {
+            phases.insert(XDisasm::phaseIdToString((XDisasm::PHASE)i),pResult->nPhaseTime[i]);
+        }
+    }
+
+    result.insert("phases_ns",phases);
+    result.insert("signature_ns",pResult->nSignatureTime);
+    result.insert("instructions_per_second",perSecond(pResult->nInstructions,pResult->nPhaseTime[XDisasm::PHASE_TRAVERSAL]));
+    result.insert("rows_per_second",perSecond(pResult->nRows,pResult->nRowsTime));
+    result.insert("format_rows_per_second",perSecond(pResult->nFormatRows,pResult->nFormatTime));
+    result.insert("format_legacy_rows_per_second",perSecond(pResult->nFormatRows,pResult->nFormatLegacyTime));
+    result.insert("position_to_address_per_second",perSecond(pResult->nLookups,pResult->nPositionToAddressTime));
+    result.insert("address_to_position_per_second",perSecond(pResult->nLookups,pResult->nAddressToPositionTime));
+    result.insert("peak_memory",pResult->nPeakMemory);
+
+    return result;
+}
+
+static void printResult(QTextStream *pStream, BENCHMARK_RESULT *pResult)
+{
+    (*pStream)<<QString("%1 %2 bytes, %3 instructions (%4 expected), %5 calls, %6 jumps, %7 positions").arg(pResult->sType).arg(pResult->nFileSize).arg(pResult->nInstructions).arg(pResult->nExpectedInstructions).arg(pResult->nCalls).arg(pResult->nJumps).arg(pResult->nPositions)<<endl;
+    (*pStream)<<QString("    processDisasm:      %1 ms").arg(pResult->nTotalTime/1000000.0,0,'f',2)<<endl;
+
+    for(qint32 i=0;i<XDisasm::__PHASE_SIZE;i++)
+    {
+        if(pResult->nPhaseTime[i]!=-1)
+        {
+            QString sPhase=QString("%1:").arg(XDisasm::phaseIdToString((XDisasm::PHASE)i));
+
+            (*pStream)<<QString("      %1 %2 ms").arg(sPhase,-18).arg(pResult->nPhaseTime[i]/1000000.0,0,'f',2);
+
+            if(i==XDisasm::PHASE_TRAVERSAL)
+            {
+                (*pStream)<<QString(", %1 instructions/s").arg(perSecond(pResult->nInstructions,pResult->nPhaseTime[i]),0,'f',0);
+            }
+
+            (*pStream)<<endl;
+        }
+    }
+
+    (*pStream)<<QString("    getSignature:       %1 us").arg(pResult->nSignatureTime/1000.0,0,'f',2)<<endl;
+    (*pStream)<<QString("    getViewRecord:      %1 rows/s").arg(perSecond(pResult->nRows,pResult->nRowsTime),0,'f',0)<<endl;
+    (*pStream)<<QString("    row formatter:      %1 rows/s (valueToHex/toHex: %2 rows/s)").arg(perSecond(pResult->nFormatRows,pResult->nFormatTime),0,'f',0).arg(perSecond(pResult->nFormatRows,pResult->nFormatLegacyTime),0,'f',0)<<endl;
+    (*pStream)<<QString("    positionToAddress:  %1 /s").arg(perSecond(pResult->nLookups,pResult->nPositionToAddressTime),0,'f',0)<<endl;
+    (*pStream)<<QString("    addressToPosition:  %1 /s").arg(perSecond(pResult->nLookups,pResult->nAddressToPositionTime),0,'f',0)<<endl;
+    (*pStream)<<QString("    peak memory:        %1 MB").arg(pResult->nPeakMemory/(1024.0*1024.0),0,'f',1)<<endl;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc,argv);
+    QCoreApplication::setApplicationName("xdisasmbenchmark");
+    QCoreApplication::setApplicationVersion("1.00");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("XDisasm benchmark");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption clSizes("sizes","Comma separated code sizes in KB.","list","256,1024,4096,16384");
+    QCommandLineOption clTypes("types","Comma separated file types.","list","PE32,ELF64,Binary32");
+    QCommandLineOption clIterations("iterations","Iterations per measurement (best is reported).","count","3");
+    QCommandLineOption clRows("rows","Rows and lookups per model measurement.","count","100000");
+    QCommandLineOption clJson(QStringList()<<"j"<<"json","One JSON record per input.");
+    QCommandLineOption clBody("body","Instructions in a function body.","count","4");
+    QCommandLineOption clJumps("jumps","Conditional jumps per function.","count","1");
+    QCommandLineOption clPadding("padding","int3 padding, percent of the function size.","percent","0");
+    QCommandLineOption clData("data","Unreachable data, percent of the code section.","percent","0");
+    QCommandLineOption clSparse("sparse","Data blocks are holes in the file.");
+    QCommandLineOption clVirtualSize("virtualsize","Size of an uninitialized section in KB.","kbytes","0");
+    QCommandLineOption clOpcodeLimit("opcodelimit","Maximum number of instructions (0 - default, -1 - no limit).","count","-1");
+
+    parser.addOption(clSizes);
+    parser.addOption(clTypes);
+    parser.addOption(clIterations);
+    parser.addOption(clRows);
+    parser.addOption(clJson);
+    parser.addOption(clBody);
+    parser.addOption(clJumps);
+    parser.addOption(clPadding);
+    parser.addOption(clData);
+    parser.addOption(clSparse);
+    parser.addOption(clVirtualSize);
+    parser.addOption(clOpcodeLimit);
+
+    parser.process(app);
+
+    QList<XBinary::FT> listFileTypes;
+    listFileTypes.append(XBinary::FT_PE32);
+    listFileTypes.append(XBinary::FT_PE64);
+    listFileTypes.append(XBinary::FT_ELF64);
+    listFileTypes.append(XBinary::FT_BINARY32);
+    listFileTypes.append(XBinary::FT_BINARY64);
+
+    QStringList listTypes=parser.value(clTypes).split(",");
+    QStringList listSizes=parser.value(clSizes).split(",");
+
+    qint32 nIterations=qMax(parser.value(clIterations).toInt(),1);
+    qint64 nRows=parser.value(clRows).toLongLong();
+    qint64 nOpcodeLimit=parser.value(clOpcodeLimit).toLongLong();
+
+    XDisasmGenerator::OPTIONS generatorOptions={};
+    generatorOptions.nBodyCount=parser.value(clBody).toInt();
+    generatorOptions.nJumpCount=parser.value(clJumps).toInt();
+    generatorOptions.nPaddingRatio=parser.value(clPadding).toInt();
+    generatorOptions.nDataRatio=parser.value(clData).toInt();
+    generatorOptions.bSparse=parser.isSet(clSparse);
+    generatorOptions.nVirtualSize=parser.value(clVirtualSize).toLongLong()*1024;
+    generatorOptions.nSeed=1;
+
+    QTemporaryDir temporaryDir;
+
+    if(!temporaryDir.isValid())
+    {
+        QTextStream(stderr)<<"Cannot create temporary directory"<<endl;
+
+        return 1;
+    }
+
+    QTextStream stream(stdout);
+
+    int nResult=0;
+
+    for(int i=0;i<listFileTypes.count();i++)
+    {
+        XBinary::FT fileType=listFileTypes.at(i);
+
+        if(!listTypes.contains(XBinary::fileTypeIdToString(fileType),Qt::CaseInsensitive))
+        {
+            continue;
+        }
+
+        for(int j=0;j<listSizes.count();j++)
+        {
+            BENCHMARK_RESULT result={};
+
+            generatorOptions.fileType=fileType;
+            generatorOptions.nSize=listSizes.at(j).toLongLong()*1024;
+
+            if(runBenchmark(&generatorOptions,nOpcodeLimit,temporaryDir.path(),nIterations,nRows,&result))
+            {
+                if(parser.isSet(clJson))
+                {
+                    stream<<QJsonDocument(resultToJson(&result)).toJson(QJsonDocument::Compact)<<endl;
+                }
+                else
+                {
+                    printResult(&stream,&result);
+                }
+            }
+            else
+            {
+                QTextStream(stderr)<<QString("%1: %2 %3").arg("Cannot run benchmark").arg(result.sType).arg(listSizes.at(j))<<endl;
+
+                nResult=1;
+            }
+        }
+    }
+
+    return nResult;
+}
@@ -0,0 +1,15 @@
+QT -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = xdisasmbenchmark
+TEMPLATE = app
+
+SOURCES += \
+    main_benchmark.cpp
+
+!contains(XCONFIG, xdisasmcore) {
+    XCONFIG += xdisasmcore
+    include($$PWD/../xdisasmcore.pri)
+}
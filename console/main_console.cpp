@@ -0,0 +1,554 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "xdisasm.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include "xdisasmexport.h"
+#include "xdisasmbatch.h"
+#include "xdisasmgenerator.h"
+#include "xdisasmsignaturescanner.h"
+#include "xdisasmlisting.h"
+#include "xdisasmmodel.h"
+
+static bool stringToAddress(QString sString, qint64 *pnAddress)
+{
+    bool bResult=false;
+
+    *pnAddress=sString.toLongLong(&bResult,0);
+
+    return bResult;
+}
+
+static bool stringToSize(QString sString, qint64 *pnSize)
+{
+    bool bResult=false;
+
+    qint64 nMultiplier=1;
+
+    if(sString.endsWith("K",Qt::CaseInsensitive))
+    {
+        nMultiplier=1024;
+    }
+    else if(sString.endsWith("M",Qt::CaseInsensitive))
+    {
+        nMultiplier=1024*1024;
+    }
+    else if(sString.endsWith("G",Qt::CaseInsensitive))
+    {
+        nMultiplier=1024*1024*1024;
+    }
+
+    if(nMultiplier!=1)
+    {
+        sString.chop(1);
+    }
+
+    *pnSize=sString.toLongLong(&bResult,0)*nMultiplier;
+
+    return bResult;
+}
+
+static XBinary::FT getFileType(QIODevice *pDevice, QString sType)
+{
+    XBinary::FT result=XBinary::FT_UNKNOWN;
+
+    QSet<XBinary::FT> stFT=XBinary::getFileTypes(pDevice);
+
+    stFT.insert(XBinary::FT_BINARY16);
+    stFT.insert(XBinary::FT_BINARY32);
+    stFT.insert(XBinary::FT_BINARY64);
+    stFT.insert(XBinary::FT_COM);
+
+    QList<XBinary::FT> listFileTypes=XBinary::_getFileTypeListFromSet(stFT);
+
+    int nCount=listFileTypes.count();
+
+    for(int i=0;i<nCount;i++)
+    {
+        if(XBinary::fileTypeIdToString(listFileTypes.at(i)).compare(sType,Qt::CaseInsensitive)==0)
+        {
+            result=listFileTypes.at(i);
+
+            break;
+        }
+    }
+
+    return result;
+}
+
+static void printError(QString sText)
+{
+    QTextStream(stderr)<<sText<<endl;
+}
+
+// Writes the trace when main returns, on every path after the analysis
+class TraceGuard
+{
+public:
+    explicit TraceGuard(QString sFileName)
+    {
+        this->sFileName=sFileName;
+    }
+
+    ~TraceGuard()
+    {
+        if(sFileName!="")
+        {
+            if(!XDisasmTrace::save(sFileName))
+            {
+                printError(QString("%1: %2").arg("Cannot create file").arg(sFileName));
+            }
+        }
+    }
+
+private:
+    QString sFileName;
+};
+
+static bool openOutput(QFile *pFile, QString sFileName)
+{
+    bool bResult=false;
+
+    if(sFileName!="")
+    {
+        pFile->setFileName(sFileName);
+
+        bResult=pFile->open(QIODevice::WriteOnly|QIODevice::Truncate);
+
+        if(!bResult)
+        {
+            printError(QString("%1: %2").arg("Cannot create file").arg(sFileName));
+        }
+    }
+    else
+    {
+        bResult=pFile->open(stdout,QIODevice::WriteOnly);
+    }
+
+    return bResult;
+}
+
+static int processBatch(QList<QString> listPaths, XDisasmBatch::OPTIONS *pOptions, QString sOutputFileName)
+{
+    pOptions->listFileNames=XDisasmBatch::getFileNames(listPaths);
+
+    QFile fileOutput;
+
+    if(!openOutput(&fileOutput,sOutputFileName))
+    {
+        return 1;
+    }
+
+    XDisasmBatch batch;
+    batch.setData(pOptions,&fileOutput);
+    batch.process();
+
+    XDisasmBatch::RESULT result=batch.getResult();
+
+    QTextStream(stderr)<<QJsonDocument(XDisasmBatch::resultToJson(&result)).toJson(QJsonDocument::Compact)<<endl;
+
+    fileOutput.close();
+
+    // A file that failed or hit a limit
+    return (result.nErrors!=0)?1:0;
+}
+
+static int processGenerate(QString sFileName, XDisasmGenerator::OPTIONS *pOptions, QString sOutputFileName)
+{
+    XDisasmGenerator::RESULT result={};
+
+    if(!XDisasmGenerator::isLayoutValid(pOptions))
+    {
+        printError(QString("%1: %2").arg("The image is too large for the headers").arg(XBinary::fileTypeIdToString(pOptions->fileType)));
+
+        return 1;
+    }
+
+    if(!XDisasmGenerator::generate(pOptions,sFileName,&result))
+    {
+        printError(QString("%1: %2").arg("Cannot create file").arg(sFileName));
+
+        return 1;
+    }
+
+    QFile fileOutput;
+
+    if(!openOutput(&fileOutput,sOutputFileName))
+    {
+        return 1;
+    }
+
+    QJsonObject jsonResult=XDisasmGenerator::resultToJson(&result);
+    jsonResult.insert("file",sFileName);
+    jsonResult.insert("type",XBinary::fileTypeIdToString(pOptions->fileType));
+
+    fileOutput.write(QJsonDocument(jsonResult).toJson());
+    fileOutput.close();
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc,argv);
+    QCoreApplication::setApplicationName("xdisasmconsole");
+    QCoreApplication::setApplicationVersion("1.00");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("XDisasm console");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("file","The file to analyze (batch mode: files, directories or @listfile).");
+
+    QCommandLineOption clType(QStringList()<<"t"<<"type","File type (PE32, ELF64, Binary32 ...).","type");
+    QCommandLineOption clImage(QStringList()<<"i"<<"image","The file is a memory image.");
+    QCommandLineOption clImageBase(QStringList()<<"b"<<"imagebase","Image base.","address");
+    QCommandLineOption clStart(QStringList()<<"s"<<"start","Additional start address.","address");
+    QCommandLineOption clOutput(QStringList()<<"o"<<"output","Output file (stdout if not set).","file");
+    QCommandLineOption clJson(QStringList()<<"j"<<"json","Write the result as JSON.");
+    QCommandLineOption clSections("sections","Comma separated list of: instructions,functions,xrefs,labels,memory.","list","instructions,functions,xrefs,labels,memory");
+    QCommandLineOption clBatch("batch","Analyze many files, one JSON record per file.");
+    QCommandLineOption clThreads("threads","Batch, listing, traversal of the symbols, prologue scan: number of threads (default: ideal thread count).","count","0");
+    QCommandLineOption clTimeLimit("timelimit","Time limit per file in msec.","msec","0");
+    QCommandLineOption clMemoryLimit("memorylimit","Memory limit per file in MB.","mbytes","0");
+    QCommandLineOption clStats("stats","Write per-phase timings and counters as JSON to stderr.");
+    QCommandLineOption clTrace("trace","Write a Chrome trace of the analysis.","file");
+    QCommandLineOption clSignatures("signatures","Label matches of a signature file (name=signature per line) and traverse them.","file");
+    QCommandLineOption clListing("listing","Write the listing (address, offset, label, bytes, opcode; tab separated) instead of the report.");
+    QCommandLineOption clRange("range","Listing: address range.","address,size");
+    QCommandLineOption clNoEntropyFilter("noentropyfilter","Follow branches into high-entropy (packed) windows.");
+    QCommandLineOption clPrologues("prologues","Scan the code that is not reached for function prologues.");
+    QCommandLineOption clOpcodeLimit("opcodelimit","Maximum number of instructions (0 - default, -1 - no limit).","count","0");
+    QCommandLineOption clGenerate("generate","Write a synthetic file and print the expected counts.");
+    QCommandLineOption clSize("size","Generate: size of the code (K, M, G suffixes).","size","1M");
+    QCommandLineOption clBody("body","Generate: instructions in a function body.","count","4");
+    QCommandLineOption clJumps("jumps","Generate: conditional jumps per function.","count","1");
+    QCommandLineOption clPadding("padding","Generate: int3 padding, percent of the function size.","percent","0");
+    QCommandLineOption clData("data","Generate: unreachable data, percent of the code section.","percent","0");
+    QCommandLineOption clSparse("sparse","Generate: data blocks are holes in the file.");
+    QCommandLineOption clVirtualSize("virtualsize","Generate: size of an uninitialized section (K, M, G suffixes).","size","0");
+    QCommandLineOption clSeed("seed","Generate: random seed.","value","1");
+
+    parser.addOption(clType);
+    parser.addOption(clImage);
+    parser.addOption(clImageBase);
+    parser.addOption(clStart);
+    parser.addOption(clOutput);
+    parser.addOption(clJson);
+    parser.addOption(clSections);
+    parser.addOption(clBatch);
+    parser.addOption(clThreads);
+    parser.addOption(clTimeLimit);
+    parser.addOption(clMemoryLimit);
+    parser.addOption(clStats);
+    parser.addOption(clTrace);
+    parser.addOption(clSignatures);
+    parser.addOption(clListing);
+    parser.addOption(clRange);
+    parser.addOption(clNoEntropyFilter);
+    parser.addOption(clPrologues);
+    parser.addOption(clOpcodeLimit);
+    parser.addOption(clGenerate);
+    parser.addOption(clSize);
+    parser.addOption(clBody);
+    parser.addOption(clJumps);
+    parser.addOption(clPadding);
+    parser.addOption(clData);
+    parser.addOption(clSparse);
+    parser.addOption(clVirtualSize);
+    parser.addOption(clSeed);
+
+    parser.process(app);
+
+    QStringList listArgs=parser.positionalArguments();
+
+    qint64 nTimeLimit=parser.value(clTimeLimit).toLongLong();
+    qint64 nMemoryLimit=parser.value(clMemoryLimit).toLongLong()*1024*1024;
+    qint64 nOpcodeLimit=parser.value(clOpcodeLimit).toLongLong();
+
+    if(parser.isSet(clGenerate))
+    {
+        if(listArgs.count()!=1)
+        {
+            parser.showHelp(1);
+        }
+
+        XDisasmGenerator::OPTIONS generatorOptions={};
+        generatorOptions.fileType=XBinary::FT_UNKNOWN;
+
+        QList<XBinary::FT> listFileTypes;
+        listFileTypes.append(XBinary::FT_PE32);
+        listFileTypes.append(XBinary::FT_PE64);
+        listFileTypes.append(XBinary::FT_ELF64);
+        listFileTypes.append(XBinary::FT_BINARY32);
+        listFileTypes.append(XBinary::FT_BINARY64);
+
+        QString sType=parser.isSet(clType)?parser.value(clType):"PE32";
+
+        for(int i=0;i<listFileTypes.count();i++)
+        {
+            if(XBinary::fileTypeIdToString(listFileTypes.at(i)).compare(sType,Qt::CaseInsensitive)==0)
+            {
+                generatorOptions.fileType=listFileTypes.at(i);
+
+                break;
+            }
+        }
+
+        if(generatorOptions.fileType==XBinary::FT_UNKNOWN)
+        {
+            printError(QString("%1: %2").arg("Invalid file type").arg(sType));
+
+            return 1;
+        }
+
+        if(!stringToSize(parser.value(clSize),&(generatorOptions.nSize)))
+        {
+            printError(QString("%1: %2").arg("Invalid size").arg(parser.value(clSize)));
+
+            return 1;
+        }
+
+        if(!stringToSize(parser.value(clVirtualSize),&(generatorOptions.nVirtualSize)))
+        {
+            printError(QString("%1: %2").arg("Invalid size").arg(parser.value(clVirtualSize)));
+
+            return 1;
+        }
+
+        generatorOptions.nBodyCount=parser.value(clBody).toInt();
+        generatorOptions.nJumpCount=parser.value(clJumps).toInt();
+        generatorOptions.nPaddingRatio=parser.value(clPadding).toInt();
+        generatorOptions.nDataRatio=parser.value(clData).toInt();
+        generatorOptions.bSparse=parser.isSet(clSparse);
+        generatorOptions.nSeed=parser.value(clSeed).toUInt();
+
+        return processGenerate(listArgs.at(0),&generatorOptions,parser.value(clOutput));
+    }
+
+    if(parser.isSet(clBatch))
+    {
+        if(listArgs.count()==0)
+        {
+            parser.showHelp(1);
+        }
+
+        XDisasmBatch::OPTIONS batchOptions={};
+        batchOptions.nThreads=parser.value(clThreads).toInt();
+        batchOptions.nTimeLimit=nTimeLimit;
+        batchOptions.nMemoryLimit=nMemoryLimit;
+        batchOptions.nOpcodeLimit=nOpcodeLimit;
+
+        return processBatch(listArgs,&batchOptions,parser.value(clOutput));
+    }
+
+    if(listArgs.count()!=1)
+    {
+        parser.showHelp(1);
+    }
+
+    QString sFileName=listArgs.at(0);
+
+    QFile file;
+    file.setFileName(sFileName);
+
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        printError(QString("%1: %2").arg("Cannot open file").arg(sFileName));
+
+        return 1;
+    }
+
+    XDisasm::OPTIONS options={};
+    options.bIsImage=parser.isSet(clImage);
+    options.ft=XBinary::FT_UNKNOWN;
+    options.nTimeLimit=nTimeLimit;
+    options.nMemoryLimit=nMemoryLimit;
+    options.nOpcodeLimit=nOpcodeLimit;
+    options.bInstrumentation=parser.isSet(clStats);
+    options.bNoEntropyFilter=parser.isSet(clNoEntropyFilter);
+    options.nThreads=parser.value(clThreads).toInt();
+    options.bPrologueScan=parser.isSet(clPrologues);
+
+    if(parser.isSet(clType))
+    {
+        options.ft=getFileType(&file,parser.value(clType));
+
+        if(options.ft==XBinary::FT_UNKNOWN)
+        {
+            printError(QString("%1: %2").arg("Invalid file type").arg(parser.value(clType)));
+
+            return 1;
+        }
+    }
+
+    if(parser.isSet(clImageBase))
+    {
+        if(!stringToAddress(parser.value(clImageBase),&(options.nImageBase)))
+        {
+            printError(QString("%1: %2").arg("Invalid image base").arg(parser.value(clImageBase)));
+
+            return 1;
+        }
+    }
+    else
+    {
+        options.nImageBase=-1;
+    }
+
+    qint64 nStartAddress=-1;
+
+    if(parser.isSet(clStart))
+    {
+        if(!stringToAddress(parser.value(clStart),&nStartAddress))
+        {
+            printError(QString("%1: %2").arg("Invalid start address").arg(parser.value(clStart)));
+
+            return 1;
+        }
+    }
+
+    if(parser.isSet(clTrace))
+    {
+        XDisasmTrace::setEnabled(true);
+    }
+
+    TraceGuard traceGuard(parser.isSet(clTrace)?parser.value(clTrace):QString());
+
+    XDisasm disasm;
+
+    QObject::connect(&disasm,&XDisasm::errorMessage,&printError);
+
+    disasm.setData(&file,&options,nStartAddress,XDisasm::DM_DISASM);
+    disasm.process();
+
+    if(parser.isSet(clSignatures)&&options.stats.bInit)
+    {
+        XDisasmSignatureScanner scanner;
+
+        if(!scanner.loadFile(parser.value(clSignatures)))
+        {
+            printError(QString("%1: %2").arg("No valid signatures").arg(parser.value(clSignatures)));
+
+            return 1;
+        }
+
+        QList<XDisasmSignatureScanner::MATCH> listMatches=scanner.scan(&file,&(options.stats.memoryMap));
+
+        if(listMatches.count())
+        {
+            scanner.apply(&(options.stats),&listMatches);
+
+            disasm.setData(&file,&options,-1,XDisasm::DM_DISASM);
+            disasm.process();
+        }
+    }
+
+    if(parser.isSet(clStats))
+    {
+        QTextStream(stderr)<<QJsonDocument(XDisasmExport::phaseStatsToJson(&(options.stats))).toJson()<<endl;
+    }
+
+    if(!options.stats.bInit)
+    {
+        return 1;
+    }
+
+    if(parser.isSet(clListing))
+    {
+        XDisasmListing::OPTIONS listingOptions={};
+        listingOptions.bShowLabels=true;
+        listingOptions.nThreads=parser.value(clThreads).toInt();
+
+        if(parser.isSet(clRange))
+        {
+            QStringList listRange=parser.value(clRange).split(",");
+
+            if((listRange.count()!=2)||(!stringToAddress(listRange.at(0),&(listingOptions.nAddress)))||(!stringToSize(listRange.at(1),&(listingOptions.nSize))))
+            {
+                printError(QString("%1: %2").arg("Invalid range").arg(parser.value(clRange)));
+
+                return 1;
+            }
+        }
+
+        QFile fileOutput;
+
+        if(!openOutput(&fileOutput,parser.value(clOutput)))
+        {
+            return 1;
+        }
+
+        XDisasmListing listing;
+
+        QObject::connect(&listing,&XDisasmListing::errorMessage,&printError);
+
+        listing.setData(&file,&(options.stats),&fileOutput,&listingOptions);
+        listing.process();
+
+        fileOutput.close();
+
+        XDisasmListing::RESULT listingResult=listing.getResult();
+
+        // Round trip: the listing has the rows of the view
+        XDisasmModel::SHOWOPTIONS showOptions={};
+        XDisasmModel model(&file,XDisasm::getSnapshot(&options),&showOptions,0);
+
+        qint64 nModelRows=model.getRowCount(listingOptions.nAddress,listingOptions.nSize);
+
+        if((!listingResult.bError)&&(listingResult.nRows!=nModelRows))
+        {
+            printError(QString("%1: %2, %3: %4").arg("Listing rows").arg(listingResult.nRows).arg("model rows").arg(nModelRows));
+
+            listingResult.bError=true;
+        }
+
+        file.close();
+
+        return listingResult.bError?1:0;
+    }
+
+    QStringList listSections=parser.value(clSections).split(",");
+
+    XDisasmExport::REPORT_OPTIONS reportOptions={};
+    reportOptions.reportType=parser.isSet(clJson)?(XDisasmExport::RT_JSON):(XDisasmExport::RT_TEXT);
+    reportOptions.sFileName=sFileName;
+    reportOptions.bInstructions=listSections.contains("instructions");
+    reportOptions.bFunctions=listSections.contains("functions");
+    reportOptions.bXrefs=listSections.contains("xrefs");
+    reportOptions.bLabels=listSections.contains("labels");
+    reportOptions.bMemory=listSections.contains("memory");
+
+    QFile fileOutput;
+
+    if(!openOutput(&fileOutput,parser.value(clOutput)))
+    {
+        return 1;
+    }
+
+    bool bResult=XDisasmExport::exportReport(&file,&(options.stats),&fileOutput,&reportOptions);
+
+    fileOutput.close();
+    file.close();
+
+    return bResult?0:1;
+}
@@ -1,86 +1,194 @@
-// copyright (c) 2019-2020 hors<horsicq@gmail.com>
-//
-// Permission is hereby granted, free of charge, to any person obtaining a copy
-// of this software and associated documentation files (the "Software"), to deal
-// in the Software without restriction, including without limitation the rights
-// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-// copies of the Software, and to permit persons to whom the Software is
-// furnished to do so, subject to the following conditions:
-
-// The above copyright notice and this permission notice shall be included in all
-// copies or substantial portions of the Software.
-
-// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-// SOFTWARE.
-//
-#include "dialogdisasmprocess.h"
-#include "ui_dialogdisasmprocess.h"
-
-DialogDisasmProcess::DialogDisasmProcess(QWidget *pParent) :
-    QDialog(pParent),
-    ui(new Ui::DialogDisasmProcess)
-{
-    ui->setupUi(this);
-
-    pDisasm=new XDisasm;
-    pThread=new QThread;
-
-    pDisasm->moveToThread(pThread);
-
-    connect(pDisasm, SIGNAL(processFinished()), this, SLOT(close()));
-    connect(pThread, SIGNAL(started()), pDisasm, SLOT(process()));
-    connect(pDisasm, SIGNAL(errorMessage(QString)), this, SIGNAL(errorMessage(QString)));
-
-    pTimer=new QTimer(this);
-    connect(pTimer,SIGNAL(timeout()),this,SLOT(timerSlot()));
-}
-
-DialogDisasmProcess::~DialogDisasmProcess()
-{
-    pTimer->stop();
-    delete pTimer;
-
-    pDisasm->stop();
-
-    pThread->quit();
-    pThread->wait();
-
-    delete ui;
-
-    delete pThread;
-    delete pDisasm;
-}
-
-void DialogDisasmProcess::setData(QIODevice *pDevice,XDisasm::OPTIONS *pOptions, qint64 nStartAddress, XDisasm::DM dm)
-{
-    pDisasm->setData(pDevice,pOptions,nStartAddress,dm);
-
-    pThread->start();
-    pTimer->start(1000);
-}
-
-void DialogDisasmProcess::on_pushButtonCancel_clicked()
-{
-    pDisasm->stop();
-}
-
-void DialogDisasmProcess::timerSlot()
-{
-    // TODO more info
-    ui->labelOpcodes->setText(QString("%1").arg(pDisasm->getStats()->mapRecords.count()));
-    ui->labelCalls->setText(QString("%1").arg(pDisasm->getStats()->stCalls.count()));
-    ui->labelJumps->setText(QString("%1").arg(pDisasm->getStats()->stJumps.count()));
-    ui->labelRefFrom->setText(QString("%1").arg(pDisasm->getStats()->mmapRefFrom.count()));
-    ui->labelRefTo->setText(QString("%1").arg(pDisasm->getStats()->mmapRefTo.count()));
-
-    ui->labelDataLabels->setText(QString("%1").arg(pDisasm->getStats()->mmapDataLabels.count()));
-    ui->labelVB->setText(QString("%1").arg(pDisasm->getStats()->mapVB.count()));
-    ui->labelLabelStrings->setText(QString("%1").arg(pDisasm->getStats()->mapLabelStrings.count()));
-    ui->labelPositions->setText(QString("%1").arg(pDisasm->getStats()->mapPositions.count()));
-    ui->labelAddresses->setText(QString("%1").arg(pDisasm->getStats()->mapAddresses.count()));
-}
+// copyright (c) 2019-2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "dialogdisasmprocess.h"
+#include "ui_dialogdisasmprocess.h"
+
+DialogDisasmProcess::DialogDisasmProcess(QWidget *pParent) :
+    QDialog(pParent),
+    ui(new Ui::DialogDisasmProcess)
+{
+    ui->setupUi(this);
+
+    pDisasm=new XDisasm;
+    pThread=new QThread;
+
+    pDisasm->moveToThread(pThread);
+
+    connect(pDisasm, SIGNAL(processFinished()), this, SLOT(close()));
+    connect(pThread, SIGNAL(started()), pDisasm, SLOT(process()));
+    connect(pDisasm, SIGNAL(errorMessage(QString)), this, SIGNAL(errorMessage(QString)));
+
+    pTimer=new QTimer(this);
+    connect(pTimer,SIGNAL(timeout()),this,SLOT(timerSlot()));
+
+    QStringList listHeaders;
+    listHeaders.append(tr("Phase"));
+    listHeaders.append(tr("Time"));
+    listHeaders.append(tr("Instructions"));
+    listHeaders.append(tr("Bytes read"));
+    listHeaders.append(tr("Decoder calls"));
+    listHeaders.append(tr("Entries"));
+
+    ui->tableWidgetPhases->setColumnCount(listHeaders.count());
+    ui->tableWidgetPhases->setRowCount(XDisasm::__PHASE_SIZE);
+    ui->tableWidgetPhases->setHorizontalHeaderLabels(listHeaders);
+
+    for(int i=0;i<XDisasm::__PHASE_SIZE;i++)
+    {
+        ui->tableWidgetPhases->setItem(i,0,new QTableWidgetItem(XDisasm::phaseIdToString((XDisasm::PHASE)i)));
+
+        for(int j=1;j<listHeaders.count();j++)
+        {
+            QTableWidgetItem *pItem=new QTableWidgetItem;
+            pItem->setTextAlignment(Qt::AlignRight|Qt::AlignVCenter);
+
+            ui->tableWidgetPhases->setItem(i,j,pItem);
+        }
+    }
+
+    ui->tableWidgetPhases->horizontalHeader()->setSectionResizeMode(0,QHeaderView::Stretch);
+
+    QStringList listMemoryHeaders;
+    listMemoryHeaders.append(tr("Container"));
+    listMemoryHeaders.append(tr("Entries"));
+    listMemoryHeaders.append(tr("Size"));
+
+    ui->tableWidgetMemory->setColumnCount(listMemoryHeaders.count());
+    ui->tableWidgetMemory->setHorizontalHeaderLabels(listMemoryHeaders);
+    ui->tableWidgetMemory->horizontalHeader()->setSectionResizeMode(0,QHeaderView::Stretch);
+}
+
+DialogDisasmProcess::~DialogDisasmProcess()
+{
+    pTimer->stop();
+    delete pTimer;
+
+    pDisasm->stop();
+
+    pThread->quit();
+    pThread->wait();
+
+    delete ui;
+
+    delete pThread;
+    delete pDisasm;
+}
+
+void DialogDisasmProcess::setData(QIODevice *pDevice,XDisasm::OPTIONS *pOptions, qint64 nStartAddress, XDisasm::DM dm, qint64 nSize)
+{
+    pDisasm->setData(pDevice,pOptions,nStartAddress,dm,nSize);
+
+    pThread->start();
+    pTimer->start(1000);
+}
+
+void DialogDisasmProcess::on_pushButtonCancel_clicked()
+{
+    pDisasm->stop();
+}
+
+void DialogDisasmProcess::timerSlot()
+{
+    // TODO more info
+    // The engine changes its stats in the other thread, the counters are taken from the last phase that is done
+    XDisasm::PROGRESS progress=pDisasm->getProgress();
+
+    ui->labelOpcodes->setText(QString("%1").arg(progress.nOpcodes));
+    ui->labelCalls->setText(QString("%1").arg(progress.nCalls));
+    ui->labelJumps->setText(QString("%1").arg(progress.nJumps));
+    ui->labelRefFrom->setText(QString("%1").arg(progress.nRefFrom));
+    ui->labelRefTo->setText(QString("%1").arg(progress.nRefTo));
+
+    ui->labelDataLabels->setText(QString("%1").arg(progress.nDataLabels));
+    ui->labelVB->setText(QString("%1").arg(progress.nVB));
+    ui->labelLabels->setText(QString("%1").arg(progress.nLabels));
+    ui->labelPositions->setText(QString("%1").arg(progress.nPositions));
+    ui->labelAddresses->setText(QString("%1").arg(progress.nAddresses));
+
+    for(int i=0;i<XDisasm::__PHASE_SIZE;i++)
+    {
+        XDisasm::PHASE_STAT *pStat=&(progress.phaseStat[i]);
+
+        if(pStat->nCount)
+        {
+            ui->tableWidgetPhases->item(i,1)->setText(QString("%1 ms").arg(pStat->nTime/1000000));
+            ui->tableWidgetPhases->item(i,5)->setText(QString("%1").arg(pStat->nContainerSize));
+        }
+
+        if(pStat->nDecoderCalls)
+        {
+            ui->tableWidgetPhases->item(i,2)->setText(QString("%1").arg(pStat->nInstructions));
+            ui->tableWidgetPhases->item(i,3)->setText(QString("%1").arg(pStat->nBytesRead));
+            ui->tableWidgetPhases->item(i,4)->setText(QString("%1").arg(pStat->nDecoderCalls));
+        }
+    }
+
+    QList<XDisasm::MEMORY_RECORD> listMemoryRecords=progress.listMemoryRecords;
+
+    XDisasm::MEMORY_RECORD recordTotal={};
+    recordTotal.sName=tr("Total");
+
+    int nNumberOfRecords=listMemoryRecords.count();
+
+    for(int i=0;i<nNumberOfRecords;i++)
+    {
+        recordTotal.nCount+=listMemoryRecords.at(i).nCount;
+        recordTotal.nSize+=listMemoryRecords.at(i).nSize;
+    }
+
+    XDisasm::MEMORY_RECORD recordPeak={};
+    recordPeak.sName=tr("Peak RSS");
+    recordPeak.nCount=-1;
+    recordPeak.nSize=XDisasm::getPeakMemoryUsage();
+
+    listMemoryRecords.append(recordTotal);
+    listMemoryRecords.append(recordPeak);
+
+    nNumberOfRecords=listMemoryRecords.count();
+
+    if(ui->tableWidgetMemory->rowCount()!=nNumberOfRecords)
+    {
+        ui->tableWidgetMemory->setRowCount(nNumberOfRecords);
+
+        for(int i=0;i<nNumberOfRecords;i++)
+        {
+            ui->tableWidgetMemory->setItem(i,0,new QTableWidgetItem(listMemoryRecords.at(i).sName));
+
+            for(int j=1;j<3;j++)
+            {
+                QTableWidgetItem *pItem=new QTableWidgetItem;
+                pItem->setTextAlignment(Qt::AlignRight|Qt::AlignVCenter);
+
+                ui->tableWidgetMemory->setItem(i,j,pItem);
+            }
+        }
+    }
+
+    for(int i=0;i<nNumberOfRecords;i++)
+    {
+        if(listMemoryRecords.at(i).nCount!=-1)
+        {
+            ui->tableWidgetMemory->item(i,1)->setText(QString("%1").arg(listMemoryRecords.at(i).nCount));
+        }
+
+        ui->tableWidgetMemory->item(i,2)->setText(QString("%1 KB").arg(listMemoryRecords.at(i).nSize/1024));
+    }
+}
@@ -0,0 +1,224 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "dialogdisasmsearch.h"
+#include "ui_dialogdisasmsearch.h"
+
+DialogDisasmSearch::DialogDisasmSearch(QWidget *pParent, QIODevice *pDevice, XDisasm::STATS *pDisasmStats, XDisasmTextIndex *pTextIndex, QString sSignature) :
+    QDialog(pParent),
+    ui(new Ui::DialogDisasmSearch)
+{
+    ui->setupUi(this);
+
+    this->pDevice=pDevice;
+    this->pDisasmStats=pDisasmStats;
+    this->pTextIndex=pTextIndex;
+    __nAddress=0;
+
+    ui->comboBoxMode->addItem(tr("Signature"),-1);
+
+    if(pTextIndex)
+    {
+        ui->comboBoxMode->addItem(XDisasmTextIndex::queryTypeToString(XDisasmTextIndex::QT_MNEMONIC),XDisasmTextIndex::QT_MNEMONIC);
+        ui->comboBoxMode->addItem(XDisasmTextIndex::queryTypeToString(XDisasmTextIndex::QT_REGISTER),XDisasmTextIndex::QT_REGISTER);
+        ui->comboBoxMode->addItem(XDisasmTextIndex::queryTypeToString(XDisasmTextIndex::QT_VALUE),XDisasmTextIndex::QT_VALUE);
+        ui->comboBoxMode->addItem(XDisasmTextIndex::queryTypeToString(XDisasmTextIndex::QT_REGEX),XDisasmTextIndex::QT_REGEX);
+    }
+
+    ui->lineEditSignature->setText(sSignature);
+    ui->pushButtonGoTo->setEnabled(false);
+}
+
+DialogDisasmSearch::~DialogDisasmSearch()
+{
+    delete ui;
+}
+
+qint64 DialogDisasmSearch::getAddress()
+{
+    return __nAddress;
+}
+
+QString DialogDisasmSearch::getSignature()
+{
+    return ui->lineEditSignature->text();
+}
+
+void DialogDisasmSearch::on_pushButtonSearch_clicked()
+{
+    int nMode=ui->comboBoxMode->currentData().toInt();
+
+    QList<qint64> listAddresses;
+    QString sStatus;
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+
+    if(nMode==-1)
+    {
+        XDisasmSearch::OPTIONS options={};
+        options.sSignature=ui->lineEditSignature->text();
+        options.cWild=QChar('.');
+        options.nResultLimit=N_RESULT_LIMIT;
+
+        QString _sWild=ui->lineEditWildcard->text();
+
+        if(_sWild.size())
+        {
+            options.cWild=_sWild.at(0);
+        }
+
+        XDisasmSearch search;
+
+        connect(&search,SIGNAL(errorMessage(QString)),this,SLOT(errorMessage(QString)));
+
+        search.setData(pDevice,&(pDisasmStats->memoryMap),&options);
+        search.process();
+
+        XDisasmSearch::RESULT result=search.getResult();
+
+        listAddresses=result.listAddresses;
+
+        if(result.bValid)
+        {
+            sStatus=QString("%1: %2  %3: %4 ms").arg(tr("Results")).arg(listAddresses.count()).arg(tr("Time")).arg(result.nTime);
+
+            if(result.bLimitReached)
+            {
+                sStatus+=QString("  (%1)").arg(tr("Limit reached"));
+            }
+        }
+    }
+    else if(pTextIndex)
+    {
+        if(pTextIndex->isReady())
+        {
+            XDisasmTextIndex::RESULT result=pTextIndex->query((XDisasmTextIndex::QT)nMode,ui->lineEditSignature->text());
+
+            if(result.bValid)
+            {
+                listAddresses=result.listAddresses.mid(0,N_RESULT_LIMIT);
+
+                sStatus=QString("%1: %2  %3: %4 ms").arg(tr("Results")).arg(result.listAddresses.count()).arg(tr("Time")).arg(result.nTime);
+            }
+            else
+            {
+                sStatus=tr("Invalid query");
+            }
+        }
+        else
+        {
+            sStatus=tr("The index is being built");
+        }
+    }
+
+    QApplication::restoreOverrideCursor();
+
+    setResults(&listAddresses,sStatus);
+}
+
+void DialogDisasmSearch::on_comboBoxMode_currentIndexChanged(int nIndex)
+{
+    Q_UNUSED(nIndex)
+
+    bool bSignature=(ui->comboBoxMode->currentData().toInt()==-1);
+
+    ui->labelWildcard->setEnabled(bSignature);
+    ui->lineEditWildcard->setEnabled(bSignature);
+}
+
+void DialogDisasmSearch::setResults(QList<qint64> *pListAddresses, QString sStatus)
+{
+    int nNumberOfResults=pListAddresses->count();
+
+    QAbstractItemModel *pOldModel=ui->tableViewResults->model();
+
+    QStandardItemModel *pModel=new QStandardItemModel(nNumberOfResults,2,this);
+
+    pModel->setHeaderData(0,Qt::Horizontal,tr("Address"));
+    pModel->setHeaderData(1,Qt::Horizontal,tr("Label"));
+
+    for(int i=0;i<nNumberOfResults;i++)
+    {
+        qint64 nAddress=pListAddresses->at(i);
+
+        QStandardItem *itemAddress=new QStandardItem;
+        itemAddress->setText(XBinary::valueToHex(pDisasmStats->memoryMap.mode,nAddress));
+        itemAddress->setData(nAddress);
+        pModel->setItem(i,0,itemAddress);
+
+        QStandardItem *itemLabel=new QStandardItem;
+        itemLabel->setText(XDisasm::getLabelString(pDisasmStats,nAddress));
+        pModel->setItem(i,1,itemLabel);
+    }
+
+    ui->tableViewResults->setModel(pModel);
+    delete pOldModel;
+
+    ui->tableViewResults->horizontalHeader()->setSectionResizeMode(0,QHeaderView::Interactive);
+    ui->tableViewResults->horizontalHeader()->setSectionResizeMode(1,QHeaderView::Stretch);
+
+    ui->pushButtonGoTo->setEnabled(nNumberOfResults);
+
+    if(nNumberOfResults)
+    {
+        ui->tableViewResults->setCurrentIndex(pModel->index(0,0));
+    }
+
+    ui->labelStatus->setText(sStatus);
+}
+
+void DialogDisasmSearch::on_pushButtonClose_clicked()
+{
+    done(QDialog::Rejected);
+}
+
+void DialogDisasmSearch::on_pushButtonGoTo_clicked()
+{
+    goTo();
+}
+
+void DialogDisasmSearch::on_tableViewResults_doubleClicked(const QModelIndex &index)
+{
+    Q_UNUSED(index)
+
+    goTo();
+}
+
+void DialogDisasmSearch::goTo()
+{
+    QItemSelectionModel *pSelectionModel=ui->tableViewResults->selectionModel();
+
+    if(pSelectionModel)
+    {
+        QModelIndexList listIndexes=pSelectionModel->selectedRows(0);
+
+        if(listIndexes.count())
+        {
+            __nAddress=listIndexes.at(0).data(Qt::UserRole+1).toLongLong();
+
+            done(QDialog::Accepted);
+        }
+    }
+}
+
+void DialogDisasmSearch::errorMessage(QString sText)
+{
+    QMessageBox::critical(this,tr("Error"),sText);
+}
@@ -0,0 +1,65 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef DIALOGDISASMSEARCH_H
+#define DIALOGDISASMSEARCH_H
+
+#include <QDialog>
+#include <QStandardItemModel>
+#include <QApplication>
+#include <QMessageBox>
+#include "xdisasmsearch.h"
+#include "xdisasmtextindex.h"
+
+namespace Ui {
+class DialogDisasmSearch;
+}
+
+class DialogDisasmSearch : public QDialog
+{
+    Q_OBJECT
+
+    static const int N_RESULT_LIMIT=10000;
+
+public:
+    explicit DialogDisasmSearch(QWidget *pParent,QIODevice *pDevice,XDisasm::STATS *pDisasmStats,XDisasmTextIndex *pTextIndex,QString sSignature=QString());
+    ~DialogDisasmSearch();
+    qint64 getAddress();
+    QString getSignature();
+
+private slots:
+    void on_pushButtonSearch_clicked();
+    void on_comboBoxMode_currentIndexChanged(int nIndex);
+    void on_pushButtonClose_clicked();
+    void on_pushButtonGoTo_clicked();
+    void on_tableViewResults_doubleClicked(const QModelIndex &index);
+    void goTo();
+    void errorMessage(QString sText);
+    void setResults(QList<qint64> *pListAddresses,QString sStatus);
+
+private:
+    Ui::DialogDisasmSearch *ui;
+    QIODevice *pDevice;
+    XDisasm::STATS *pDisasmStats;
+    XDisasmTextIndex *pTextIndex;
+    qint64 __nAddress;
+};
+
+#endif // DIALOGDISASMSEARCH_H
@@ -1,866 +1,4514 @@
-// copyright (c) 2019-2020 hors<horsicq@gmail.com>
-//
-// Permission is hereby granted, free of charge, to any person obtaining a copy
-// of this software and associated documentation files (the "Software"), to deal
-// in the Software without restriction, including without limitation the rights
-// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-// copies of the Software, and to permit persons to whom the Software is
-// furnished to do so, subject to the following conditions:
-
-// The above copyright notice and this permission notice shall be included in all
-// copies or substantial portions of the Software.
-
-// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-// SOFTWARE.
-//
-#include "xdisasm.h"
-
-XDisasm::XDisasm(QObject *pParent) : QObject(pParent)
-{
-    pOptions=0;
-    nStartAddress=0;
-    disasm_handle=0;
-    bStop=false;
-}
-
-XDisasm::~XDisasm()
-{
-    if(disasm_handle)
-    {
-        cs_close(&disasm_handle);
-        disasm_handle=0;
-    }
-}
-
-void XDisasm::setData(QIODevice *pDevice, XDisasm::OPTIONS *pOptions, qint64 nStartAddress, XDisasm::DM dm)
-{
-    this->pDevice=pDevice;
-    this->pOptions=pOptions;
-    this->nStartAddress=nStartAddress;
-    this->dm=dm;
-}
-
-void XDisasm::_disasm(qint64 nInitAddress, qint64 nAddress)
-{
-    pOptions->stats.mmapRefFrom.insert(nAddress,nInitAddress);
-    pOptions->stats.mmapRefTo.insert(nInitAddress,nAddress);
-
-    while(!bStop)
-    {
-        if(pOptions->stats.mapRecords.contains(nAddress))
-        {
-            break;
-        }
-
-        bool bStopBranch=false;
-        int nDelta=0;
-
-        qint64 nOffset=XBinary::addressToOffset(&(pOptions->stats.memoryMap),nAddress); // TODO optimize if image
-        if(nOffset!=-1)
-        {
-            char opcode[N_X64_OPCODE_SIZE];
-
-            XBinary::_zeroMemory(opcode,N_X64_OPCODE_SIZE);
-
-            size_t nDataSize=XBinary::read_array(pDevice,nOffset,opcode,N_X64_OPCODE_SIZE);
-
-            uint8_t *pData=(uint8_t *)opcode;
-
-            cs_insn *insn;
-            size_t count=cs_disasm(disasm_handle,pData,nDataSize,nAddress,1,&insn);
-
-            if(count>0)
-            {
-                if(insn->size>1)
-                {
-                    bStopBranch=!XBinary::isAddressPhysical(&(pOptions->stats.memoryMap),nAddress+insn->size-1);
-                }
-
-                if(!bStopBranch)
-                {
-                    for(int i=0; i<insn->detail->x86.op_count; i++)
-                    {
-                        if(insn->detail->x86.operands[i].type==X86_OP_IMM)
-                        {
-                            qint64 nImm=insn->detail->x86.operands[i].imm;
-
-                            if(isJmpOpcode(insn->id))
-                            {
-                                if(isCallOpcode(insn->id))
-                                {
-                                    pOptions->stats.stCalls.insert(nImm);
-                                }
-                                else
-                                {
-                                    pOptions->stats.stJumps.insert(nImm);
-                                }
-
-                                if(nAddress!=nImm)
-                                {
-                                    _disasm(nAddress,nImm);
-                                }
-                            }
-                        }
-                    }
-
-                    RECORD opcode={};
-                    opcode.nOffset=nOffset;
-                    opcode.nSize=insn->size;
-                    opcode.type=RECORD_TYPE_OPCODE;
-
-                    if(!_insertOpcode(nAddress,&opcode))
-                    {
-                        bStopBranch=true;
-                    }
-
-                    nDelta=insn->size;
-
-                    if(isEndBranchOpcode(insn->id))
-                    {
-                        bStopBranch=true;
-                    }
-                }
-
-                cs_free(insn,count);
-            }
-            else
-            {
-                bStopBranch=true;
-            }
-
-            if(XBinary::_isMemoryZeroFilled(opcode,N_X64_OPCODE_SIZE))
-            {
-                bStopBranch=true;
-            }
-        }
-
-        if(nDelta)
-        {
-            nAddress+=nDelta;
-        }
-        else
-        {
-            bStopBranch=true;
-        }
-
-        if(bStopBranch)
-        {
-            break;
-        }
-    }
-}
-
-void XDisasm::processDisasm()
-{
-    bStop=false;
-
-    if(!pOptions->stats.bInit)
-    {
-        pOptions->stats.csarch=CS_ARCH_X86;
-        pOptions->stats.csmode=CS_MODE_16;
-
-        XBinary::FT ft=pOptions->ft;
-
-        if(ft==XBinary::FT_UNKNOWN)
-        {
-            ft=XBinary::getPrefFileType(pDevice);
-        }
-
-        if((ft==XBinary::FT_PE32)||(ft==XBinary::FT_PE64))
-        {
-            XPE pe(pDevice,pOptions->bIsImage,pOptions->nImageBase);
-
-            pOptions->stats.memoryMap=pe.getMemoryMap();
-            pOptions->stats.nEntryPointAddress=pe.getEntryPointAddress(&pOptions->stats.memoryMap);
-            pOptions->stats.bIsOverlayPresent=pe.isOverlayPresent();
-            pOptions->stats.nOverlaySize=pe.getOverlaySize();
-            pOptions->stats.nOverlayOffset=pe.getOverlayOffset();
-
-            XBinary::MODE modeBinary=pe.getMode();
-
-            pOptions->stats.csarch=CS_ARCH_X86;
-            if(modeBinary==XBinary::MODE_32)
-            {
-                pOptions->stats.csmode=CS_MODE_32;
-            }
-            else if(modeBinary==XBinary::MODE_64)
-            {
-                pOptions->stats.csmode=CS_MODE_64;
-            }
-        }
-        else if((ft==XBinary::FT_ELF32)||(ft==XBinary::FT_ELF64))
-        {
-            XELF elf(pDevice,pOptions->bIsImage,pOptions->nImageBase);
-
-            pOptions->stats.memoryMap=elf.getMemoryMap();
-            pOptions->stats.nEntryPointAddress=elf.getEntryPointAddress(&pOptions->stats.memoryMap);
-            pOptions->stats.bIsOverlayPresent=elf.isOverlayPresent();
-            pOptions->stats.nOverlaySize=elf.getOverlaySize();
-            pOptions->stats.nOverlayOffset=elf.getOverlayOffset();
-        }
-        else if((ft==XBinary::FT_MACH32)||(ft==XBinary::FT_MACH64))
-        {
-            XMACH mach(pDevice,pOptions->bIsImage,pOptions->nImageBase);
-
-            pOptions->stats.memoryMap=mach.getMemoryMap();
-            pOptions->stats.nEntryPointAddress=mach.getEntryPointAddress(&pOptions->stats.memoryMap);
-            pOptions->stats.bIsOverlayPresent=mach.isOverlayPresent();
-            pOptions->stats.nOverlaySize=mach.getOverlaySize();
-            pOptions->stats.nOverlayOffset=mach.getOverlayOffset();
-        }
-        else if(ft==XBinary::FT_MSDOS)
-        {
-            XMSDOS msdos(pDevice,pOptions->bIsImage,pOptions->nImageBase);
-
-            pOptions->stats.memoryMap=msdos.getMemoryMap();
-            pOptions->stats.nEntryPointAddress=msdos.getEntryPointAddress(&pOptions->stats.memoryMap);
-            pOptions->stats.bIsOverlayPresent=msdos.isOverlayPresent();
-            pOptions->stats.nOverlaySize=msdos.getOverlaySize();
-            pOptions->stats.nOverlayOffset=msdos.getOverlayOffset();
-        }
-        else if(ft==XBinary::FT_NE)
-        {
-            XNE ne(pDevice,pOptions->bIsImage,pOptions->nImageBase);
-
-            pOptions->stats.memoryMap=ne.getMemoryMap();
-            pOptions->stats.nEntryPointAddress=ne.getEntryPointAddress(&pOptions->stats.memoryMap);
-            pOptions->stats.bIsOverlayPresent=ne.isOverlayPresent();
-            pOptions->stats.nOverlaySize=ne.getOverlaySize();
-            pOptions->stats.nOverlayOffset=ne.getOverlayOffset();
-        }
-        else if((ft==XBinary::FT_LE)||(ft==XBinary::FT_LX))
-        {
-            XLE le(pDevice,pOptions->bIsImage,pOptions->nImageBase);
-
-            pOptions->stats.memoryMap=le.getMemoryMap();
-            pOptions->stats.nEntryPointAddress=le.getEntryPointAddress(&pOptions->stats.memoryMap);
-            pOptions->stats.bIsOverlayPresent=le.isOverlayPresent();
-            pOptions->stats.nOverlaySize=le.getOverlaySize();
-            pOptions->stats.nOverlayOffset=le.getOverlayOffset();
-        }
-        else if(ft==XBinary::FT_COM)
-        {
-            XCOM xcom(pDevice,pOptions->bIsImage,pOptions->nImageBase);
-
-            pOptions->stats.memoryMap=xcom.getMemoryMap();
-            pOptions->stats.nEntryPointAddress=xcom.getEntryPointAddress(&pOptions->stats.memoryMap);
-        }
-        else if((ft==XBinary::FT_BINARY16)||(ft==XBinary::FT_BINARY))
-        {
-            XBinary binary(pDevice,pOptions->bIsImage,pOptions->nImageBase);
-
-            binary.setArch("8086");
-            binary.setMode(XBinary::MODE_16);
-
-            pOptions->stats.memoryMap=binary.getMemoryMap();
-            pOptions->stats.nEntryPointAddress=binary.getEntryPointAddress(&pOptions->stats.memoryMap);
-        }
-        else if(ft==XBinary::FT_BINARY32)
-        {
-            XBinary binary(pDevice,pOptions->bIsImage,pOptions->nImageBase);
-
-            binary.setArch("386");
-            binary.setMode(XBinary::MODE_32);
-
-            pOptions->stats.memoryMap=binary.getMemoryMap();
-            pOptions->stats.nEntryPointAddress=binary.getEntryPointAddress(&pOptions->stats.memoryMap);
-        }
-        else if(ft==XBinary::FT_BINARY64)
-        {
-            XBinary binary(pDevice,pOptions->bIsImage,pOptions->nImageBase);
-
-            binary.setArch("AMD64");
-            binary.setMode(XBinary::MODE_64);
-
-            pOptions->stats.memoryMap=binary.getMemoryMap();
-            pOptions->stats.nEntryPointAddress=binary.getEntryPointAddress(&pOptions->stats.memoryMap);
-        }
-
-        pOptions->stats.nImageBase=pOptions->stats.memoryMap.nBaseAddress;
-//        pOptions->stats.nImageSize=XBinary::getTotalVirtualSize(&(pOptions->stats.memoryMap));
-        pOptions->stats.nImageSize=pOptions->stats.memoryMap.nImageSize;
-
-        if(XBinary::isX86asm(pOptions->stats.memoryMap.sArch))
-        {
-            pOptions->stats.csarch=CS_ARCH_X86;
-            if((pOptions->stats.memoryMap.mode==XBinary::MODE_16)||(pOptions->stats.memoryMap.mode==XBinary::MODE_16SEG))
-            {
-                pOptions->stats.csmode=CS_MODE_16;
-            }
-            else if(pOptions->stats.memoryMap.mode==XBinary::MODE_32)
-            {
-                pOptions->stats.csmode=CS_MODE_32;
-            }
-            else if(pOptions->stats.memoryMap.mode==XBinary::MODE_64)
-            {
-                pOptions->stats.csmode=CS_MODE_64;
-            }
-
-            cs_err err=cs_open(pOptions->stats.csarch,pOptions->stats.csmode,&disasm_handle);
-            if(!err)
-            {
-                cs_option(disasm_handle,CS_OPT_DETAIL,CS_OPT_ON); // TODO Check
-            }
-
-            _disasm(0,pOptions->stats.nEntryPointAddress);
-
-            if(nStartAddress!=-1)
-            {
-                if(nStartAddress!=pOptions->stats.nEntryPointAddress)
-                {
-                    _disasm(0,nStartAddress);
-                }
-            }
-
-            _adjust();
-            _updatePositions();
-
-            pOptions->stats.bInit=true;
-
-            if(disasm_handle)
-            {
-                cs_close(&disasm_handle);
-                disasm_handle=0;
-            }
-        }
-        else
-        {
-            emit errorMessage(QString("%1: %2").arg("Architecture").arg(pOptions->stats.memoryMap.sArch));
-        }
-    }
-    else
-    {
-        if(XBinary::isX86asm(pOptions->stats.memoryMap.sArch))
-        {
-            // TODO move to function
-            if(disasm_handle==0)
-            {
-                cs_err err=cs_open(pOptions->stats.csarch,pOptions->stats.csmode,&disasm_handle);
-                if(!err)
-                {
-                    cs_option(disasm_handle,CS_OPT_DETAIL,CS_OPT_ON); // TODO Check
-                }
-            }
-
-            _disasm(0,nStartAddress);
-
-            _adjust();
-            _updatePositions();
-
-            if(disasm_handle)
-            {
-                cs_close(&disasm_handle);
-                disasm_handle=0;
-            }
-        }
-        else
-        {
-            emit errorMessage(QString("%1: %2").arg("Architecture").arg(pOptions->stats.memoryMap.sArch));
-        }
-    }
-
-    emit processFinished();
-}
-
-void XDisasm::processToData()
-{
-    pOptions->stats.mapRecords.remove(this->nStartAddress);
-
-    _adjust();
-    _updatePositions();
-
-    emit processFinished();
-}
-
-void XDisasm::process()
-{
-    if(dm==DM_DISASM)
-    {
-        processDisasm();
-    }
-    else if(dm==DM_TODATA)
-    {
-        processToData();
-    }
-}
-
-void XDisasm::stop()
-{
-    bStop=true;
-}
-
-XDisasm::STATS *XDisasm::getStats()
-{
-    return &(pOptions->stats);
-}
-
-void XDisasm::_adjust()
-{
-    pOptions->stats.mapLabelStrings.clear();
-    pOptions->stats.mapVB.clear();
-
-    if(!bStop)
-    {
-        pOptions->stats.mapLabelStrings.insert(pOptions->stats.nEntryPointAddress,"entry_point");
-
-        QSetIterator<qint64> iFL(pOptions->stats.stCalls);
-        while(iFL.hasNext()&&(!bStop))
-        {
-            qint64 nAddress=iFL.next();
-
-            if(!pOptions->stats.mapLabelStrings.contains(nAddress))
-            {
-                pOptions->stats.mapLabelStrings.insert(nAddress,QString("func_%1").arg(nAddress,0,16));
-            }
-        }
-
-        QSetIterator<qint64> iJL(pOptions->stats.stJumps);
-        while(iJL.hasNext()&&(!bStop))
-        {
-            qint64 nAddress=iJL.next();
-
-            if(!pOptions->stats.mapLabelStrings.contains(nAddress))
-            {
-                pOptions->stats.mapLabelStrings.insert(nAddress,QString("lab_%1").arg(nAddress,0,16));
-            }
-        }
-
-    //    QSet<qint64> stFunctionLabels;
-    //    QSet<qint64> stJmpLabels;
-    //    QMap<qint64,qint64> mapDataSizeLabels; // Set Max
-    //    QSet<qint64> stDataLabels;
-
-        // TODO Strings
-        QMapIterator<qint64,XDisasm::RECORD> iRecords(pOptions->stats.mapRecords);
-        while(iRecords.hasNext()&&(!bStop))
-        {
-            iRecords.next();
-
-            qint64 nAddress=iRecords.key();
-
-            VIEW_BLOCK record;
-            record.nAddress=nAddress;
-            record.nOffset=iRecords.value().nOffset;
-            record.nSize=iRecords.value().nSize;
-
-            if(iRecords.value().type==RECORD_TYPE_OPCODE)
-            {
-                record.type=VBT_OPCODE;
-            }
-            else if(iRecords.value().type==RECORD_TYPE_DATA)
-            {
-                record.type=VBT_DATA;
-            }
-
-            if(!pOptions->stats.mapVB.contains(nAddress))
-            {
-                pOptions->stats.mapVB.insert(nAddress,record);
-            }
-        }
-
-        int nMMCount=pOptions->stats.memoryMap.listRecords.count(); // TODO
-
-        for(int i=0;(i<nMMCount)&&(!bStop);i++)
-        {
-            qint64 nRegionAddress=pOptions->stats.memoryMap.listRecords.at(i).nAddress;
-            qint64 nRegionOffset=pOptions->stats.memoryMap.listRecords.at(i).nOffset;
-            qint64 nRegionSize=pOptions->stats.memoryMap.listRecords.at(i).nSize;
-
-            if(nRegionAddress!=-1)
-            {
-                for(qint64 nCurrentAddress=nRegionAddress,nCurrentOffset=nRegionOffset;(nCurrentAddress<(nRegionAddress+nRegionSize))&&(!bStop);)
-                {
-                    VIEW_BLOCK vb=pOptions->stats.mapVB.value(nCurrentAddress);
-
-                    if(!vb.nSize)
-                    {
-                        QMap<qint64,VIEW_BLOCK>::const_iterator iter=pOptions->stats.mapVB.lowerBound(nCurrentAddress);
-
-                        qint64 nBlockAddress=0;
-                        qint64 nBlockOffset=0;
-                        qint64 nBlockSize=0;
-
-                        qint64 nIterKey=iter.key();
-
-                        if(pOptions->stats.mapVB.count())
-                        {
-                            if(nIterKey==pOptions->stats.mapVB.firstKey()) // TODO move outside 'for'
-                            {
-//                                nBlockAddress=pOptions->stats.nImageBase;
-                                nBlockAddress=pOptions->stats.memoryMap.listRecords.at(0).nAddress;
-                                nBlockOffset=pOptions->stats.memoryMap.listRecords.at(0).nOffset;
-
-                                if(nIterKey<(nRegionAddress+nRegionSize))
-                                {
-                                    nBlockSize=iter.key()-pOptions->stats.nImageBase;
-                                }
-                                else
-                                {
-                                    nBlockSize=(nRegionAddress+nRegionSize)-nBlockAddress;
-                                }
-                            }
-                            else if(iter==pOptions->stats.mapVB.end())
-                            {
-                                nBlockAddress=nCurrentAddress;
-                                nBlockOffset=nCurrentOffset;
-
-                                nBlockSize=(nRegionAddress+nRegionSize)-nBlockAddress;
-                            }
-                            else
-                            {
-                                nBlockAddress=nCurrentAddress;
-                                nBlockOffset=nCurrentOffset;
-                                if(nIterKey<(nRegionAddress+nRegionSize))
-                                {
-                                    nBlockSize=iter.key()-nBlockAddress;
-                                }
-                                else
-                                {
-                                    nBlockSize=(nRegionAddress+nRegionSize)-nBlockAddress;
-                                }
-                            }
-                        }
-                        else
-                        {
-                            nBlockAddress=nCurrentAddress;
-                            nBlockOffset=nCurrentOffset;
-
-                            nBlockSize=(nRegionAddress+nRegionSize)-nBlockAddress;
-                        }
-
-                        qint64 _nAddress=nBlockAddress;
-                        qint64 _nOffset=nBlockOffset;
-                        qint64 _nSize=nBlockSize;
-
-                        if(_nOffset!=-1)
-                        {
-                            while(_nSize>=16)
-                            {
-                                VIEW_BLOCK record;
-                                record.nAddress=_nAddress;
-                                record.nOffset=_nOffset;
-                                record.nSize=16;
-                                record.type=VBT_DATABLOCK;
-
-                                if(!pOptions->stats.mapVB.contains(_nAddress))
-                                {
-                                    pOptions->stats.mapVB.insert(_nAddress,record);
-                                }
-
-                                _nSize-=16;
-                                _nAddress+=16;
-                                _nOffset+=16;
-                            }
-                        }
-                        else
-                        {
-                            VIEW_BLOCK record;
-                            record.nAddress=_nAddress;
-                            record.nOffset=-1;
-                            record.nSize=_nSize;
-                            record.type=VBT_DATABLOCK;
-
-                            if(!pOptions->stats.mapVB.contains(_nAddress))
-                            {
-                                pOptions->stats.mapVB.insert(_nAddress,record);
-                            }
-                        }
-
-                        nCurrentAddress=nBlockAddress+nBlockSize;
-                        if(nBlockOffset!=-1)
-                        {
-                            nCurrentOffset=nBlockOffset+nBlockSize;
-                        }
-                    }
-                    else
-                    {
-                        nCurrentAddress=vb.nAddress+vb.nSize;
-                        if(nCurrentOffset!=-1)
-                        {
-                            nCurrentOffset=vb.nOffset+vb.nSize;
-                        }
-                    }
-                }
-            }
-        }
-
-//        QMapIterator<qint64,qint64> iDS(stats.mmapDataLabels);
-//        while(iDS.hasNext())
-//        {
-//            iDS.next();
-
-//            qint64 nAddress=iDS.key();
-
-//            VIEW_BLOCK record;
-//            record.nOffset=pBinary->addressToOffset(pListMM,nAddress);
-//            record.nSize=iDS.value();
-//            record.type=VBT_DATA;
-
-//            if(!stats.mapVB.contains(nAddress))
-//            {
-//                stats.mapVB.insert(nAddress,record);
-//            }
-//        }
-
-//        QSetIterator<qint64> iD(stats.stDataLabels);
-//        while(iD.hasNext()&&(!bStop))
-//        {
-//            qint64 nAddress=iD.next();
-
-//            VIEW_BLOCK record;
-//            record.nOffset=pBinary->addressToOffset(pListMM,nAddress);
-//            record.nSize=0;
-//            record.type=VBT_DATA;
-
-//            if(!stats.mapVB.contains(nAddress))
-//            {
-//                stats.mapVB.insert(nAddress,record);
-//            }
-//        }
-
-        // TODO Check errors
-    }
-}
-
-void XDisasm::_updatePositions()
-{
-    qint64 nImageSize=pOptions->stats.nImageSize;
-    qint64 nVBCount=pOptions->stats.mapVB.count();
-    qint64 nVBSize=getVBSize(&(pOptions->stats.mapVB));
-    pOptions->stats.nPositions=nImageSize+nVBCount-nVBSize; // TODO
-
-    pOptions->stats.mapPositions.clear();
-    // TODO cache
-    qint64 nCurrentAddress=pOptions->stats.nImageBase; // TODO
-
-    for(qint64 i=0;i<pOptions->stats.nPositions;i++)
-    {
-        bool bIsVBPresent=pOptions->stats.mapVB.contains(nCurrentAddress);
-
-        if(bIsVBPresent)
-        {
-            pOptions->stats.mapPositions.insert(i,nCurrentAddress);
-            pOptions->stats.mapAddresses.insert(nCurrentAddress,i);
-
-            nCurrentAddress+=pOptions->stats.mapVB.value(nCurrentAddress).nSize-1;
-        }
-
-        nCurrentAddress++;
-    }
-}
-
-bool XDisasm::_insertOpcode(qint64 nAddress, XDisasm::RECORD *pOpcode)
-{
-    pOptions->stats.mapRecords.insert(nAddress,*pOpcode);
-
-    int nCount=pOptions->stats.mapRecords.count();
-
-    return (nCount<N_OPCODE_COUNT);
-}
-
-qint64 XDisasm::getVBSize(QMap<qint64, XDisasm::VIEW_BLOCK> *pMapVB)
-{
-    qint64 nResult=0;
-
-    QMapIterator<qint64, XDisasm::VIEW_BLOCK> i(*pMapVB);
-    while(i.hasNext())
-    {
-        i.next();
-
-        nResult+=i.value().nSize;
-    }
-
-    return nResult;
-}
-
-QString XDisasm::getDisasmString(csh disasm_handle, qint64 nAddress, char *pData, qint32 nDataSize)
-{
-    QString sResult;
-
-    cs_insn *insn;
-    size_t count=cs_disasm(disasm_handle,(uint8_t *)pData,nDataSize,nAddress,1,&insn);
-
-    if(count>0)
-    {
-        QString sMnemonic=insn->mnemonic;
-        QString sArgs=insn->op_str;
-
-        sResult=sMnemonic;
-        if(sArgs!="")
-        {
-            sResult+=" "+sArgs;
-        }
-
-        cs_free(insn,count);
-    }
-
-    return sResult;
-}
-
-QList<XDisasm::SIGNATURE_RECORD> XDisasm::getSignature(XDisasm::SIGNATURE_OPTIONS *pSignatureOptions, qint64 nAddress)
-{
-    QList<SIGNATURE_RECORD> listResult;
-
-    csh _disasm_handle;
-    cs_err err=cs_open(pSignatureOptions->csarch,pSignatureOptions->csmode,&_disasm_handle);
-    if(!err)
-    {
-        cs_option(_disasm_handle,CS_OPT_DETAIL,CS_OPT_ON);
-    }
-
-    QSet<qint64> stRecords;
-
-    bool bStopBranch=false;
-
-    for(int i=0;(i<pSignatureOptions->nCount)&&(!bStopBranch);i++)
-    {
-        qint64 nOffset=XBinary::addressToOffset(&(pSignatureOptions->memoryMap),nAddress);
-        if(nOffset!=-1)
-        {
-            char opcode[N_X64_OPCODE_SIZE];
-
-            XBinary::_zeroMemory(opcode,N_X64_OPCODE_SIZE);
-
-            size_t nDataSize=XBinary::read_array(pSignatureOptions->pDevice,nOffset,opcode,N_X64_OPCODE_SIZE);
-
-            uint8_t *pData=(uint8_t *)opcode;
-
-            cs_insn *insn;
-            size_t count=cs_disasm(_disasm_handle,pData,nDataSize,nAddress,1,&insn);
-
-            if(count>0)
-            {
-                if(insn->size>1)
-                {
-                    bStopBranch=!XBinary::isAddressPhysical(&(pSignatureOptions->memoryMap),nAddress+insn->size-1);
-                }
-
-                if(stRecords.contains(nAddress))
-                {
-                    bStopBranch=true;
-                }
-
-                if(!bStopBranch)
-                {
-                    SIGNATURE_RECORD record={};
-
-                    record.nAddress=nAddress;
-                    record.sOpcode=insn->mnemonic;
-                    QString sArgs=insn->op_str;
-
-                    if(sArgs!="")
-                    {
-                        record.sOpcode+=" "+sArgs;
-                    }
-
-                    record.baOpcode=QByteArray(opcode,insn->size);
-
-                    record.nDispOffset=insn->detail->x86.encoding.disp_offset;
-                    record.nDispSize=insn->detail->x86.encoding.disp_size;
-                    record.nImmOffset=insn->detail->x86.encoding.imm_offset;
-                    record.nImmSize=insn->detail->x86.encoding.imm_size;
-
-                    stRecords.insert(nAddress);
-
-                    nAddress+=insn->size;
-
-                    if(pSignatureOptions->sm==XDisasm::SM_RELATIVEADDRESS)
-                    {
-                        for(int i=0; i<insn->detail->x86.op_count; i++)
-                        {
-                            if(insn->detail->x86.operands[i].type==X86_OP_IMM)
-                            {
-                                qint64 nImm=insn->detail->x86.operands[i].imm;
-
-                                if(isJmpOpcode(insn->id))
-                                {
-                                    nAddress=nImm;
-                                    record.bIsConst=true;
-                                }
-                            }
-                        }
-                    }
-
-                    listResult.append(record);
-                }
-
-                cs_free(insn,count);
-            }
-            else
-            {
-                bStopBranch=true;
-            }
-        }
-    }
-
-    cs_close(&_disasm_handle);
-
-    return listResult;
-}
-
-bool XDisasm::isEndBranchOpcode(uint nOpcodeID)
-{
-    bool bResult=false;
-
-    // TODO more checks
-    if( (nOpcodeID==X86_INS_JMP)||
-        (nOpcodeID==X86_INS_RET)||
-        (nOpcodeID==X86_INS_INT3))
-    {
-        bResult=true;
-    }
-
-    return bResult;
-}
-
-bool XDisasm::isJmpOpcode(uint nOpcodeID)
-{
-    bool bResult=false;
-
-    if( (nOpcodeID==X86_INS_JMP)||
-        (nOpcodeID==X86_INS_JA)||
-        (nOpcodeID==X86_INS_JAE)||
-        (nOpcodeID==X86_INS_JB)||
-        (nOpcodeID==X86_INS_JBE)||
-        (nOpcodeID==X86_INS_JCXZ)||
-        (nOpcodeID==X86_INS_JE)||
-        (nOpcodeID==X86_INS_JECXZ)||
-        (nOpcodeID==X86_INS_JG)||
-        (nOpcodeID==X86_INS_JGE)||
-        (nOpcodeID==X86_INS_JL)||
-        (nOpcodeID==X86_INS_JLE)||
-        (nOpcodeID==X86_INS_JNE)||
-        (nOpcodeID==X86_INS_JNO)||
-        (nOpcodeID==X86_INS_JNP)||
-        (nOpcodeID==X86_INS_JNS)||
-        (nOpcodeID==X86_INS_JO)||
-        (nOpcodeID==X86_INS_JP)||
-        (nOpcodeID==X86_INS_JRCXZ)||
-        (nOpcodeID==X86_INS_JS)||
-        (nOpcodeID==X86_INS_LOOP)||
-        (nOpcodeID==X86_INS_LOOPE)||
-        (nOpcodeID==X86_INS_LOOPNE)||
-        (nOpcodeID==X86_INS_CALL))
-    {
-        bResult=true;
-    }
-
-    return bResult;
-}
-
-bool XDisasm::isCallOpcode(uint nOpcodeID)
-{
-    bool bResult=false;
-
-    if(nOpcodeID==X86_INS_CALL)
-    {
-        bResult=true;
-    }
-
-    return bResult;
-}
+// copyright (c) 2019-2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "xdisasm.h"
+#include "xdisasmstringscanner.h"
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+
+XDisasm::XDisasm(QObject *pParent) : QObject(pParent)
+{
+    pOptions=0;
+    nStartAddress=0;
+    nRangeSize=0;
+    nChangedStart=-1;
+    nChangedEnd=-1;
+    disasm_handle=0;
+    csarchHandle=CS_ARCH_X86;
+    csmodeHandle=CS_MODE_16;
+    bStop=false;
+    nLimitCounter=0;
+    currentPhase=PHASE_MEMORYMAP;
+    pPhaseStat=0;
+    nTraceStart=-1;
+    progress={};
+}
+
+XDisasm::~XDisasm()
+{
+    if(disasm_handle)
+    {
+        cs_close(&disasm_handle);
+        disasm_handle=0;
+    }
+}
+
+void XDisasm::setData(QIODevice *pDevice, XDisasm::OPTIONS *pOptions, qint64 nStartAddress, XDisasm::DM dm, qint64 nSize)
+{
+    this->pDevice=pDevice;
+    this->pOptions=pOptions;
+    this->nStartAddress=nStartAddress;
+    this->dm=dm;
+    this->nRangeSize=nSize;
+}
+
+void XDisasm::_disasm(XDisasm::TRAVERSAL *pTraversal, qint64 nInitAddress, qint64 nAddress)
+{
+    // A worklist instead of the recursion: deep call chains do not exhaust the stack of the thread
+    XREF work={};
+    work.nFrom=nInitAddress;
+    work.nTo=nAddress;
+
+    pTraversal->listWork.append(work);
+
+    while((!pTraversal->listWork.isEmpty())&&(!bStop))
+    {
+        work=pTraversal->listWork.takeLast();
+
+        _disasmBranch(pTraversal,work.nFrom,work.nTo);
+    }
+
+    pTraversal->listWork.clear();
+}
+
+void XDisasm::_disasmBranch(XDisasm::TRAVERSAL *pTraversal, qint64 nInitAddress, qint64 nAddress)
+{
+    if((nInitAddress!=-1)&&(!pOptions->bNoEntropyFilter))
+    {
+        // A branch from code into compressed data is a bogus target (packed samples, data decoded as code)
+        const WINDOW *pTargetWindow=getWindow(&(pOptions->stats),nAddress);
+
+        if(pTargetWindow&&(pTargetWindow->wc==WC_PACKED))
+        {
+            const WINDOW *pSourceWindow=getWindow(&(pOptions->stats),nInitAddress);
+
+            if(pSourceWindow&&(pSourceWindow->wc!=WC_PACKED))
+            {
+                pTraversal->nRejectedTargets++;
+
+                return;
+            }
+        }
+    }
+
+    if(nInitAddress!=-1)
+    {
+        XREF xref={};
+        xref.nFrom=nInitAddress;
+        xref.nTo=nAddress;
+
+        pTraversal->listRefs.append(xref);
+    }
+
+    while(!bStop)
+    {
+        bool bVisited=false;
+
+        {
+            QMutexLocker locker(pTraversal->pMutex);
+
+            _checkLimits();
+
+            bVisited=pOptions->stats.mapRecords.contains(nAddress)||_isDataRange(nAddress);
+        }
+
+        if(bVisited)
+        {
+            break;
+        }
+
+        bool bStopBranch=false;
+        int nDelta=0;
+
+        qint64 nOffset=XBinary::addressToOffset(&(pOptions->stats.memoryMap),nAddress); // TODO optimize if image
+        if(nOffset!=-1)
+        {
+            char opcode[N_X64_OPCODE_SIZE];
+
+            XBinary::_zeroMemory(opcode,N_X64_OPCODE_SIZE);
+
+            size_t nDataSize=0;
+
+            {
+                QMutexLocker locker(pTraversal->pMutexDevice);
+
+                nDataSize=XBinary::read_array(pTraversal->pDevice,nOffset,opcode,N_X64_OPCODE_SIZE);
+            }
+
+            uint8_t *pData=(uint8_t *)opcode;
+
+            cs_insn *insn;
+            size_t count=cs_disasm(pTraversal->handle,pData,nDataSize,nAddress,1,&insn);
+
+            pTraversal->nBytesRead+=nDataSize;
+            pTraversal->nDecoderCalls++;
+
+            if(count>0)
+            {
+                if(insn->size>1)
+                {
+                    bStopBranch=!XBinary::isAddressPhysical(&(pOptions->stats.memoryMap),nAddress+insn->size-1);
+                }
+
+                if(!bStopBranch)
+                {
+                    bool bJmp=isJmpOpcode(insn->id);
+
+                    for(int i=0; i<insn->detail->x86.op_count; i++)
+                    {
+                        // Operands of the other instructions that point into the image, for the data records
+                        qint64 nDataRef=-1;
+
+                        if(insn->detail->x86.operands[i].type==X86_OP_IMM)
+                        {
+                            qint64 nImm=insn->detail->x86.operands[i].imm;
+
+                            if(!bJmp)
+                            {
+                                nDataRef=nImm;
+                            }
+                            else
+                            {
+                                if(isCallOpcode(insn->id))
+                                {
+                                    pTraversal->stCalls.insert(nImm);
+                                }
+                                else
+                                {
+                                    pTraversal->stJumps.insert(nImm);
+                                }
+
+                                if(nAddress!=nImm)
+                                {
+                                    XREF work={};
+                                    work.nFrom=nAddress;
+                                    work.nTo=nImm;
+
+                                    pTraversal->listWork.append(work);
+                                }
+                            }
+                        }
+                        else if((insn->detail->x86.operands[i].type==X86_OP_MEM)&&(!bJmp))
+                        {
+                            const x86_op_mem *pMem=&(insn->detail->x86.operands[i].mem);
+
+                            if(pMem->base==X86_REG_RIP)
+                            {
+                                nDataRef=nAddress+insn->size+pMem->disp;
+                            }
+                            else if((pMem->base==X86_REG_INVALID)&&(pMem->index==X86_REG_INVALID))
+                            {
+                                nDataRef=pMem->disp;
+                            }
+                        }
+
+                        if((nDataRef>=pOptions->stats.nImageBase)&&(nDataRef<(pOptions->stats.nImageBase+pOptions->stats.nImageSize)))
+                        {
+                            XREF xref={};
+                            xref.nFrom=nAddress;
+                            xref.nTo=nDataRef;
+
+                            pTraversal->listDataRefs.append(xref);
+                        }
+                    }
+
+                    RECORD opcode={};
+                    opcode.nOffset=nOffset;
+                    opcode.nSize=insn->size;
+                    opcode.type=RECORD_TYPE_OPCODE;
+
+                    if(isCallOpcode(insn->id))
+                    {
+                        opcode.nFlags|=RF_CALL;
+                    }
+                    else if(insn->id==X86_INS_JMP)
+                    {
+                        opcode.nFlags|=RF_JUMP;
+                    }
+                    else if(isJmpOpcode(insn->id))
+                    {
+                        opcode.nFlags|=RF_CONDJUMP;
+                    }
+
+                    if(isEndBranchOpcode(insn->id))
+                    {
+                        opcode.nFlags|=RF_ENDBRANCH;
+                    }
+
+                    bool bInserted=false;
+
+                    {
+                        QMutexLocker locker(pTraversal->pMutex);
+
+                        bInserted=_insertOpcode(nAddress,&opcode);
+                    }
+
+                    if(!bInserted)
+                    {
+                        bStopBranch=true;
+                    }
+
+                    pTraversal->nInstructions++;
+
+                    nDelta=insn->size;
+
+                    if(isEndBranchOpcode(insn->id))
+                    {
+                        bStopBranch=true;
+                    }
+                }
+
+                cs_free(insn,count);
+            }
+            else
+            {
+                bStopBranch=true;
+            }
+
+            if(XBinary::_isMemoryZeroFilled(opcode,N_X64_OPCODE_SIZE))
+            {
+                bStopBranch=true;
+            }
+        }
+
+        if(nDelta)
+        {
+            nAddress+=nDelta;
+        }
+        else
+        {
+            bStopBranch=true;
+        }
+
+        if(bStopBranch)
+        {
+            break;
+        }
+    }
+}
+
+void XDisasm::_disasmRoot(qint64 nAddress)
+{
+    TRAVERSAL traversal={};
+    traversal.handle=disasm_handle;
+    traversal.pDevice=pDevice;
+
+    _disasm(&traversal,-1,nAddress);
+
+    _mergeTraversal(&traversal);
+}
+
+void XDisasm::_disasmRange(qint64 nAddress, qint64 nSize)
+{
+    XDISASM_TRACE("XDisasm::_disasmRange");
+
+    _removeDataRanges(nAddress,nSize);
+
+    const QMap<qint64,RECORD> &mapRecords=pOptions->stats.mapRecords;
+
+    qint64 nEnd=nAddress+nSize;
+    qint64 nCurrentAddress=nAddress;
+
+    while((nCurrentAddress<nEnd)&&(!bStop))
+    {
+        qint64 nNextAddress=-1;
+
+        QMap<qint64,RECORD>::const_iterator iter=mapRecords.upperBound(nCurrentAddress);
+
+        if(iter!=mapRecords.constBegin())
+        {
+            --iter;
+
+            if((iter.key()+iter.value().nSize)>nCurrentAddress)
+            {
+                nNextAddress=iter.key()+iter.value().nSize;
+            }
+        }
+
+        if(nNextAddress==-1)
+        {
+            _disasmRoot(nCurrentAddress);
+
+            // An invalid opcode: the next byte
+            nNextAddress=nCurrentAddress+qMax(mapRecords.value(nCurrentAddress).nSize,(qint64)1);
+        }
+
+        nCurrentAddress=nNextAddress;
+    }
+}
+
+void XDisasm::_removeRange(qint64 nAddress, qint64 nSize)
+{
+    XDISASM_TRACE("XDisasm::_removeRange");
+
+    qint64 nEnd=nAddress+nSize;
+
+    QMap<qint64,RECORD> *pMapRecords=&(pOptions->stats.mapRecords);
+    QMap<qint64,RECORD>::iterator iterRecord=pMapRecords->lowerBound(nAddress);
+
+    while((iterRecord!=pMapRecords->end())&&(iterRecord.key()<nEnd))
+    {
+        if(iterRecord.value().type==RECORD_TYPE_OPCODE)
+        {
+            iterRecord=pMapRecords->erase(iterRecord);
+        }
+        else
+        {
+            ++iterRecord;
+        }
+    }
+
+    // The xrefs of the removed instructions: the rows of the range in refTo, one value per row in refFrom
+    QVector<XREF> listRemove;
+    QVector<XREF> listInsert;
+
+    QSet<qint64> stTargets;
+
+    const qint64 *pKeys=pOptions->stats.refTo.listKeys.constData();
+    int nNumberOfKeys=pOptions->stats.refTo.listKeys.count();
+
+    int nKeyBegin=(int)(std::lower_bound(pKeys,pKeys+nNumberOfKeys,nAddress)-pKeys);
+    int nKeyEnd=(int)(std::lower_bound(pKeys,pKeys+nNumberOfKeys,nEnd)-pKeys);
+
+    for(int i=nKeyBegin;i<nKeyEnd;i++)
+    {
+        XREF xref={};
+        xref.nFrom=pKeys[i];
+
+        qint32 nRefEnd=pOptions->stats.refTo.listOffsets.at(i+1);
+
+        for(qint32 j=pOptions->stats.refTo.listOffsets.at(i);j<nRefEnd;j++)
+        {
+            xref.nTo=pOptions->stats.refTo.listValues.at(j);
+
+            stTargets.insert(xref.nTo);
+            listRemove.append(xref);
+        }
+    }
+
+    _patchXrefIndex(&(pOptions->stats.refTo),&listRemove,&listInsert,false);
+
+    std::sort(listRemove.begin(),listRemove.end(),_xrefReverseLessThan);
+
+    _patchXrefIndex(&(pOptions->stats.refFrom),&listRemove,&listInsert,true);
+
+    stChangedTargets.unite(stTargets);
+
+    QVector<XREF> *pListRefs[]={&(pOptions->stats.listPendingRefs),&(pOptions->stats.listDataRefs)};
+
+    for(int i=0;i<2;i++)
+    {
+        int nNumberOfRefs=pListRefs[i]->count();
+        int nCount=0;
+
+        for(int j=0;j<nNumberOfRefs;j++)
+        {
+            qint64 nFrom=pListRefs[i]->at(j).nFrom;
+
+            if((nFrom<nAddress)||(nFrom>=nEnd))
+            {
+                (*pListRefs[i])[nCount]=pListRefs[i]->at(j);
+                nCount++;
+            }
+        }
+
+        pListRefs[i]->resize(nCount);
+    }
+
+    // A target without references is not a function or a jump label anymore
+    QSetIterator<qint64> iTargets(stTargets);
+    while(iTargets.hasNext())
+    {
+        qint64 nTarget=iTargets.next();
+
+        qint32 nCount=0;
+
+        getRefFrom(&(pOptions->stats),nTarget,&nCount);
+
+        if(!nCount)
+        {
+            pOptions->stats.stCalls.remove(nTarget);
+            pOptions->stats.stJumps.remove(nTarget);
+        }
+    }
+
+    _removeDataRanges(nAddress,nSize);
+
+    pOptions->stats.mapDataRanges.insert(nAddress,nSize);
+}
+
+void XDisasm::_removeDataRanges(qint64 nAddress, qint64 nSize)
+{
+    qint64 nEnd=nAddress+nSize;
+
+    QMap<qint64,qint64> *pMapDataRanges=&(pOptions->stats.mapDataRanges);
+    QMap<qint64,qint64> mapParts; // the parts outside of the range stay
+
+    QMap<qint64,qint64>::iterator iter=pMapDataRanges->lowerBound(nAddress);
+
+    if(iter!=pMapDataRanges->begin())
+    {
+        --iter;
+
+        if((iter.key()+iter.value())<=nAddress)
+        {
+            ++iter;
+        }
+    }
+
+    while((iter!=pMapDataRanges->end())&&(iter.key()<nEnd))
+    {
+        qint64 nRangeAddress=iter.key();
+        qint64 nRangeEnd=iter.key()+iter.value();
+
+        if(nRangeAddress<nAddress)
+        {
+            mapParts.insert(nRangeAddress,nAddress-nRangeAddress);
+        }
+
+        if(nRangeEnd>nEnd)
+        {
+            mapParts.insert(nEnd,nRangeEnd-nEnd);
+        }
+
+        iter=pMapDataRanges->erase(iter);
+    }
+
+    QMapIterator<qint64,qint64> iParts(mapParts);
+    while(iParts.hasNext())
+    {
+        iParts.next();
+
+        pMapDataRanges->insert(iParts.key(),iParts.value());
+    }
+}
+
+bool XDisasm::_isDataRange(qint64 nAddress)
+{
+    bool bResult=false;
+
+    const QMap<qint64,qint64> &mapDataRanges=pOptions->stats.mapDataRanges;
+
+    QMap<qint64,qint64>::const_iterator iter=mapDataRanges.upperBound(nAddress);
+
+    if(iter!=mapDataRanges.constBegin())
+    {
+        --iter;
+
+        bResult=(nAddress<(iter.key()+iter.value()));
+    }
+
+    return bResult;
+}
+
+void XDisasm::_disasmRoots()
+{
+    XDISASM_TRACE("XDisasm::_disasmRoots");
+
+    // The symbols and the extra roots that are not decoded yet
+    listRootWork.clear();
+    listRootWork.reserve(pOptions->stats.listSymbols.count()+pOptions->stats.listRoots.count());
+
+    int nNumberOfSymbols=pOptions->stats.listSymbols.count();
+
+    for(int i=0;i<nNumberOfSymbols;i++)
+    {
+        qint64 nAddress=pOptions->stats.listSymbols.at(i).nAddress;
+
+        if(!pOptions->stats.mapRecords.contains(nAddress))
+        {
+            listRootWork.append(nAddress);
+        }
+    }
+
+    int nNumberOfRoots=pOptions->stats.listRoots.count();
+
+    for(int i=0;i<nNumberOfRoots;i++)
+    {
+        qint64 nAddress=pOptions->stats.listRoots.at(i);
+
+        if(!pOptions->stats.mapRecords.contains(nAddress))
+        {
+            listRootWork.append(nAddress);
+        }
+    }
+
+    _disasmRootWork();
+}
+
+void XDisasm::_disasmRootWork()
+{
+    int nThreads=pOptions->nThreads;
+
+    if(nThreads<=0)
+    {
+        nThreads=QThread::idealThreadCount();
+    }
+
+    nThreads=qMin(nThreads,qMax(listRootWork.count()/N_ROOTS_PER_THREAD,1));
+
+    if(nThreads<=1)
+    {
+        int nNumberOfWork=listRootWork.count();
+
+        for(int i=0;(i<nNumberOfWork)&&(!bStop);i++)
+        {
+            _disasmRoot(listRootWork.at(i));
+        }
+    }
+    else
+    {
+        QFile *pFile=dynamic_cast<QFile *>(pDevice);
+
+        sFileName=pFile?pFile->fileName():QString();
+        nCurrentRoot=0;
+
+        QThreadPool threadPool;
+        threadPool.setMaxThreadCount(nThreads);
+
+        for(int i=0;i<nThreads;i++)
+        {
+            QtConcurrent::run(&threadPool,this,&XDisasm::_disasmRootsWorker);
+        }
+
+        threadPool.waitForDone();
+    }
+
+    listRootWork.clear();
+    listRootWork.squeeze();
+}
+
+void XDisasm::_disasmRootsWorker()
+{
+    TRAVERSAL traversal={};
+    traversal.pMutex=&mutexTraversal;
+
+    QFile file;
+
+    if(sFileName!="")
+    {
+        file.setFileName(sFileName);
+
+        if(file.open(QIODevice::ReadOnly))
+        {
+            traversal.pDevice=&file;
+        }
+    }
+
+    if(!traversal.pDevice)
+    {
+        traversal.pDevice=pDevice;
+        traversal.pMutexDevice=&mutexDevice;
+    }
+
+    // A capstone handle is not thread safe, every worker has its own
+    if(cs_open(pOptions->stats.csarch,pOptions->stats.csmode,&traversal.handle)==CS_ERR_OK)
+    {
+        cs_option(traversal.handle,CS_OPT_DETAIL,CS_OPT_ON);
+
+        int nNumberOfWork=listRootWork.count();
+
+        while(!bStop)
+        {
+            int nIndex=nCurrentRoot.fetchAndAddOrdered(1);
+
+            if(nIndex>=nNumberOfWork)
+            {
+                break;
+            }
+
+            _disasm(&traversal,-1,listRootWork.at(nIndex));
+        }
+
+        cs_close(&traversal.handle);
+    }
+
+    QMutexLocker locker(&mutexTraversal);
+
+    _mergeTraversal(&traversal);
+}
+
+void XDisasm::_mergeTraversal(XDisasm::TRAVERSAL *pTraversal)
+{
+    if(pOptions->stats.listPendingRefs.isEmpty())
+    {
+        pOptions->stats.listPendingRefs.swap(pTraversal->listRefs);
+    }
+    else
+    {
+        pOptions->stats.listPendingRefs+=pTraversal->listRefs;
+    }
+
+    if(pOptions->stats.listDataRefs.isEmpty())
+    {
+        pOptions->stats.listDataRefs.swap(pTraversal->listDataRefs);
+    }
+    else
+    {
+        pOptions->stats.listDataRefs+=pTraversal->listDataRefs;
+    }
+
+    pOptions->stats.stCalls.unite(pTraversal->stCalls);
+    pOptions->stats.stJumps.unite(pTraversal->stJumps);
+    pOptions->stats.entropy.nRejectedTargets+=pTraversal->nRejectedTargets;
+
+    if(pPhaseStat)
+    {
+        pPhaseStat->nInstructions+=pTraversal->nInstructions;
+        pPhaseStat->nBytesRead+=pTraversal->nBytesRead;
+        pPhaseStat->nDecoderCalls+=pTraversal->nDecoderCalls;
+    }
+}
+
+void XDisasm::_removeStringRecords()
+{
+    // Taken out for the traversal: a string that turns out to be code must not stop it
+    int nNumberOfStrings=pOptions->stats.listStrings.count();
+
+    for(int i=0;i<nNumberOfStrings;i++)
+    {
+        QMap<qint64,RECORD>::iterator iter=pOptions->stats.mapRecords.find(pOptions->stats.listStrings.at(i).nAddress);
+
+        if((iter!=pOptions->stats.mapRecords.end())&&(iter.value().type==RECORD_TYPE_DATA)&&(iter.value().nFlags&(RF_ANSISTRING|RF_UNICODESTRING)))
+        {
+            pOptions->stats.mapRecords.erase(iter);
+        }
+    }
+
+    pOptions->stats.nStringRecords=0;
+}
+
+void XDisasm::_addStringRecords()
+{
+    XDISASM_TRACE("XDisasm::_addStringRecords");
+
+    QVector<qint64> listAddresses;
+
+    int nNumberOfStrings=pOptions->stats.listStrings.count();
+
+    for(int i=0;(i<nNumberOfStrings)&&(!bStop);i++)
+    {
+        const STRING &string=pOptions->stats.listStrings.at(i);
+
+        bool bOverlap=false;
+
+        QMap<qint64,RECORD>::const_iterator iter=pOptions->stats.mapRecords.lowerBound(string.nAddress);
+
+        if((iter!=pOptions->stats.mapRecords.constEnd())&&(iter.key()<(string.nAddress+string.nSize)))
+        {
+            bOverlap=true;
+        }
+
+        if((!bOverlap)&&(iter!=pOptions->stats.mapRecords.constBegin()))
+        {
+            --iter;
+
+            if((iter.key()+iter.value().nSize)>string.nAddress)
+            {
+                bOverlap=true;
+            }
+        }
+
+        if(!bOverlap)
+        {
+            RECORD record={};
+            record.nOffset=XBinary::addressToOffset(&(pOptions->stats.memoryMap),string.nAddress);
+            record.nSize=string.nSize;
+            record.type=RECORD_TYPE_DATA;
+            record.nFlags=(string.st==ST_UNICODE)?RF_UNICODESTRING:RF_ANSISTRING;
+
+            pOptions->stats.mapRecords.insert(string.nAddress,record);
+
+            listAddresses.append(string.nAddress);
+        }
+    }
+
+    pOptions->stats.nStringRecords=listAddresses.count();
+
+    // The instructions that point at the strings get xrefs
+    QVector<XREF> *pListDataRefs=&(pOptions->stats.listDataRefs);
+
+    std::sort(pListDataRefs->begin(),pListDataRefs->end(),_xrefReverseLessThan);
+    pListDataRefs->erase(std::unique(pListDataRefs->begin(),pListDataRefs->end(),_xrefEqual),pListDataRefs->end());
+
+    int nNumberOfAddresses=listAddresses.count();
+
+    QVector<XREF>::const_iterator iterRef=pListDataRefs->constBegin();
+
+    for(int i=0;i<nNumberOfAddresses;i++)
+    {
+        qint64 nAddress=listAddresses.at(i);
+
+        while((iterRef!=pListDataRefs->constEnd())&&(iterRef->nTo<nAddress))
+        {
+            ++iterRef;
+        }
+
+        for(;(iterRef!=pListDataRefs->constEnd())&&(iterRef->nTo==nAddress);++iterRef)
+        {
+            pOptions->stats.listPendingRefs.append(*iterRef);
+        }
+    }
+}
+
+void XDisasm::processDisasm()
+{
+    XDISASM_TRACE("XDisasm::processDisasm");
+
+    bStop=false;
+    nLimitCounter=0;
+    nChangedStart=-1;
+    nChangedEnd=-1;
+    stChangedTargets.clear();
+    timer.start();
+
+    if(!pOptions->stats.bInit)
+    {
+        _beginPhase(PHASE_MEMORYMAP);
+
+        pOptions->stats.csarch=CS_ARCH_X86;
+        pOptions->stats.csmode=CS_MODE_16;
+
+        XBinary::FT ft=pOptions->ft;
+
+        if(ft==XBinary::FT_UNKNOWN)
+        {
+            ft=XBinary::getPrefFileType(pDevice);
+        }
+
+        if((ft==XBinary::FT_PE32)||(ft==XBinary::FT_PE64))
+        {
+            XPE pe(pDevice,pOptions->bIsImage,pOptions->nImageBase);
+
+            pOptions->stats.memoryMap=pe.getMemoryMap();
+            pOptions->stats.nEntryPointAddress=pe.getEntryPointAddress(&pOptions->stats.memoryMap);
+            pOptions->stats.bIsOverlayPresent=pe.isOverlayPresent();
+            pOptions->stats.nOverlaySize=pe.getOverlaySize();
+            pOptions->stats.nOverlayOffset=pe.getOverlayOffset();
+
+            XBinary::MODE modeBinary=pe.getMode();
+
+            pOptions->stats.csarch=CS_ARCH_X86;
+            if(modeBinary==XBinary::MODE_32)
+            {
+                pOptions->stats.csmode=CS_MODE_32;
+            }
+            else if(modeBinary==XBinary::MODE_64)
+            {
+                pOptions->stats.csmode=CS_MODE_64;
+            }
+        }
+        else if((ft==XBinary::FT_ELF32)||(ft==XBinary::FT_ELF64))
+        {
+            XELF elf(pDevice,pOptions->bIsImage,pOptions->nImageBase);
+
+            pOptions->stats.memoryMap=elf.getMemoryMap();
+            pOptions->stats.nEntryPointAddress=elf.getEntryPointAddress(&pOptions->stats.memoryMap);
+            pOptions->stats.bIsOverlayPresent=elf.isOverlayPresent();
+            pOptions->stats.nOverlaySize=elf.getOverlaySize();
+            pOptions->stats.nOverlayOffset=elf.getOverlayOffset();
+        }
+        else if((ft==XBinary::FT_MACH32)||(ft==XBinary::FT_MACH64))
+        {
+            XMACH mach(pDevice,pOptions->bIsImage,pOptions->nImageBase);
+
+            pOptions->stats.memoryMap=mach.getMemoryMap();
+            pOptions->stats.nEntryPointAddress=mach.getEntryPointAddress(&pOptions->stats.memoryMap);
+            pOptions->stats.bIsOverlayPresent=mach.isOverlayPresent();
+            pOptions->stats.nOverlaySize=mach.getOverlaySize();
+            pOptions->stats.nOverlayOffset=mach.getOverlayOffset();
+        }
+        else if(ft==XBinary::FT_MSDOS)
+        {
+            XMSDOS msdos(pDevice,pOptions->bIsImage,pOptions->nImageBase);
+
+            pOptions->stats.memoryMap=msdos.getMemoryMap();
+            pOptions->stats.nEntryPointAddress=msdos.getEntryPointAddress(&pOptions->stats.memoryMap);
+            pOptions->stats.bIsOverlayPresent=msdos.isOverlayPresent();
+            pOptions->stats.nOverlaySize=msdos.getOverlaySize();
+            pOptions->stats.nOverlayOffset=msdos.getOverlayOffset();
+        }
+        else if(ft==XBinary::FT_NE)
+        {
+            XNE ne(pDevice,pOptions->bIsImage,pOptions->nImageBase);
+
+            pOptions->stats.memoryMap=ne.getMemoryMap();
+            pOptions->stats.nEntryPointAddress=ne.getEntryPointAddress(&pOptions->stats.memoryMap);
+            pOptions->stats.bIsOverlayPresent=ne.isOverlayPresent();
+            pOptions->stats.nOverlaySize=ne.getOverlaySize();
+            pOptions->stats.nOverlayOffset=ne.getOverlayOffset();
+        }
+        else if((ft==XBinary::FT_LE)||(ft==XBinary::FT_LX))
+        {
+            XLE le(pDevice,pOptions->bIsImage,pOptions->nImageBase);
+
+            pOptions->stats.memoryMap=le.getMemoryMap();
+            pOptions->stats.nEntryPointAddress=le.getEntryPointAddress(&pOptions->stats.memoryMap);
+            pOptions->stats.bIsOverlayPresent=le.isOverlayPresent();
+            pOptions->stats.nOverlaySize=le.getOverlaySize();
+            pOptions->stats.nOverlayOffset=le.getOverlayOffset();
+        }
+        else if(ft==XBinary::FT_COM)
+        {
+            XCOM xcom(pDevice,pOptions->bIsImage,pOptions->nImageBase);
+
+            pOptions->stats.memoryMap=xcom.getMemoryMap();
+            pOptions->stats.nEntryPointAddress=xcom.getEntryPointAddress(&pOptions->stats.memoryMap);
+        }
+        else if((ft==XBinary::FT_BINARY16)||(ft==XBinary::FT_BINARY))
+        {
+            XBinary binary(pDevice,pOptions->bIsImage,pOptions->nImageBase);
+
+            binary.setArch("8086");
+            binary.setMode(XBinary::MODE_16);
+
+            pOptions->stats.memoryMap=binary.getMemoryMap();
+            pOptions->stats.nEntryPointAddress=binary.getEntryPointAddress(&pOptions->stats.memoryMap);
+        }
+        else if(ft==XBinary::FT_BINARY32)
+        {
+            XBinary binary(pDevice,pOptions->bIsImage,pOptions->nImageBase);
+
+            binary.setArch("386");
+            binary.setMode(XBinary::MODE_32);
+
+            pOptions->stats.memoryMap=binary.getMemoryMap();
+            pOptions->stats.nEntryPointAddress=binary.getEntryPointAddress(&pOptions->stats.memoryMap);
+        }
+        else if(ft==XBinary::FT_BINARY64)
+        {
+            XBinary binary(pDevice,pOptions->bIsImage,pOptions->nImageBase);
+
+            binary.setArch("AMD64");
+            binary.setMode(XBinary::MODE_64);
+
+            pOptions->stats.memoryMap=binary.getMemoryMap();
+            pOptions->stats.nEntryPointAddress=binary.getEntryPointAddress(&pOptions->stats.memoryMap);
+        }
+
+        pOptions->stats.nImageBase=pOptions->stats.memoryMap.nBaseAddress;
+//        pOptions->stats.nImageSize=XBinary::getTotalVirtualSize(&(pOptions->stats.memoryMap));
+        pOptions->stats.nImageSize=pOptions->stats.memoryMap.nImageSize;
+
+        _testLimits();
+
+        _endPhase();
+
+        _beginPhase(PHASE_ENTROPY);
+        _updateEntropy();
+        _endPhase();
+
+        _beginPhase(PHASE_STRINGS);
+        _updateStrings();
+        _endPhase();
+
+        _beginPhase(PHASE_SYMBOLS);
+        _updateSymbols(ft);
+        _endPhase();
+
+        if(XBinary::isX86asm(pOptions->stats.memoryMap.sArch))
+        {
+            pOptions->stats.csarch=CS_ARCH_X86;
+            if((pOptions->stats.memoryMap.mode==XBinary::MODE_16)||(pOptions->stats.memoryMap.mode==XBinary::MODE_16SEG))
+            {
+                pOptions->stats.csmode=CS_MODE_16;
+            }
+            else if(pOptions->stats.memoryMap.mode==XBinary::MODE_32)
+            {
+                pOptions->stats.csmode=CS_MODE_32;
+            }
+            else if(pOptions->stats.memoryMap.mode==XBinary::MODE_64)
+            {
+                pOptions->stats.csmode=CS_MODE_64;
+            }
+
+            _beginPhase(PHASE_TRAVERSAL);
+
+            _openHandle();
+
+            _removeStringRecords();
+
+            _disasmRoot(pOptions->stats.nEntryPointAddress);
+
+            if(nStartAddress!=-1)
+            {
+                if(nRangeSize>0)
+                {
+                    _disasmRange(nStartAddress,nRangeSize);
+                }
+                else if(nStartAddress!=pOptions->stats.nEntryPointAddress)
+                {
+                    _disasmRoot(nStartAddress);
+                }
+            }
+
+            _disasmRoots();
+
+            _addStringRecords();
+
+            _updateXrefs();
+
+            _endPhase();
+
+            if(pOptions->bPrologueScan)
+            {
+                _beginPhase(PHASE_PROLOGUES);
+                _updatePrologues();
+                _endPhase();
+            }
+
+            // A limit or a stop ends the analysis only, the CFG and the listing of what has been found are always built.
+            // The limits are not tested below, a stop from now on leaves the result not initialised.
+            bStop=false;
+
+            _beginPhase(PHASE_CFG);
+            _updateCFG();
+            _endPhase();
+
+            _beginPhase(PHASE_ADJUST);
+            _adjust();
+            _endPhase();
+
+            _beginPhase(PHASE_UPDATEPOSITIONS);
+            _updatePositions();
+            _endPhase();
+
+            pOptions->stats.bInit=!bStop;
+        }
+        else
+        {
+            emit errorMessage(QString("%1: %2").arg("Architecture").arg(pOptions->stats.memoryMap.sArch));
+        }
+    }
+    else
+    {
+        if(XBinary::isX86asm(pOptions->stats.memoryMap.sArch))
+        {
+            _beginPhase(PHASE_TRAVERSAL);
+
+            _openHandle();
+
+            _removeStringRecords();
+
+            if(nStartAddress!=-1)
+            {
+                if(nRangeSize>0)
+                {
+                    _disasmRange(nStartAddress,nRangeSize);
+                }
+                else
+                {
+                    _disasmRoot(nStartAddress);
+                }
+            }
+
+            _disasmRoots();
+
+            _addStringRecords();
+
+            _updateXrefs();
+
+            _endPhase();
+
+            if(pOptions->bPrologueScan)
+            {
+                _beginPhase(PHASE_PROLOGUES);
+                _updatePrologues();
+                _endPhase();
+            }
+
+            bStop=false;
+
+            _beginPhase(PHASE_CFG);
+            _updateCFG();
+            _endPhase();
+
+            // Only the view blocks of the records that the run has inserted are rebuilt,
+            // the positions before them stay
+            qint64 nStart=nChangedStart;
+            qint64 nEnd=nChangedEnd;
+
+            _beginPhase(PHASE_ADJUST);
+
+            if(nStart!=-1)
+            {
+                _extendRange(&nStart,&nEnd);
+                _adjustRange(nStart,nEnd-nStart);
+            }
+            else
+            {
+                _updateTargetLabels();
+            }
+
+            _endPhase();
+
+            _beginPhase(PHASE_UPDATEPOSITIONS);
+
+            if(nStart!=-1)
+            {
+                _updatePositions(nStart);
+            }
+
+            _endPhase();
+
+            if(bStop)
+            {
+                pOptions->stats.bInit=false;
+            }
+        }
+        else
+        {
+            emit errorMessage(QString("%1: %2").arg("Architecture").arg(pOptions->stats.memoryMap.sArch));
+        }
+    }
+
+    publishSnapshot(pOptions);
+
+    emit processFinished();
+}
+
+void XDisasm::processToData()
+{
+    XDISASM_TRACE("XDisasm::processToData");
+
+    bStop=false;
+    nLimitCounter=0;
+    stChangedTargets.clear();
+    timer.start();
+
+    qint64 nSize=nRangeSize;
+
+    if(nSize<=0)
+    {
+        nSize=qMax(pOptions->stats.mapRecords.value(nStartAddress).nSize,(qint64)1);
+    }
+
+    qint64 nStart=nStartAddress;
+    qint64 nEnd=nStartAddress+nSize;
+
+    // The whole range in one pass: the records, the xrefs and the view blocks of the range only
+    _beginPhase(PHASE_TRAVERSAL);
+
+    _extendRange(&nStart,&nEnd);
+
+    _removeStringRecords();
+
+    _removeRange(nStart,nEnd-nStart);
+
+    _addStringRecords();
+
+    _updateXrefs();
+
+    _endPhase();
+
+    bStop=false;
+
+    _beginPhase(PHASE_CFG);
+    _updateCFG();
+    _endPhase();
+
+    _beginPhase(PHASE_ADJUST);
+    _extendRange(&nStart,&nEnd); // strings that were hidden by the instructions
+    _adjustRange(nStart,nEnd-nStart);
+    _endPhase();
+
+    _beginPhase(PHASE_UPDATEPOSITIONS);
+    _updatePositions(nStart);
+    _endPhase();
+
+    if(bStop)
+    {
+        pOptions->stats.bInit=false;
+    }
+
+    publishSnapshot(pOptions);
+
+    emit processFinished();
+}
+
+void XDisasm::process()
+{
+    if(dm==DM_DISASM)
+    {
+        processDisasm();
+    }
+    else if(dm==DM_TODATA)
+    {
+        processToData();
+    }
+}
+
+void XDisasm::stop()
+{
+    bStop=true;
+}
+
+XDisasm::STATS *XDisasm::getStats()
+{
+    return &(pOptions->stats);
+}
+
+QSharedPointer<XDisasm::STATS> XDisasm::getSnapshot()
+{
+    return getSnapshot(pOptions);
+}
+
+XDisasm::PROGRESS XDisasm::getProgress()
+{
+    QMutexLocker locker(&mutexProgress);
+
+    return progress;
+}
+
+QSharedPointer<XDisasm::STATS> XDisasm::getSnapshot(XDisasm::OPTIONS *pOptions)
+{
+    // The snapshot is published only when a run finishes: while a run is going the views show the previous run,
+    // the progress of the current one is in getProgress()
+    QSharedPointer<STATS> pResult;
+
+    std::shared_ptr<QSharedPointer<STATS> > pHolder=std::atomic_load(&(pOptions->pSnapshot));
+
+    if(pHolder)
+    {
+        pResult=*pHolder;
+    }
+
+    return pResult;
+}
+
+void XDisasm::publishSnapshot(XDisasm::OPTIONS *pOptions)
+{
+    // A shallow copy: the Qt containers are implicitly shared, the engine detaches the ones it changes later
+    // The holder is never changed after it is stored, a reader that still has the old one keeps it alive
+    std::shared_ptr<QSharedPointer<STATS> > pHolder=std::make_shared<QSharedPointer<STATS> >(new STATS(pOptions->stats));
+
+    std::atomic_store(&(pOptions->pSnapshot),pHolder);
+}
+
+QList<XDisasm::MEMORY_RECORD> XDisasm::getMemoryRecords(XDisasm::STATS *pStats)
+{
+    // Qt5 containers on a 64-bit system:
+    // QMap node: parent/left/right + key + value; QHash node: next + hash + key, one bucket per node.
+    // Every node is a separate allocation with ~16 bytes of heap overhead.
+    const qint64 N_HEAP=16;
+    const qint64 N_MAP_NODE=3*sizeof(void *);
+    const qint64 N_HASH_NODE=sizeof(void *)+sizeof(uint)+sizeof(qint64)+sizeof(void *);
+    const qint64 N_STRING=sizeof(QArrayData)+2*(N_NAME_LENGTH+1);
+
+    QList<MEMORY_RECORD> listResult;
+
+    MEMORY_RECORD record={};
+
+    record.sName="listRoots";
+    record.nCount=pStats->listRoots.count();
+    record.nSize=pStats->listRoots.capacity()*sizeof(qint64);
+    listResult.append(record);
+
+    record.sName="listSymbols";
+    record.nCount=pStats->listSymbols.count();
+    record.nSize=pStats->listSymbols.capacity()*sizeof(SYMBOL);
+    listResult.append(record);
+
+    record.sName="entropy";
+    record.nCount=pStats->entropy.listWindows.count();
+    record.nSize=   pStats->entropy.listWindows.capacity()*sizeof(WINDOW)+
+                    pStats->entropy.listRegions.capacity()*sizeof(ENTROPY_REGION);
+    listResult.append(record);
+
+    record.sName="mapRecords";
+    record.nCount=pStats->mapRecords.count();
+    record.nSize=record.nCount*(N_MAP_NODE+sizeof(qint64)+sizeof(RECORD)+N_HEAP);
+    listResult.append(record);
+
+    record.sName="listPendingRefs";
+    record.nCount=pStats->listPendingRefs.count();
+    record.nSize=pStats->listPendingRefs.capacity()*sizeof(XREF);
+    listResult.append(record);
+
+    record.sName="refTo";
+    record.nCount=pStats->refTo.listValues.count();
+    record.nSize=   (pStats->refTo.listKeys.capacity()+pStats->refTo.listValues.capacity())*sizeof(qint64)+
+                    pStats->refTo.listOffsets.capacity()*sizeof(qint32);
+    listResult.append(record);
+
+    record.sName="refFrom";
+    record.nCount=pStats->refFrom.listValues.count();
+    record.nSize=   (pStats->refFrom.listKeys.capacity()+pStats->refFrom.listValues.capacity())*sizeof(qint64)+
+                    pStats->refFrom.listOffsets.capacity()*sizeof(qint32);
+    listResult.append(record);
+
+    record.sName="stCalls";
+    record.nCount=pStats->stCalls.count();
+    record.nSize=record.nCount*(N_HASH_NODE+N_HEAP);
+    listResult.append(record);
+
+    record.sName="stJumps";
+    record.nCount=pStats->stJumps.count();
+    record.nSize=record.nCount*(N_HASH_NODE+N_HEAP);
+    listResult.append(record);
+
+    record.sName="cfg";
+    record.nCount=pStats->cfg.listBlocks.count()+pStats->cfg.listFunctions.count();
+    record.nSize=   pStats->cfg.listBlocks.capacity()*sizeof(BASIC_BLOCK)+
+                    pStats->cfg.listFunctions.capacity()*sizeof(FUNCTION)+
+                    (   pStats->cfg.listSuccessorOffsets.capacity()+pStats->cfg.listSuccessors.capacity()+
+                        pStats->cfg.listPredecessorOffsets.capacity()+pStats->cfg.listPredecessors.capacity()+
+                        pStats->cfg.listFunctionBlockOffsets.capacity()+pStats->cfg.listFunctionBlocks.capacity()+
+                        pStats->cfg.listCalleeOffsets.capacity()+pStats->cfg.listCallees.capacity())*sizeof(qint32);
+    listResult.append(record);
+
+    record.sName="listStrings";
+    record.nCount=pStats->listStrings.count();
+    record.nSize=pStats->listStrings.capacity()*sizeof(STRING);
+    listResult.append(record);
+
+    record.sName="listDataRefs";
+    record.nCount=pStats->listDataRefs.count();
+    record.nSize=pStats->listDataRefs.capacity()*sizeof(XREF);
+    listResult.append(record);
+
+    record.sName="mapVB";
+    record.nCount=pStats->mapVB.count();
+    record.nSize=record.nCount*(N_MAP_NODE+sizeof(qint64)+sizeof(VIEW_BLOCK)+N_HEAP);
+    listResult.append(record);
+
+    record.sName="listLabels";
+    record.nCount=pStats->listLabels.count();
+    record.nSize=pStats->listLabels.capacity()*sizeof(LABEL);
+    listResult.append(record);
+
+    record.sName="mapDataRanges";
+    record.nCount=pStats->mapDataRanges.count();
+    record.nSize=record.nCount*(N_MAP_NODE+2*sizeof(qint64)+N_HEAP);
+    listResult.append(record);
+
+    record.sName="mapUserLabels";
+    record.nCount=pStats->mapUserLabels.count();
+    record.nSize=record.nCount*(N_MAP_NODE+sizeof(qint64)+sizeof(qint32)+N_HEAP);
+    listResult.append(record);
+
+    record.sName="names";
+    record.nCount=pStats->names.listOffsets.count();
+    record.nSize=pStats->names.baData.capacity()+pStats->names.listOffsets.capacity()*sizeof(qint32)+
+                 record.nCount*(N_HASH_NODE+sizeof(QString)+sizeof(qint32)+N_HEAP+N_STRING+N_HEAP);
+    listResult.append(record);
+
+    record.sName="mapPositions";
+    record.nCount=pStats->mapPositions.count();
+    record.nSize=record.nCount*(N_MAP_NODE+2*sizeof(qint64)+N_HEAP);
+    listResult.append(record);
+
+    record.sName="mapAddresses";
+    record.nCount=pStats->mapAddresses.count();
+    record.nSize=record.nCount*(N_MAP_NODE+2*sizeof(qint64)+N_HEAP);
+    listResult.append(record);
+
+    return listResult;
+}
+
+qint64 XDisasm::getMemoryEstimate(XDisasm::STATS *pStats)
+{
+    qint64 nResult=0;
+
+    QList<MEMORY_RECORD> listRecords=getMemoryRecords(pStats);
+
+    int nCount=listRecords.count();
+
+    for(int i=0;i<nCount;i++)
+    {
+        nResult+=listRecords.at(i).nSize;
+    }
+
+    return nResult;
+}
+
+qint64 XDisasm::getPeakMemoryUsage()
+{
+    qint64 nResult=0;
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS pmc={};
+
+    if(GetProcessMemoryInfo(GetCurrentProcess(),&pmc,sizeof(pmc)))
+    {
+        nResult=pmc.PeakWorkingSetSize;
+    }
+#else
+    struct rusage usage={};
+
+    if(getrusage(RUSAGE_SELF,&usage)==0)
+    {
+#ifdef Q_OS_MAC
+        nResult=usage.ru_maxrss;
+#else
+        nResult=usage.ru_maxrss*1024; // KB
+#endif
+    }
+#endif
+    return nResult;
+}
+
+void XDisasm::_adjust()
+{
+    pOptions->stats.mapVB.clear();
+
+    _updateLabels();
+
+    stChangedTargets.clear();
+
+    if(!bStop)
+    {
+    //    QSet<qint64> stFunctionLabels;
+    //    QSet<qint64> stJmpLabels;
+    //    QMap<qint64,qint64> mapDataSizeLabels; // Set Max
+    //    QSet<qint64> stDataLabels;
+
+        QMapIterator<qint64,XDisasm::RECORD> iRecords(pOptions->stats.mapRecords);
+        while(iRecords.hasNext()&&(!bStop))
+        {
+            iRecords.next();
+
+            qint64 nAddress=iRecords.key();
+
+            VIEW_BLOCK record;
+            record.nAddress=nAddress;
+            record.nOffset=iRecords.value().nOffset;
+            record.nSize=iRecords.value().nSize;
+
+            if(iRecords.value().type==RECORD_TYPE_OPCODE)
+            {
+                record.type=VBT_OPCODE;
+            }
+            else if(iRecords.value().type==RECORD_TYPE_DATA)
+            {
+                record.type=VBT_DATA;
+            }
+
+            if(!pOptions->stats.mapVB.contains(nAddress))
+            {
+                pOptions->stats.mapVB.insert(nAddress,record);
+            }
+        }
+
+        int nMMCount=pOptions->stats.memoryMap.listRecords.count(); // TODO
+
+        for(int i=0;(i<nMMCount)&&(!bStop);i++)
+        {
+            qint64 nRegionAddress=pOptions->stats.memoryMap.listRecords.at(i).nAddress;
+            qint64 nRegionOffset=pOptions->stats.memoryMap.listRecords.at(i).nOffset;
+            qint64 nRegionSize=pOptions->stats.memoryMap.listRecords.at(i).nSize;
+
+            if(nRegionAddress!=-1)
+            {
+                for(qint64 nCurrentAddress=nRegionAddress,nCurrentOffset=nRegionOffset;(nCurrentAddress<(nRegionAddress+nRegionSize))&&(!bStop);)
+                {
+                    VIEW_BLOCK vb=pOptions->stats.mapVB.value(nCurrentAddress);
+
+                    if(!vb.nSize)
+                    {
+                        QMap<qint64,VIEW_BLOCK>::const_iterator iter=pOptions->stats.mapVB.lowerBound(nCurrentAddress);
+
+                        qint64 nBlockAddress=0;
+                        qint64 nBlockOffset=0;
+                        qint64 nBlockSize=0;
+
+                        qint64 nIterKey=iter.key();
+
+                        if(pOptions->stats.mapVB.count())
+                        {
+                            if(nIterKey==pOptions->stats.mapVB.firstKey()) // TODO move outside 'for'
+                            {
+//                                nBlockAddress=pOptions->stats.nImageBase;
+                                nBlockAddress=pOptions->stats.memoryMap.listRecords.at(0).nAddress;
+                                nBlockOffset=pOptions->stats.memoryMap.listRecords.at(0).nOffset;
+
+                                if(nIterKey<(nRegionAddress+nRegionSize))
+                                {
+                                    nBlockSize=iter.key()-pOptions->stats.nImageBase;
+                                }
+                                else
+                                {
+                                    nBlockSize=(nRegionAddress+nRegionSize)-nBlockAddress;
+                                }
+                            }
+                            else if(iter==pOptions->stats.mapVB.end())
+                            {
+                                nBlockAddress=nCurrentAddress;
+                                nBlockOffset=nCurrentOffset;
+
+                                nBlockSize=(nRegionAddress+nRegionSize)-nBlockAddress;
+                            }
+                            else
+                            {
+                                nBlockAddress=nCurrentAddress;
+                                nBlockOffset=nCurrentOffset;
+                                if(nIterKey<(nRegionAddress+nRegionSize))
+                                {
+                                    nBlockSize=iter.key()-nBlockAddress;
+                                }
+                                else
+                                {
+                                    nBlockSize=(nRegionAddress+nRegionSize)-nBlockAddress;
+                                }
+                            }
+                        }
+                        else
+                        {
+                            nBlockAddress=nCurrentAddress;
+                            nBlockOffset=nCurrentOffset;
+
+                            nBlockSize=(nRegionAddress+nRegionSize)-nBlockAddress;
+                        }
+
+                        qint64 _nAddress=nBlockAddress;
+                        qint64 _nOffset=nBlockOffset;
+                        qint64 _nSize=nBlockSize;
+
+                        if(_nOffset!=-1)
+                        {
+                            while(_nSize>=16)
+                            {
+                                VIEW_BLOCK record;
+                                record.nAddress=_nAddress;
+                                record.nOffset=_nOffset;
+                                record.nSize=16;
+                                record.type=VBT_DATABLOCK;
+
+                                if(!pOptions->stats.mapVB.contains(_nAddress))
+                                {
+                                    pOptions->stats.mapVB.insert(_nAddress,record);
+                                }
+
+                                _nSize-=16;
+                                _nAddress+=16;
+                                _nOffset+=16;
+                            }
+                        }
+                        else
+                        {
+                            VIEW_BLOCK record;
+                            record.nAddress=_nAddress;
+                            record.nOffset=-1;
+                            record.nSize=_nSize;
+                            record.type=VBT_DATABLOCK;
+
+                            if(!pOptions->stats.mapVB.contains(_nAddress))
+                            {
+                                pOptions->stats.mapVB.insert(_nAddress,record);
+                            }
+                        }
+
+                        nCurrentAddress=nBlockAddress+nBlockSize;
+                        if(nBlockOffset!=-1)
+                        {
+                            nCurrentOffset=nBlockOffset+nBlockSize;
+                        }
+                    }
+                    else
+                    {
+                        nCurrentAddress=vb.nAddress+vb.nSize;
+                        if(nCurrentOffset!=-1)
+                        {
+                            nCurrentOffset=vb.nOffset+vb.nSize;
+                        }
+                    }
+                }
+            }
+        }
+
+//        QMapIterator<qint64,qint64> iDS(stats.mmapDataLabels);
+//        while(iDS.hasNext())
+//        {
+//            iDS.next();
+
+//            qint64 nAddress=iDS.key();
+
+//            VIEW_BLOCK record;
+//            record.nOffset=pBinary->addressToOffset(pListMM,nAddress);
+//            record.nSize=iDS.value();
+//            record.type=VBT_DATA;
+
+//            if(!stats.mapVB.contains(nAddress))
+//            {
+//                stats.mapVB.insert(nAddress,record);
+//            }
+//        }
+
+//        QSetIterator<qint64> iD(stats.stDataLabels);
+//        while(iD.hasNext()&&(!bStop))
+//        {
+//            qint64 nAddress=iD.next();
+
+//            VIEW_BLOCK record;
+//            record.nOffset=pBinary->addressToOffset(pListMM,nAddress);
+//            record.nSize=0;
+//            record.type=VBT_DATA;
+
+//            if(!stats.mapVB.contains(nAddress))
+//            {
+//                stats.mapVB.insert(nAddress,record);
+//            }
+//        }
+
+        // TODO Check errors
+    }
+}
+
+void XDisasm::_updateLabels()
+{
+    pOptions->stats.listLabels.clear();
+
+    if(!bStop)
+    {
+        QVector<LABEL> listLabels;
+        listLabels.reserve(1+pOptions->stats.mapUserLabels.count()+pOptions->stats.listSymbols.count()+pOptions->stats.listRoots.count()+pOptions->stats.stCalls.count()+pOptions->stats.stJumps.count()+pOptions->stats.nStringRecords);
+
+        LABEL label={};
+
+        QMapIterator<qint64,qint32> iUL(pOptions->stats.mapUserLabels);
+        while(iUL.hasNext())
+        {
+            iUL.next();
+
+            label.nAddress=iUL.key();
+            label.type=LABEL_TYPE_USER;
+            label.nName=iUL.value();
+
+            listLabels.append(label);
+        }
+
+        label.nName=-1;
+
+        label.nAddress=pOptions->stats.nEntryPointAddress;
+        label.type=LABEL_TYPE_ENTRYPOINT;
+        listLabels.append(label);
+
+        int nNumberOfSymbols=pOptions->stats.listSymbols.count();
+
+        for(int i=0;i<nNumberOfSymbols;i++)
+        {
+            const SYMBOL &symbol=pOptions->stats.listSymbols.at(i);
+
+            label.nAddress=symbol.nAddress;
+            label.type=(symbol.nName!=-1)?LABEL_TYPE_SYMBOL:LABEL_TYPE_FUNCTION;
+            label.nName=symbol.nName;
+
+            listLabels.append(label);
+        }
+
+        label.nName=-1;
+
+        QVector<qint64> listRoots=_getCodeRoots();
+
+        int nNumberOfRoots=listRoots.count();
+
+        for(int i=0;i<nNumberOfRoots;i++)
+        {
+            label.nAddress=listRoots.at(i);
+            label.type=LABEL_TYPE_FUNCTION;
+
+            listLabels.append(label);
+        }
+
+        QSetIterator<qint64> iFL(pOptions->stats.stCalls);
+        while(iFL.hasNext())
+        {
+            label.nAddress=iFL.next();
+            label.type=LABEL_TYPE_FUNCTION;
+
+            listLabels.append(label);
+        }
+
+        QSetIterator<qint64> iJL(pOptions->stats.stJumps);
+        while(iJL.hasNext())
+        {
+            label.nAddress=iJL.next();
+            label.type=LABEL_TYPE_JUMP;
+
+            listLabels.append(label);
+        }
+
+        int nNumberOfStrings=pOptions->stats.listStrings.count();
+
+        for(int i=0;i<nNumberOfStrings;i++)
+        {
+            qint64 nAddress=pOptions->stats.listStrings.at(i).nAddress;
+
+            QMap<qint64,RECORD>::const_iterator iter=pOptions->stats.mapRecords.constFind(nAddress);
+
+            if((iter!=pOptions->stats.mapRecords.constEnd())&&(iter.value().type==RECORD_TYPE_DATA))
+            {
+                label.nAddress=nAddress;
+                label.type=LABEL_TYPE_STRING;
+
+                listLabels.append(label);
+            }
+        }
+
+        // One label per address, the lowest type wins: user, entry point, symbol, function, jump, string
+        std::sort(listLabels.begin(),listLabels.end(),_labelLessThan);
+
+        int nNumberOfLabels=listLabels.count();
+        int nCount=0;
+
+        for(int i=0;i<nNumberOfLabels;i++)
+        {
+            if((nCount==0)||(listLabels.at(nCount-1).nAddress!=listLabels.at(i).nAddress))
+            {
+                listLabels[nCount]=listLabels.at(i);
+                nCount++;
+            }
+        }
+
+        listLabels.resize(nCount);
+        listLabels.squeeze();
+
+        pOptions->stats.listLabels=listLabels;
+    }
+}
+
+void XDisasm::_updateLabels(qint64 nAddress, qint64 nSize)
+{
+    // As _updateLabels() for the addresses of the range only
+    qint64 nEnd=nAddress+nSize;
+
+    QVector<LABEL> listLabels;
+
+    LABEL label={};
+
+    QMap<qint64,qint32>::const_iterator iterUL=pOptions->stats.mapUserLabels.lowerBound(nAddress);
+
+    while((iterUL!=pOptions->stats.mapUserLabels.constEnd())&&(iterUL.key()<nEnd))
+    {
+        label.nAddress=iterUL.key();
+        label.type=LABEL_TYPE_USER;
+        label.nName=iterUL.value();
+
+        listLabels.append(label);
+
+        ++iterUL;
+    }
+
+    label.nName=-1;
+
+    if((pOptions->stats.nEntryPointAddress>=nAddress)&&(pOptions->stats.nEntryPointAddress<nEnd))
+    {
+        label.nAddress=pOptions->stats.nEntryPointAddress;
+        label.type=LABEL_TYPE_ENTRYPOINT;
+        listLabels.append(label);
+    }
+
+    SYMBOL symbolBegin={};
+    symbolBegin.nAddress=nAddress;
+
+    QVector<SYMBOL>::const_iterator iterSymbol=std::lower_bound(pOptions->stats.listSymbols.constBegin(),pOptions->stats.listSymbols.constEnd(),symbolBegin,
+                                                                [](const SYMBOL &symbol,const SYMBOL &value){return symbol.nAddress<value.nAddress;});
+
+    for(;(iterSymbol!=pOptions->stats.listSymbols.constEnd())&&(iterSymbol->nAddress<nEnd);++iterSymbol)
+    {
+        label.nAddress=iterSymbol->nAddress;
+        label.type=(iterSymbol->nName!=-1)?LABEL_TYPE_SYMBOL:LABEL_TYPE_FUNCTION;
+        label.nName=iterSymbol->nName;
+
+        listLabels.append(label);
+    }
+
+    label.nName=-1;
+
+    int nNumberOfRoots=pOptions->stats.listRoots.count();
+
+    for(int i=0;i<nNumberOfRoots;i++)
+    {
+        qint64 nRoot=pOptions->stats.listRoots.at(i);
+
+        if((nRoot>=nAddress)&&(nRoot<nEnd)&&(!_isDataRange(nRoot)))
+        {
+            label.nAddress=nRoot;
+            label.type=LABEL_TYPE_FUNCTION;
+
+            listLabels.append(label);
+        }
+    }
+
+    // The call and jump targets of the range are the keys of refFrom and the records, a target without xrefs jumps to itself
+    QVector<qint64> listTargets;
+
+    const qint64 *pKeys=pOptions->stats.refFrom.listKeys.constData();
+    const qint64 *pKeysEnd=pKeys+pOptions->stats.refFrom.listKeys.count();
+
+    for(const qint64 *pKey=std::lower_bound(pKeys,pKeysEnd,nAddress);(pKey!=pKeysEnd)&&(*pKey<nEnd);pKey++)
+    {
+        listTargets.append(*pKey);
+    }
+
+    QMap<qint64,RECORD>::const_iterator iterRecord=pOptions->stats.mapRecords.lowerBound(nAddress);
+
+    for(;(iterRecord!=pOptions->stats.mapRecords.constEnd())&&(iterRecord.key()<nEnd);++iterRecord)
+    {
+        if(iterRecord.value().type==RECORD_TYPE_OPCODE)
+        {
+            listTargets.append(iterRecord.key());
+        }
+    }
+
+    int nNumberOfTargets=listTargets.count();
+
+    for(int i=0;i<nNumberOfTargets;i++)
+    {
+        qint64 nTarget=listTargets.at(i);
+
+        if(pOptions->stats.stCalls.contains(nTarget))
+        {
+            label.nAddress=nTarget;
+            label.type=LABEL_TYPE_FUNCTION;
+
+            listLabels.append(label);
+        }
+
+        if(pOptions->stats.stJumps.contains(nTarget))
+        {
+            label.nAddress=nTarget;
+            label.type=LABEL_TYPE_JUMP;
+
+            listLabels.append(label);
+        }
+    }
+
+    STRING stringBegin={};
+    stringBegin.nAddress=nAddress;
+
+    QVector<STRING>::const_iterator iterString=std::lower_bound(pOptions->stats.listStrings.constBegin(),pOptions->stats.listStrings.constEnd(),stringBegin,
+                                                                [](const STRING &string,const STRING &value){return string.nAddress<value.nAddress;});
+
+    for(;(iterString!=pOptions->stats.listStrings.constEnd())&&(iterString->nAddress<nEnd);++iterString)
+    {
+        QMap<qint64,RECORD>::const_iterator iter=pOptions->stats.mapRecords.constFind(iterString->nAddress);
+
+        if((iter!=pOptions->stats.mapRecords.constEnd())&&(iter.value().type==RECORD_TYPE_DATA))
+        {
+            label.nAddress=iterString->nAddress;
+            label.type=LABEL_TYPE_STRING;
+
+            listLabels.append(label);
+        }
+    }
+
+    std::sort(listLabels.begin(),listLabels.end(),_labelLessThan);
+
+    int nNumberOfLabels=listLabels.count();
+    int nCount=0;
+
+    for(int i=0;i<nNumberOfLabels;i++)
+    {
+        if((nCount==0)||(listLabels.at(nCount-1).nAddress!=listLabels.at(i).nAddress))
+        {
+            listLabels[nCount]=listLabels.at(i);
+            nCount++;
+        }
+    }
+
+    listLabels.resize(nCount);
+
+    // The labels of the range are replaced in place
+    QVector<LABEL> *pListLabels=&(pOptions->stats.listLabels);
+
+    LABEL labelBegin={};
+    labelBegin.nAddress=nAddress;
+    LABEL labelEnd={};
+    labelEnd.nAddress=nEnd;
+
+    int nBegin=(int)(std::lower_bound(pListLabels->begin(),pListLabels->end(),labelBegin,_labelLessThan)-pListLabels->begin());
+    int nRangeEnd=(int)(std::lower_bound(pListLabels->begin(),pListLabels->end(),labelEnd,_labelLessThan)-pListLabels->begin());
+
+    pListLabels->remove(nBegin,nRangeEnd-nBegin);
+    pListLabels->insert(nBegin,nCount,label);
+    std::copy(listLabels.constBegin(),listLabels.constEnd(),pListLabels->begin()+nBegin);
+}
+
+void XDisasm::_updateTargetLabels()
+{
+    // An xref target outside of the changed range may become or stop being a function or a jump label
+    QSetIterator<qint64> iTargets(stChangedTargets);
+    while(iTargets.hasNext()&&(!bStop))
+    {
+        _updateLabels(iTargets.next(),1);
+    }
+
+    stChangedTargets.clear();
+}
+
+void XDisasm::_updatePositions(qint64 nAddress)
+{
+    qint64 nImageSize=pOptions->stats.nImageSize;
+    qint64 nVBCount=pOptions->stats.mapVB.count();
+    qint64 nVBSize=getVBSize(&(pOptions->stats.mapVB));
+    pOptions->stats.nPositions=nImageSize+nVBCount-nVBSize; // TODO
+
+    QMap<qint64,qint64> *pMapPositions=&(pOptions->stats.mapPositions);
+    QMap<qint64,qint64> *pMapAddresses=&(pOptions->stats.mapAddresses);
+    const QMap<qint64,VIEW_BLOCK> &mapVB=pOptions->stats.mapVB;
+
+    qint64 nCurrentAddress=pOptions->stats.nImageBase; // TODO
+    qint64 nCurrentPosition=0;
+
+    if(nAddress==-1)
+    {
+        pMapPositions->clear();
+        pMapAddresses->clear();
+    }
+    else
+    {
+        // The blocks before the address keep their positions
+        QMap<qint64,qint64>::iterator iterAddress=pMapAddresses->lowerBound(nAddress);
+
+        if(iterAddress!=pMapAddresses->begin())
+        {
+            QMap<qint64,qint64>::iterator iterPrev=iterAddress;
+            --iterPrev;
+
+            nCurrentAddress=iterPrev.key()+mapVB.value(iterPrev.key()).nSize;
+            nCurrentPosition=iterPrev.value()+1;
+        }
+
+        if(iterAddress!=pMapAddresses->end())
+        {
+            QMap<qint64,qint64>::iterator iterPosition=pMapPositions->lowerBound(iterAddress.value());
+
+            while(iterPosition!=pMapPositions->end())
+            {
+                iterPosition=pMapPositions->erase(iterPosition);
+            }
+
+            while(iterAddress!=pMapAddresses->end())
+            {
+                iterAddress=pMapAddresses->erase(iterAddress);
+            }
+        }
+    }
+
+    // A block is one position, every byte between the blocks is one position
+    QMap<qint64,VIEW_BLOCK>::const_iterator iterVB=mapVB.lowerBound(nCurrentAddress);
+
+    while(iterVB!=mapVB.constEnd())
+    {
+        qint64 nVBAddress=iterVB.key();
+
+        if(nVBAddress>=nCurrentAddress) // a block inside of the previous one has no position
+        {
+            nCurrentPosition+=(nVBAddress-nCurrentAddress);
+
+            if(nCurrentPosition>=pOptions->stats.nPositions)
+            {
+                break;
+            }
+
+            pMapPositions->insert(nCurrentPosition,nVBAddress);
+            pMapAddresses->insert(nVBAddress,nCurrentPosition);
+
+            nCurrentAddress=nVBAddress+iterVB.value().nSize;
+            nCurrentPosition++;
+        }
+
+        ++iterVB;
+    }
+}
+
+void XDisasm::_adjustRange(qint64 nAddress, qint64 nSize)
+{
+    if(!bStop)
+    {
+        _updateLabels(nAddress,nSize);
+        _updateTargetLabels();
+
+        qint64 nEnd=nAddress+nSize;
+
+        QMap<qint64,VIEW_BLOCK> *pMapVB=&(pOptions->stats.mapVB);
+        const QMap<qint64,RECORD> &mapRecords=pOptions->stats.mapRecords;
+
+        QMap<qint64,VIEW_BLOCK>::iterator iterVB=pMapVB->lowerBound(nAddress);
+
+        while((iterVB!=pMapVB->end())&&(iterVB.key()<nEnd))
+        {
+            iterVB=pMapVB->erase(iterVB);
+        }
+
+        qint64 nCurrentAddress=nAddress;
+
+        QMap<qint64,RECORD>::const_iterator iterRecord=mapRecords.lowerBound(nAddress);
+
+        while((iterRecord!=mapRecords.constEnd())&&(iterRecord.key()<nEnd)&&(!bStop))
+        {
+            qint64 nRecordAddress=iterRecord.key();
+
+            if(nRecordAddress>nCurrentAddress)
+            {
+                _addDataBlocks(nCurrentAddress,nRecordAddress-nCurrentAddress);
+            }
+
+            VIEW_BLOCK record;
+            record.nAddress=nRecordAddress;
+            record.nOffset=iterRecord.value().nOffset;
+            record.nSize=iterRecord.value().nSize;
+
+            if(iterRecord.value().type==RECORD_TYPE_OPCODE)
+            {
+                record.type=VBT_OPCODE;
+            }
+            else if(iterRecord.value().type==RECORD_TYPE_DATA)
+            {
+                record.type=VBT_DATA;
+            }
+
+            pMapVB->insert(nRecordAddress,record);
+
+            nCurrentAddress=qMax(nCurrentAddress,nRecordAddress+record.nSize);
+
+            ++iterRecord;
+        }
+
+        if(nCurrentAddress<nEnd)
+        {
+            _addDataBlocks(nCurrentAddress,nEnd-nCurrentAddress);
+        }
+    }
+}
+
+void XDisasm::_addDataBlocks(qint64 nAddress, qint64 nSize)
+{
+    // As _adjust does: 16 bytes per block, one block for a region without file data
+    qint64 nEnd=nAddress+nSize;
+
+    int nMMCount=pOptions->stats.memoryMap.listRecords.count();
+
+    for(int i=0;i<nMMCount;i++)
+    {
+        qint64 nRegionAddress=pOptions->stats.memoryMap.listRecords.at(i).nAddress;
+        qint64 nRegionOffset=pOptions->stats.memoryMap.listRecords.at(i).nOffset;
+        qint64 nRegionSize=pOptions->stats.memoryMap.listRecords.at(i).nSize;
+
+        if(nRegionAddress!=-1)
+        {
+            qint64 nBlockAddress=qMax(nAddress,nRegionAddress);
+            qint64 nBlockEnd=qMin(nEnd,nRegionAddress+nRegionSize);
+
+            VIEW_BLOCK record;
+            record.type=VBT_DATABLOCK;
+
+            if(nRegionOffset!=-1)
+            {
+                qint64 nBlockOffset=nRegionOffset+(nBlockAddress-nRegionAddress);
+
+                while((nBlockEnd-nBlockAddress)>=16)
+                {
+                    record.nAddress=nBlockAddress;
+                    record.nOffset=nBlockOffset;
+                    record.nSize=16;
+
+                    pOptions->stats.mapVB.insert(nBlockAddress,record);
+
+                    nBlockAddress+=16;
+                    nBlockOffset+=16;
+                }
+            }
+            else if(nBlockAddress<nBlockEnd)
+            {
+                record.nAddress=nBlockAddress;
+                record.nOffset=-1;
+                record.nSize=nBlockEnd-nBlockAddress;
+
+                pOptions->stats.mapVB.insert(nBlockAddress,record);
+            }
+        }
+    }
+}
+
+void XDisasm::_extendRange(qint64 *pnStart, qint64 *pnEnd)
+{
+    const QMap<qint64,RECORD> &mapRecords=pOptions->stats.mapRecords;
+    const QMap<qint64,VIEW_BLOCK> &mapVB=pOptions->stats.mapVB;
+
+    bool bChanged=true;
+
+    while(bChanged)
+    {
+        bChanged=false;
+
+        QMap<qint64,RECORD>::const_iterator iterRecord=mapRecords.lowerBound(*pnStart);
+
+        if(iterRecord!=mapRecords.constBegin())
+        {
+            --iterRecord;
+
+            if((iterRecord.key()+iterRecord.value().nSize)>*pnStart)
+            {
+                *pnStart=iterRecord.key();
+                bChanged=true;
+            }
+        }
+
+        iterRecord=mapRecords.lowerBound(*pnEnd);
+
+        if(iterRecord!=mapRecords.constBegin())
+        {
+            --iterRecord;
+
+            if((iterRecord.key()+iterRecord.value().nSize)>*pnEnd)
+            {
+                *pnEnd=iterRecord.key()+iterRecord.value().nSize;
+                bChanged=true;
+            }
+        }
+
+        QMap<qint64,VIEW_BLOCK>::const_iterator iterVB=mapVB.lowerBound(*pnStart);
+
+        if(iterVB!=mapVB.constBegin())
+        {
+            --iterVB;
+
+            if((iterVB.key()+iterVB.value().nSize)>*pnStart)
+            {
+                *pnStart=iterVB.key();
+                bChanged=true;
+            }
+        }
+
+        iterVB=mapVB.lowerBound(*pnEnd);
+
+        if(iterVB!=mapVB.constBegin())
+        {
+            --iterVB;
+
+            if((iterVB.key()+iterVB.value().nSize)>*pnEnd)
+            {
+                *pnEnd=iterVB.key()+iterVB.value().nSize;
+                bChanged=true;
+            }
+        }
+    }
+}
+
+void XDisasm::_updateXrefs()
+{
+    // Only the new edges are sorted, the index is patched with the ones that it does not have yet
+    QVector<XREF> listRefs;
+    listRefs.swap(pOptions->stats.listPendingRefs);
+
+    std::sort(listRefs.begin(),listRefs.end(),_xrefLessThan);
+
+    int nNumberOfRefs=listRefs.count();
+    int nCount=0;
+
+    for(int i=0;i<nNumberOfRefs;i++)
+    {
+        XREF xref=listRefs.at(i);
+
+        if((nCount==0)||(listRefs.at(nCount-1).nFrom!=xref.nFrom)||(listRefs.at(nCount-1).nTo!=xref.nTo))
+        {
+            qint32 nRefCount=0;
+            const qint64 *pRefs=_getRefs(&(pOptions->stats.refTo),xref.nFrom,&nRefCount);
+
+            if((!pRefs)||(!std::binary_search(pRefs,pRefs+nRefCount,xref.nTo)))
+            {
+                if(pOptions->stats.bInit)
+                {
+                    stChangedTargets.insert(xref.nTo);
+                }
+
+                listRefs[nCount]=xref;
+                nCount++;
+            }
+        }
+    }
+
+    listRefs.resize(nCount);
+
+    QVector<XREF> listRemove;
+
+    _patchXrefIndex(&(pOptions->stats.refTo),&listRemove,&listRefs,false);
+
+    std::sort(listRefs.begin(),listRefs.end(),_xrefReverseLessThan);
+
+    _patchXrefIndex(&(pOptions->stats.refFrom),&listRemove,&listRefs,true);
+}
+
+void XDisasm::_updateCFG()
+{
+    CFG cfg;
+
+    // Leaders: the entry point, the roots, the symbols, every xref target (the keys of refFrom) and the instruction after a branch
+    // The roots inside of the data ranges are not decoded
+    QVector<qint64> listRoots=_getCodeRoots();
+
+    QVector<qint64> listLeaders=pOptions->stats.refFrom.listKeys;
+    listLeaders.append(pOptions->stats.nEntryPointAddress);
+    listLeaders+=listRoots;
+
+    int nNumberOfSymbols=pOptions->stats.listSymbols.count();
+
+    for(int i=0;i<nNumberOfSymbols;i++)
+    {
+        listLeaders.append(pOptions->stats.listSymbols.at(i).nAddress);
+    }
+
+    std::sort(listLeaders.begin(),listLeaders.end());
+
+    const qint64 *pTargets=listLeaders.constData();
+    qint32 nNumberOfTargets=listLeaders.count();
+    qint32 nTarget=0;
+
+    QVector<quint32> listLastFlags; // flags of the last instruction of the block
+    QVector<qint64> listLastAddresses;
+    QVector<qint32> listCallSiteOffsets; // per block
+    QVector<qint64> listCallSites; // call targets
+
+    qint64 nNextAddress=-1; // -1 if the current block is closed
+
+    QMap<qint64,RECORD>::const_iterator iter=pOptions->stats.mapRecords.constBegin();
+    QMap<qint64,RECORD>::const_iterator iterEnd=pOptions->stats.mapRecords.constEnd();
+
+    for(;(iter!=iterEnd)&&(!bStop);++iter)
+    {
+        qint64 nAddress=iter.key();
+        const RECORD &record=iter.value();
+
+        if(record.type==RECORD_TYPE_OPCODE)
+        {
+            while((nTarget<nNumberOfTargets)&&(pTargets[nTarget]<nAddress))
+            {
+                nTarget++;
+            }
+
+            if((nAddress!=nNextAddress)||((nTarget<nNumberOfTargets)&&(pTargets[nTarget]==nAddress)))
+            {
+                BASIC_BLOCK block={};
+                block.nAddress=nAddress;
+                block.nFunction=-1;
+
+                cfg.listBlocks.append(block);
+                listLastFlags.append(0);
+                listLastAddresses.append(nAddress);
+                listCallSiteOffsets.append(listCallSites.count());
+            }
+
+            qint32 nBlock=cfg.listBlocks.count()-1;
+
+            cfg.listBlocks[nBlock].nSize+=record.nSize;
+            cfg.listBlocks[nBlock].nInstructions++;
+            listLastFlags[nBlock]=record.nFlags;
+            listLastAddresses[nBlock]=nAddress;
+
+            if(record.nFlags&RF_CALL)
+            {
+                qint32 nCount=0;
+                const qint64 *pRefs=_getRefs(&(pOptions->stats.refTo),nAddress,&nCount);
+
+                for(qint32 i=0;i<nCount;i++)
+                {
+                    listCallSites.append(pRefs[i]);
+                }
+            }
+
+            if(record.nFlags&(RF_JUMP|RF_CONDJUMP|RF_ENDBRANCH))
+            {
+                nNextAddress=-1;
+            }
+            else
+            {
+                nNextAddress=nAddress+record.nSize;
+            }
+        }
+        else
+        {
+            nNextAddress=-1;
+        }
+    }
+
+    listCallSiteOffsets.append(listCallSites.count());
+
+    qint32 nNumberOfBlocks=cfg.listBlocks.count();
+
+    // Successors
+    cfg.listSuccessorOffsets.reserve(nNumberOfBlocks+1);
+
+    for(qint32 i=0;i<nNumberOfBlocks;i++)
+    {
+        qint32 nStart=cfg.listSuccessors.count();
+
+        cfg.listSuccessorOffsets.append(nStart);
+
+        quint32 nFlags=listLastFlags.at(i);
+
+        if(nFlags&(RF_JUMP|RF_CONDJUMP))
+        {
+            qint32 nCount=0;
+            const qint64 *pRefs=_getRefs(&(pOptions->stats.refTo),listLastAddresses.at(i),&nCount);
+
+            for(qint32 j=0;j<nCount;j++)
+            {
+                qint32 nBlock=_findBlockStart(&cfg,pRefs[j]);
+
+                if(nBlock!=-1)
+                {
+                    cfg.listSuccessors.append(nBlock);
+                }
+            }
+        }
+
+        if(!(nFlags&RF_ENDBRANCH))
+        {
+            qint64 nEnd=cfg.listBlocks.at(i).nAddress+cfg.listBlocks.at(i).nSize;
+
+            const qint32 *pRow=cfg.listSuccessors.constData()+nStart;
+            const qint32 *pRowEnd=cfg.listSuccessors.constData()+cfg.listSuccessors.count();
+
+            if((i+1<nNumberOfBlocks)&&(cfg.listBlocks.at(i+1).nAddress==nEnd)&&(std::find(pRow,pRowEnd,i+1)==pRowEnd))
+            {
+                cfg.listSuccessors.append(i+1);
+            }
+        }
+    }
+
+    cfg.listSuccessorOffsets.append(cfg.listSuccessors.count());
+
+    // Predecessors: count, prefix sum, fill
+    cfg.listPredecessorOffsets.fill(0,nNumberOfBlocks+1);
+    cfg.listPredecessors.resize(cfg.listSuccessors.count());
+
+    qint32 nNumberOfEdges=cfg.listSuccessors.count();
+
+    for(qint32 i=0;i<nNumberOfEdges;i++)
+    {
+        cfg.listPredecessorOffsets[cfg.listSuccessors.at(i)+1]++;
+    }
+
+    for(qint32 i=0;i<nNumberOfBlocks;i++)
+    {
+        cfg.listPredecessorOffsets[i+1]+=cfg.listPredecessorOffsets.at(i);
+    }
+
+    QVector<qint32> listFill=cfg.listPredecessorOffsets;
+
+    for(qint32 i=0;i<nNumberOfBlocks;i++)
+    {
+        qint32 nEnd=cfg.listSuccessorOffsets.at(i+1);
+
+        for(qint32 j=cfg.listSuccessorOffsets.at(i);j<nEnd;j++)
+        {
+            qint32 nSuccessor=cfg.listSuccessors.at(j);
+
+            cfg.listPredecessors[listFill[nSuccessor]++]=i;
+        }
+    }
+
+    // Functions: the entry point, the roots, the symbols and the call targets that were decoded
+    QVector<qint64> listEntries;
+    listEntries.reserve(pOptions->stats.stCalls.count()+listRoots.count()+nNumberOfSymbols+1);
+
+    QSetIterator<qint64> iCalls(pOptions->stats.stCalls);
+    while(iCalls.hasNext())
+    {
+        listEntries.append(iCalls.next());
+    }
+
+    listEntries.append(pOptions->stats.nEntryPointAddress);
+    listEntries+=listRoots;
+
+    for(int i=0;i<nNumberOfSymbols;i++)
+    {
+        listEntries.append(pOptions->stats.listSymbols.at(i).nAddress);
+    }
+
+    std::sort(listEntries.begin(),listEntries.end());
+
+    QVector<qint32> listEntryFunctions(nNumberOfBlocks,-1);
+
+    int nNumberOfEntries=listEntries.count();
+
+    for(int i=0;i<nNumberOfEntries;i++)
+    {
+        qint32 nBlock=_findBlockStart(&cfg,listEntries.at(i));
+
+        if((nBlock!=-1)&&(listEntryFunctions.at(nBlock)==-1))
+        {
+            FUNCTION function={};
+            function.nAddress=listEntries.at(i);
+            function.nBlock=nBlock;
+
+            listEntryFunctions[nBlock]=cfg.listFunctions.count();
+            cfg.listFunctions.append(function);
+        }
+    }
+
+    qint32 nNumberOfFunctions=cfg.listFunctions.count();
+
+    // Function bodies: the blocks reachable from the entry without entering another function
+    QVector<qint32> listVisited(nNumberOfBlocks,-1);
+
+    cfg.listFunctionBlockOffsets.reserve(nNumberOfFunctions+1);
+    cfg.listCalleeOffsets.reserve(nNumberOfFunctions+1);
+
+    for(qint32 i=0;(i<nNumberOfFunctions)&&(!bStop);i++)
+    {
+        FUNCTION *pFunction=&(cfg.listFunctions[i]);
+
+        qint32 nStart=cfg.listFunctionBlocks.count();
+
+        cfg.listFunctionBlockOffsets.append(nStart);
+        cfg.listFunctionBlocks.append(pFunction->nBlock);
+        listVisited[pFunction->nBlock]=i;
+
+        // The block list is the queue
+        for(qint32 j=nStart;j<cfg.listFunctionBlocks.count();j++)
+        {
+            qint32 nBlock=cfg.listFunctionBlocks.at(j);
+            qint32 nEnd=cfg.listSuccessorOffsets.at(nBlock+1);
+
+            for(qint32 k=cfg.listSuccessorOffsets.at(nBlock);k<nEnd;k++)
+            {
+                qint32 nSuccessor=cfg.listSuccessors.at(k);
+
+                if((listVisited.at(nSuccessor)!=i)&&(listEntryFunctions.at(nSuccessor)==-1))
+                {
+                    listVisited[nSuccessor]=i;
+                    cfg.listFunctionBlocks.append(nSuccessor);
+                }
+            }
+        }
+
+        std::sort(cfg.listFunctionBlocks.begin()+nStart,cfg.listFunctionBlocks.end());
+
+        qint32 nCalleeStart=cfg.listCallees.count();
+
+        cfg.listCalleeOffsets.append(nCalleeStart);
+
+        qint32 nEnd=cfg.listFunctionBlocks.count();
+
+        for(qint32 j=nStart;j<nEnd;j++)
+        {
+            qint32 nBlock=cfg.listFunctionBlocks.at(j);
+            BASIC_BLOCK *pBlock=&(cfg.listBlocks[nBlock]);
+
+            pFunction->nSize+=pBlock->nSize;
+            pFunction->nInstructions+=pBlock->nInstructions;
+
+            if(pBlock->nFunction==-1)
+            {
+                pBlock->nFunction=i;
+            }
+
+            qint32 nCallEnd=listCallSiteOffsets.at(nBlock+1);
+
+            for(qint32 k=listCallSiteOffsets.at(nBlock);k<nCallEnd;k++)
+            {
+                qint32 nBlockCallee=_findBlockStart(&cfg,listCallSites.at(k));
+
+                if((nBlockCallee!=-1)&&(listEntryFunctions.at(nBlockCallee)!=-1))
+                {
+                    cfg.listCallees.append(listEntryFunctions.at(nBlockCallee));
+                }
+            }
+        }
+
+        std::sort(cfg.listCallees.begin()+nCalleeStart,cfg.listCallees.end());
+        cfg.listCallees.erase(std::unique(cfg.listCallees.begin()+nCalleeStart,cfg.listCallees.end()),cfg.listCallees.end());
+
+        pFunction->nBlockCount=nEnd-nStart;
+        pFunction->nCalleeCount=cfg.listCallees.count()-nCalleeStart;
+    }
+
+    qint32 nNumberOfDone=cfg.listFunctionBlockOffsets.count();
+
+    if(nNumberOfDone<nNumberOfFunctions)
+    {
+        // Stopped: the functions that are not done are removed with the calls to them
+        QVector<qint32> listCalleeOffsets;
+        QVector<qint32> listCallees;
+
+        cfg.listFunctions.resize(nNumberOfDone);
+
+        for(qint32 i=0;i<nNumberOfDone;i++)
+        {
+            qint32 nCalleeStart=listCallees.count();
+            qint32 nCalleeEnd=(i+1<nNumberOfDone)?(cfg.listCalleeOffsets.at(i+1)):(cfg.listCallees.count());
+
+            listCalleeOffsets.append(nCalleeStart);
+
+            for(qint32 j=cfg.listCalleeOffsets.at(i);j<nCalleeEnd;j++)
+            {
+                if(cfg.listCallees.at(j)<nNumberOfDone)
+                {
+                    listCallees.append(cfg.listCallees.at(j));
+                }
+            }
+
+            cfg.listFunctions[i].nCalleeCount=listCallees.count()-nCalleeStart;
+        }
+
+        cfg.listCalleeOffsets=listCalleeOffsets;
+        cfg.listCallees=listCallees;
+    }
+
+    cfg.listFunctionBlockOffsets.append(cfg.listFunctionBlocks.count());
+    cfg.listCalleeOffsets.append(cfg.listCallees.count());
+
+    // The blocks and the functions found so far, a stop leaves the result not initialised
+    pOptions->stats.cfg=cfg;
+}
+
+void XDisasm::_updateEntropy()
+{
+    XDISASM_TRACE("XDisasm::_updateEntropy");
+
+    ENTROPY *pEntropy=&(pOptions->stats.entropy);
+
+    pEntropy->nWindowSize=N_ENTROPY_WINDOW;
+    pEntropy->listRegions.clear();
+    pEntropy->listWindows.clear();
+    pEntropy->nRejectedTargets=0;
+
+    // H=log2(N)-sum(c*log2(c))/N, c*log2(c) is taken from the table
+    QVector<double> listLogTable(N_ENTROPY_WINDOW+1);
+    listLogTable[0]=0;
+
+    for(int i=1;i<=N_ENTROPY_WINDOW;i++)
+    {
+        listLogTable[i]=i*std::log2((double)i);
+    }
+
+    qint64 nDeviceSize=pDevice->size();
+
+    int nNumberOfRecords=pOptions->stats.memoryMap.listRecords.count();
+
+    for(int i=0;i<nNumberOfRecords;i++)
+    {
+        const XBinary::_MEMORY_RECORD *pRecord=&(pOptions->stats.memoryMap.listRecords.at(i));
+
+        if((pRecord->nAddress!=-1)&&(pRecord->nOffset!=-1)&&(pRecord->nOffset<nDeviceSize)&&(pRecord->nSize>0))
+        {
+            ENTROPY_REGION region={};
+            region.nAddress=pRecord->nAddress;
+            region.nOffset=pRecord->nOffset;
+            region.nSize=qMin(pRecord->nSize,nDeviceSize-pRecord->nOffset);
+
+            pEntropy->listRegions.append(region);
+        }
+    }
+
+    std::sort(pEntropy->listRegions.begin(),pEntropy->listRegions.end(),_entropyRegionLessThan);
+
+    const qint64 N_BUFFER_SIZE=0x100*N_ENTROPY_WINDOW;
+
+    QByteArray baBuffer;
+    baBuffer.resize(N_BUFFER_SIZE);
+
+    int nNumberOfRegions=pEntropy->listRegions.count();
+
+    for(int i=0;(i<nNumberOfRegions)&&(!bStop);i++)
+    {
+        ENTROPY_REGION *pRegion=&(pEntropy->listRegions[i]);
+
+        pRegion->nWindow=pEntropy->listWindows.count();
+
+        for(qint64 j=0;(j<pRegion->nSize)&&(!bStop);j+=N_BUFFER_SIZE)
+        {
+            _testLimits();
+
+            qint64 nDataSize=XBinary::read_array(pDevice,pRegion->nOffset+j,baBuffer.data(),qMin(N_BUFFER_SIZE,pRegion->nSize-j));
+
+            if(nDataSize<=0)
+            {
+                break;
+            }
+
+            if(pPhaseStat)
+            {
+                pPhaseStat->nBytesRead+=nDataSize;
+            }
+
+            for(qint64 k=0;k<nDataSize;k+=N_ENTROPY_WINDOW)
+            {
+                qint32 nWindowSize=(qint32)qMin((qint64)N_ENTROPY_WINDOW,nDataSize-k);
+
+                pEntropy->listWindows.append(_getWindow(baBuffer.constData()+k,nWindowSize,listLogTable.constData(),pRegion->histogram));
+            }
+        }
+    }
+}
+
+void XDisasm::_updateStrings()
+{
+    XDISASM_TRACE("XDisasm::_updateStrings");
+
+    qint32 nMinLength=pOptions->nStringMinLength;
+
+    if(nMinLength<=0)
+    {
+        nMinLength=N_STRING_MIN_LENGTH;
+    }
+
+    XDisasmStringScanner scanner;
+
+    qint32 nThreads=pOptions->nThreads;
+
+    // The scanner stops on bStop, the limits are tested while it runs
+    QFuture<QVector<STRING>> future=QtConcurrent::run([&](){return scanner.scan(pDevice,&(pOptions->stats.memoryMap),nMinLength,nThreads,&bStop);});
+
+    while(!future.isFinished())
+    {
+        QThread::msleep(N_LIMIT_POLL);
+
+        _testLimits();
+    }
+
+    pOptions->stats.listStrings=future.result();
+    pOptions->stats.listStrings.squeeze();
+}
+
+void XDisasm::_updateSymbols(XBinary::FT ft)
+{
+    XDISASM_TRACE("XDisasm::_updateSymbols");
+
+    QVector<SYMBOL> listSymbols;
+
+    if((ft==XBinary::FT_PE32)||(ft==XBinary::FT_PE64))
+    {
+        XPE pe(pDevice,pOptions->bIsImage,pOptions->nImageBase);
+
+        _addPESymbols(&listSymbols,&pe);
+    }
+    else if((ft==XBinary::FT_ELF32)||(ft==XBinary::FT_ELF64))
+    {
+        XELF elf(pDevice,pOptions->bIsImage,pOptions->nImageBase);
+
+        _addELFSymbols(&listSymbols,&elf);
+    }
+    else if((ft==XBinary::FT_MACH32)||(ft==XBinary::FT_MACH64))
+    {
+        XMACH mach(pDevice,pOptions->bIsImage,pOptions->nImageBase);
+
+        _addMACHSymbols(&listSymbols,&mach);
+    }
+
+    // One symbol per address, the lowest source wins: export, TLS, exception, symbol table
+    std::sort(listSymbols.begin(),listSymbols.end(),_symbolLessThan);
+
+    int nNumberOfSymbols=listSymbols.count();
+    int nCount=0;
+
+    for(int i=0;i<nNumberOfSymbols;i++)
+    {
+        if((nCount==0)||(listSymbols.at(nCount-1).nAddress!=listSymbols.at(i).nAddress))
+        {
+            listSymbols[nCount]=listSymbols.at(i);
+            nCount++;
+        }
+    }
+
+    listSymbols.resize(nCount);
+    listSymbols.squeeze();
+
+    pOptions->stats.listSymbols=listSymbols;
+}
+
+void XDisasm::_addSymbol(QVector<XDisasm::SYMBOL> *pListSymbols, qint64 nAddress, QString sName, XDisasm::SS ss)
+{
+    bool bValid=XBinary::isAddressPhysical(&(pOptions->stats.memoryMap),nAddress);
+
+    if(bValid&&(!pOptions->bNoEntropyFilter))
+    {
+        // Exported variables and stale table entries: no code in padding or compressed data
+        const WINDOW *pWindow=getWindow(&(pOptions->stats),nAddress);
+
+        if(pWindow&&((pWindow->wc==WC_ZERO)||(pWindow->wc==WC_PACKED)))
+        {
+            bValid=false;
+        }
+    }
+
+    if(bValid)
+    {
+        SYMBOL symbol={};
+        symbol.nAddress=nAddress;
+        symbol.nName=(sName!="")?addName(&(pOptions->stats),sName):-1;
+        symbol.ss=ss;
+
+        pListSymbols->append(symbol);
+    }
+}
+
+void XDisasm::_addPESymbols(QVector<XDisasm::SYMBOL> *pListSymbols, XPE *pPE)
+{
+    qint64 nImageBase=pOptions->stats.memoryMap.nBaseAddress;
+
+    XPE::EXPORT_HEADER exportHeader=pPE->getExport();
+    XPE_DEF::IMAGE_DATA_DIRECTORY ddExport=pPE->getDataDirectory(XPE_DEF::S_IMAGE_DIRECTORY_ENTRY_EXPORT);
+
+    qint64 nExportBegin=nImageBase+ddExport.VirtualAddress;
+    qint64 nExportEnd=nExportBegin+ddExport.Size;
+
+    int nNumberOfExports=exportHeader.listPositions.count();
+
+    for(int i=0;i<nNumberOfExports;i++)
+    {
+        qint64 nAddress=exportHeader.listPositions.at(i).nAddress;
+
+        // A forwarder points to a string inside the export directory
+        if((nAddress<nExportBegin)||(nAddress>=nExportEnd))
+        {
+            QString sName=exportHeader.listPositions.at(i).sFunctionName;
+
+            if(sName=="")
+            {
+                sName=QString("ord_%1").arg(exportHeader.listPositions.at(i).nOrdinal);
+            }
+
+            _addSymbol(pListSymbols,nAddress,sName,SS_EXPORT);
+        }
+    }
+
+    QList<qint64> listCallbacks=pPE->getTLS_CallbacksList(&(pOptions->stats.memoryMap));
+
+    int nNumberOfCallbacks=listCallbacks.count();
+
+    for(int i=0;i<nNumberOfCallbacks;i++)
+    {
+        _addSymbol(pListSymbols,listCallbacks.at(i),QString("tls_callback_%1").arg(i),SS_TLS);
+    }
+
+    // x64 only: RUNTIME_FUNCTION {BeginAddress, EndAddress, UnwindInfoAddress}, RVAs
+    if(pPE->getMode()==XBinary::MODE_64)
+    {
+        XPE_DEF::IMAGE_DATA_DIRECTORY ddException=pPE->getDataDirectory(XPE_DEF::S_IMAGE_DIRECTORY_ENTRY_EXCEPTION);
+
+        qint64 nOffset=XBinary::addressToOffset(&(pOptions->stats.memoryMap),nImageBase+ddException.VirtualAddress);
+
+        if(ddException.VirtualAddress&&(nOffset!=-1))
+        {
+            QByteArray baData=_readData(nOffset,ddException.Size);
+
+            const uchar *pData=(const uchar *)baData.constData();
+            int nNumberOfEntries=baData.size()/12;
+
+            for(int i=0;i<nNumberOfEntries;i++)
+            {
+                quint32 nBeginAddress=qFromLittleEndian<quint32>(pData+i*12);
+
+                if(nBeginAddress)
+                {
+                    _addSymbol(pListSymbols,nImageBase+nBeginAddress,QString(),SS_EXCEPTION);
+                }
+            }
+        }
+    }
+}
+
+void XDisasm::_addELFSymbols(QVector<XDisasm::SYMBOL> *pListSymbols, XELF *pELF)
+{
+    // The section headers are not mapped in a memory image
+    if(!pOptions->bIsImage)
+    {
+        // x86: little endian
+        bool bIs64=(pOptions->stats.memoryMap.mode==XBinary::MODE_64);
+        int nEntrySize=bIs64?24:16;
+
+        QList<XELF_DEF::Elf_Shdr> listSections=pELF->getElf_ShdrList();
+
+        int nNumberOfSections=listSections.count();
+
+        for(int i=0;(i<nNumberOfSections)&&(!bStop);i++)
+        {
+            _testLimits();
+
+            const XELF_DEF::Elf_Shdr &section=listSections.at(i);
+
+            // SHT_SYMTAB, SHT_DYNSYM; sh_link is the string table
+            if(((section.sh_type==2)||(section.sh_type==11))&&(section.sh_link<(quint32)nNumberOfSections))
+            {
+                QByteArray baSymbols=_readData(section.sh_offset,section.sh_size);
+                QByteArray baStrings=_readData(listSections.at(section.sh_link).sh_offset,listSections.at(section.sh_link).sh_size);
+
+                const uchar *pData=(const uchar *)baSymbols.constData();
+                int nNumberOfEntries=baSymbols.size()/nEntrySize;
+
+                for(int j=0;j<nNumberOfEntries;j++)
+                {
+                    const uchar *pEntry=pData+j*nEntrySize;
+
+                    quint32 nName=qFromLittleEndian<quint32>(pEntry);
+                    quint8 nInfo=0;
+                    quint16 nSectionIndex=0;
+                    qint64 nValue=0;
+
+                    if(bIs64)
+                    {
+                        nInfo=pEntry[4];
+                        nSectionIndex=qFromLittleEndian<quint16>(pEntry+6);
+                        nValue=(qint64)qFromLittleEndian<quint64>(pEntry+8);
+                    }
+                    else
+                    {
+                        nValue=qFromLittleEndian<quint32>(pEntry+4);
+                        nInfo=pEntry[12];
+                        nSectionIndex=qFromLittleEndian<quint16>(pEntry+14);
+                    }
+
+                    // STT_FUNC, defined in a section
+                    if(((nInfo&0xF)==2)&&(nSectionIndex!=0)&&nValue)
+                    {
+                        QString sName;
+
+                        if(nName<(quint32)baStrings.size())
+                        {
+                            sName=QString::fromUtf8(baStrings.constData()+nName); // QByteArray is 0-terminated
+                        }
+
+                        _addSymbol(pListSymbols,nValue,sName,SS_SYMBOL);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void XDisasm::_addMACHSymbols(QVector<XDisasm::SYMBOL> *pListSymbols, XMACH *pMACH)
+{
+    // The symbol table is not mapped in a memory image
+    if(!pOptions->bIsImage)
+    {
+        // x86: little endian
+        bool bIs64=(pOptions->stats.memoryMap.mode==XBinary::MODE_64);
+        int nEntrySize=bIs64?16:12;
+
+        QList<XMACH::COMMAND_RECORD> listCommands=pMACH->getCommandRecords();
+
+        int nNumberOfCommands=listCommands.count();
+
+        // n_sect is the ordinal of the section in the order of the segment commands, from 1
+        QSet<quint32> stCodeSections;
+        quint32 nSectionOrdinal=0;
+
+        for(int i=0;(i<nNumberOfCommands)&&(!bStop);i++)
+        {
+            // LC_SEGMENT, LC_SEGMENT_64: the header, nsects, then the sections with their flags
+            if((listCommands.at(i).nType==0x1)||(listCommands.at(i).nType==0x19))
+            {
+                bool bIsSegment64=(listCommands.at(i).nType==0x19);
+                int nHeaderSize=bIsSegment64?72:56;
+                int nSectionSize=bIsSegment64?80:68;
+                int nFlagsOffset=bIsSegment64?64:56;
+
+                QByteArray baHeader=_readData(listCommands.at(i).nOffset,nHeaderSize);
+
+                if(baHeader.size()==nHeaderSize)
+                {
+                    quint32 nNumberOfSections=qFromLittleEndian<quint32>((const uchar *)baHeader.constData()+nHeaderSize-8);
+
+                    QByteArray baSections=_readData(listCommands.at(i).nOffset+nHeaderSize,(qint64)nNumberOfSections*nSectionSize);
+
+                    const uchar *pSections=(const uchar *)baSections.constData();
+                    int nNumberOfEntries=baSections.size()/nSectionSize;
+
+                    for(int j=0;j<nNumberOfEntries;j++)
+                    {
+                        quint32 nFlags=qFromLittleEndian<quint32>(pSections+j*nSectionSize+nFlagsOffset);
+
+                        nSectionOrdinal++;
+
+                        // S_ATTR_PURE_INSTRUCTIONS, S_ATTR_SOME_INSTRUCTIONS
+                        if(nFlags&(0x80000000|0x00000400))
+                        {
+                            stCodeSections.insert(nSectionOrdinal);
+                        }
+                    }
+                }
+            }
+        }
+
+        for(int i=0;(i<nNumberOfCommands)&&(!bStop);i++)
+        {
+            _checkLimits();
+
+            // LC_SYMTAB: cmd, cmdsize, symoff, nsyms, stroff, strsize
+            if(listCommands.at(i).nType==0x2)
+            {
+                QByteArray baCommand=_readData(listCommands.at(i).nOffset,24);
+
+                if(baCommand.size()==24)
+                {
+                    const uchar *pCommand=(const uchar *)baCommand.constData();
+
+                    quint32 nSymbolOffset=qFromLittleEndian<quint32>(pCommand+8);
+                    quint32 nNumberOfSymbols=qFromLittleEndian<quint32>(pCommand+12);
+                    quint32 nStringOffset=qFromLittleEndian<quint32>(pCommand+16);
+                    quint32 nStringSize=qFromLittleEndian<quint32>(pCommand+20);
+
+                    QByteArray baSymbols=_readData(nSymbolOffset,(qint64)nNumberOfSymbols*nEntrySize);
+                    QByteArray baStrings=_readData(nStringOffset,nStringSize);
+
+                    const uchar *pData=(const uchar *)baSymbols.constData();
+                    int nNumberOfEntries=baSymbols.size()/nEntrySize;
+
+                    for(int j=0;j<nNumberOfEntries;j++)
+                    {
+                        const uchar *pEntry=pData+j*nEntrySize;
+
+                        // nlist: n_strx, n_type, n_sect, n_desc, n_value
+                        quint32 nName=qFromLittleEndian<quint32>(pEntry);
+                        quint8 nType=pEntry[4];
+                        quint8 nSection=pEntry[5];
+                        qint64 nValue=bIs64?(qint64)qFromLittleEndian<quint64>(pEntry+8):qFromLittleEndian<quint32>(pEntry+8);
+
+                        // Not a debug entry (N_STAB), defined in a section (N_SECT) that has instructions
+                        if(((nType&0xE0)==0)&&((nType&0x0E)==0x0E)&&stCodeSections.contains(nSection)&&nValue)
+                        {
+                            QString sName;
+
+                            if(nName<(quint32)baStrings.size())
+                            {
+                                sName=QString::fromUtf8(baStrings.constData()+nName);
+
+                                if(sName.startsWith("_"))
+                                {
+                                    sName.remove(0,1);
+                                }
+                            }
+
+                            _addSymbol(pListSymbols,nValue,sName,SS_SYMBOL);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+QByteArray XDisasm::_readData(qint64 nOffset, qint64 nSize)
+{
+    QByteArray baResult;
+
+    qint64 nDeviceSize=pDevice->size();
+
+    if((nOffset>=0)&&(nOffset<nDeviceSize)&&(nSize>0))
+    {
+        nSize=qMin(nSize,nDeviceSize-nOffset);
+
+        if(nSize<=N_MAX_SYMBOL_TABLE)
+        {
+            baResult.resize((int)nSize);
+
+            qint64 nReadSize=XBinary::read_array(pDevice,nOffset,baResult.data(),nSize);
+
+            baResult.resize((int)qMax(nReadSize,(qint64)0));
+        }
+    }
+
+    return baResult;
+}
+
+void XDisasm::_updatePrologues()
+{
+    XDISASM_TRACE("XDisasm::_updatePrologues");
+
+    PROLOGUES *pPrologues=&(pOptions->stats.prologues);
+    *pPrologues={};
+
+    _removeStringRecords();
+
+    QVector<RANGE> listRanges;
+    pPrologues->nUncoveredSize=_getUncoveredRanges(&listRanges);
+
+    listPrologueChunks.clear();
+
+    int nNumberOfRanges=listRanges.count();
+
+    for(int i=0;i<nNumberOfRanges;i++)
+    {
+        const RANGE &range=listRanges.at(i);
+
+        for(qint64 j=0;j<range.nSize;j+=N_PROLOGUE_CHUNK)
+        {
+            PROLOGUE_CHUNK chunk={};
+            chunk.nAddress=range.nAddress+j;
+            chunk.nOffset=range.nOffset+j;
+            chunk.nSize=qMin((qint64)N_PROLOGUE_CHUNK,range.nSize-j);
+            chunk.nRangeEnd=range.nAddress+range.nSize;
+
+            listPrologueChunks.append(chunk);
+        }
+    }
+
+    listPrologues.clear();
+    nPrologueCandidates=0;
+    nCurrentChunk=0;
+
+    QFile *pFile=dynamic_cast<QFile *>(pDevice);
+
+    sFileName=pFile?pFile->fileName():QString();
+
+    int nThreads=pOptions->nThreads;
+
+    if(nThreads<=0)
+    {
+        nThreads=QThread::idealThreadCount();
+    }
+
+    nThreads=qMin(nThreads,qMax(listPrologueChunks.count(),1));
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(nThreads);
+
+    for(int i=0;i<nThreads;i++)
+    {
+        QtConcurrent::run(&threadPool,this,&XDisasm::_prologuesWorker);
+    }
+
+    while(!threadPool.waitForDone(N_LIMIT_POLL))
+    {
+        _testLimits();
+    }
+
+    std::sort(listPrologues.begin(),listPrologues.end());
+
+    pPrologues->nCandidates=nPrologueCandidates;
+    pPrologues->nConfirmed=listPrologues.count();
+
+    // Kept as roots: the next runs and the CFG see them as function entries
+    pOptions->stats.listRoots+=listPrologues;
+
+    listRootWork=listPrologues;
+
+    listPrologues.clear();
+    listPrologues.squeeze();
+    listPrologueChunks.clear();
+    listPrologueChunks.squeeze();
+
+    _disasmRootWork();
+
+    pPrologues->nRemainingSize=_getUncoveredRanges(0);
+
+    _addStringRecords();
+
+    _updateXrefs();
+}
+
+void XDisasm::_prologuesWorker()
+{
+    QIODevice *pWorkerDevice=0;
+    QMutex *pMutexDevice=0;
+
+    QFile file;
+
+    if(sFileName!="")
+    {
+        file.setFileName(sFileName);
+
+        if(file.open(QIODevice::ReadOnly))
+        {
+            pWorkerDevice=&file;
+        }
+    }
+
+    if(!pWorkerDevice)
+    {
+        pWorkerDevice=pDevice;
+        pMutexDevice=&mutexDevice;
+    }
+
+    cs_mode csmode=pOptions->stats.csmode;
+    csh handle=0;
+
+    if(cs_open(pOptions->stats.csarch,csmode,&handle)==CS_ERR_OK)
+    {
+        QVector<qint64> listResults;
+        qint64 nCandidates=0;
+
+        QByteArray baBuffer;
+
+        int nNumberOfChunks=listPrologueChunks.count();
+
+        while(!bStop)
+        {
+            int nIndex=nCurrentChunk.fetchAndAddOrdered(1);
+
+            if(nIndex>=nNumberOfChunks)
+            {
+                break;
+            }
+
+            const PROLOGUE_CHUNK &chunk=listPrologueChunks.at(nIndex);
+
+            // One byte before the chunk for the boundary check, the tail for the decoding
+            qint64 nLead=(chunk.nOffset>0)?1:0;
+            qint64 nTail=qMin((qint64)(N_X64_OPCODE_SIZE*N_PROLOGUE_INSTRUCTIONS),chunk.nRangeEnd-chunk.nAddress-chunk.nSize);
+            qint64 nReadSize=nLead+chunk.nSize+nTail;
+
+            baBuffer.resize((int)nReadSize);
+
+            {
+                QMutexLocker locker(pMutexDevice);
+
+                nReadSize=XBinary::read_array(pWorkerDevice,chunk.nOffset-nLead,baBuffer.data(),nReadSize);
+            }
+
+            const quint8 *pData=(const quint8 *)baBuffer.constData();
+            qint64 nEnd=qMin(nLead+chunk.nSize,nReadSize);
+
+            for(qint64 i=nLead;i<nEnd;i++)
+            {
+                qint64 nAddress=chunk.nAddress+i-nLead;
+
+                // A function boundary: after int3/nop padding, a multibyte nop (ends with 00) or a ret
+                bool bBoundary=false;
+
+                if(i>0)
+                {
+                    quint8 nPrev=pData[i-1];
+
+                    bBoundary=(nPrev==0xCC)||(nPrev==0x90)||(nPrev==0x00)||(nPrev==0xC3);
+                }
+                else
+                {
+                    bBoundary=((nAddress&0xF)==0);
+                }
+
+                if(bBoundary&&_isPrologue(pData+i,nReadSize-i,csmode))
+                {
+                    nCandidates++;
+
+                    if(_checkPrologue(handle,pData+i,nReadSize-i,nAddress))
+                    {
+                        listResults.append(nAddress);
+                    }
+                }
+            }
+        }
+
+        cs_close(&handle);
+
+        QMutexLocker locker(&mutexTraversal);
+
+        listPrologues+=listResults;
+        nPrologueCandidates+=nCandidates;
+    }
+}
+
+bool XDisasm::_isPrologue(const quint8 *pData, qint64 nDataSize, cs_mode csmode)
+{
+    bool bResult=false;
+
+    struct PATTERN
+    {
+        qint32 nSize;
+        quint8 pattern[8];
+    };
+
+    static const PATTERN PATTERNS_16[]=
+    {
+        {3,{0x55,0x8B,0xEC}}, // push bp; mov bp,sp
+        {3,{0x55,0x89,0xE5}} // the same, the other encoding
+    };
+
+    static const PATTERN PATTERNS_32[]=
+    {
+        {5,{0x8B,0xFF,0x55,0x8B,0xEC}}, // mov edi,edi; push ebp; mov ebp,esp (hot patch)
+        {3,{0x55,0x8B,0xEC}}, // push ebp; mov ebp,esp
+        {3,{0x55,0x89,0xE5}} // the same, gcc
+    };
+
+    static const PATTERN PATTERNS_64[]=
+    {
+        {4,{0xF3,0x0F,0x1E,0xFA}}, // endbr64
+        {4,{0x55,0x48,0x89,0xE5}}, // push rbp; mov rbp,rsp
+        {4,{0x48,0x89,0x5C,0x24}}, // mov [rsp+x],rbx
+        {4,{0x48,0x89,0x4C,0x24}}, // mov [rsp+x],rcx
+        {4,{0x48,0x89,0x54,0x24}}, // mov [rsp+x],rdx
+        {4,{0x4C,0x89,0x44,0x24}}, // mov [rsp+x],r8
+        {3,{0x48,0x83,0xEC}}, // sub rsp,imm8
+        {3,{0x48,0x81,0xEC}}, // sub rsp,imm32
+        {5,{0x40,0x53,0x48,0x83,0xEC}}, // push rbx; sub rsp,imm8
+        {4,{0x41,0x57,0x41,0x56}} // push r15; push r14
+    };
+
+    const PATTERN *pPatterns=PATTERNS_32;
+    int nNumberOfPatterns=sizeof(PATTERNS_32)/sizeof(PATTERN);
+
+    if(csmode==CS_MODE_16)
+    {
+        pPatterns=PATTERNS_16;
+        nNumberOfPatterns=sizeof(PATTERNS_16)/sizeof(PATTERN);
+    }
+    else if(csmode==CS_MODE_64)
+    {
+        pPatterns=PATTERNS_64;
+        nNumberOfPatterns=sizeof(PATTERNS_64)/sizeof(PATTERN);
+    }
+
+    for(int i=0;(i<nNumberOfPatterns)&&(!bResult);i++)
+    {
+        bResult=(nDataSize>=pPatterns[i].nSize)&&(memcmp(pData,pPatterns[i].pattern,pPatterns[i].nSize)==0);
+    }
+
+    return bResult;
+}
+
+bool XDisasm::_checkPrologue(csh handle, const quint8 *pData, qint64 nDataSize, qint64 nAddress)
+{
+    bool bResult=false;
+
+    cs_insn *insn=cs_malloc(handle);
+
+    if(insn)
+    {
+        const uint8_t *pCode=pData;
+        size_t nCodeSize=(size_t)nDataSize;
+        uint64_t nCodeAddress=(uint64_t)nAddress;
+
+        int nCount=0;
+        bool bValid=true;
+        bool bRet=false;
+
+        while(bValid&&(!bRet)&&(nCount<N_PROLOGUE_INSTRUCTIONS))
+        {
+            if(cs_disasm_iter(handle,&pCode,&nCodeSize,&nCodeAddress,insn))
+            {
+                // Padding or a trap does not belong to the first instructions of a function
+                if((insn->id==X86_INS_INT3)||(insn->id==X86_INS_HLT)||(insn->id==X86_INS_INVALID))
+                {
+                    bValid=false;
+                }
+                else
+                {
+                    nCount++;
+
+                    bRet=(insn->id==X86_INS_RET);
+                }
+            }
+            else
+            {
+                // The end of the range is not an error, undecodable bytes are
+                bValid=(nCount>=N_PROLOGUE_MIN_INSTRUCTIONS);
+                break;
+            }
+        }
+
+        if(bValid)
+        {
+            bResult=(nCount>=N_PROLOGUE_MIN_INSTRUCTIONS)||(bRet&&(nCount>=2));
+        }
+
+        cs_free(insn,1);
+    }
+
+    return bResult;
+}
+
+qint64 XDisasm::_getUncoveredRanges(QVector<XDisasm::RANGE> *pListRanges)
+{
+    qint64 nResult=0;
+
+    const ENTROPY *pEntropy=&(pOptions->stats.entropy);
+    const QMap<qint64,RECORD> &mapRecords=pOptions->stats.mapRecords;
+
+    int nNumberOfRegions=pEntropy->listRegions.count();
+
+    for(int i=0;(i<nNumberOfRegions)&&(!bStop);i++)
+    {
+        const ENTROPY_REGION &region=pEntropy->listRegions.at(i);
+
+        qint32 nWindowEnd=(i<(nNumberOfRegions-1))?pEntropy->listRegions.at(i+1).nWindow:pEntropy->listWindows.count();
+        qint32 nWindow=region.nWindow;
+
+        while(nWindow<nWindowEnd)
+        {
+            if(pEntropy->listWindows.at(nWindow).wc==WC_CODE)
+            {
+                // A run of code windows
+                qint32 nRunEnd=nWindow;
+
+                while((nRunEnd<nWindowEnd)&&(pEntropy->listWindows.at(nRunEnd).wc==WC_CODE))
+                {
+                    nRunEnd++;
+                }
+
+                qint64 nBegin=region.nAddress+(qint64)(nWindow-region.nWindow)*pEntropy->nWindowSize;
+                qint64 nEnd=qMin(region.nAddress+(qint64)(nRunEnd-region.nWindow)*pEntropy->nWindowSize,region.nAddress+region.nSize);
+
+                // The gaps between the records
+                qint64 nCurrent=nBegin;
+
+                QMap<qint64,RECORD>::const_iterator iter=mapRecords.lowerBound(nBegin);
+
+                if(iter!=mapRecords.constBegin())
+                {
+                    QMap<qint64,RECORD>::const_iterator iterPrev=iter;
+                    --iterPrev;
+
+                    nCurrent=qMax(nCurrent,iterPrev.key()+iterPrev.value().nSize);
+                }
+
+                while(nCurrent<nEnd)
+                {
+                    bool bRecord=(iter!=mapRecords.constEnd())&&(iter.key()<nEnd);
+
+                    qint64 nGapEnd=bRecord?iter.key():nEnd;
+
+                    if(nGapEnd>nCurrent)
+                    {
+                        nResult+=_addUncoveredRange(pListRanges,&region,nCurrent,nGapEnd);
+                    }
+
+                    if(bRecord)
+                    {
+                        nCurrent=qMax(nCurrent,iter.key()+iter.value().nSize);
+                        ++iter;
+                    }
+                    else
+                    {
+                        nCurrent=nEnd;
+                    }
+                }
+
+                nWindow=nRunEnd;
+            }
+            else
+            {
+                nWindow++;
+            }
+        }
+    }
+
+    return nResult;
+}
+
+qint64 XDisasm::_addUncoveredRange(QVector<XDisasm::RANGE> *pListRanges, const XDisasm::ENTROPY_REGION *pRegion, qint64 nBegin, qint64 nEnd)
+{
+    qint64 nResult=0;
+
+    // The ranges that the user has converted to data have no records, they are not uncovered
+    const QMap<qint64,qint64> &mapDataRanges=pOptions->stats.mapDataRanges;
+
+    QMap<qint64,qint64>::const_iterator iter=mapDataRanges.upperBound(nBegin);
+
+    if(iter!=mapDataRanges.constBegin())
+    {
+        QMap<qint64,qint64>::const_iterator iterPrev=iter;
+        --iterPrev;
+
+        nBegin=qMax(nBegin,iterPrev.key()+iterPrev.value());
+    }
+
+    while(nBegin<nEnd)
+    {
+        bool bData=(iter!=mapDataRanges.constEnd())&&(iter.key()<nEnd);
+
+        qint64 nRangeEnd=bData?iter.key():nEnd;
+
+        if(nRangeEnd>nBegin)
+        {
+            RANGE range={};
+            range.nAddress=nBegin;
+            range.nOffset=pRegion->nOffset+(nBegin-pRegion->nAddress);
+            range.nSize=nRangeEnd-nBegin;
+
+            if(pListRanges)
+            {
+                pListRanges->append(range);
+            }
+
+            nResult+=range.nSize;
+        }
+
+        if(bData)
+        {
+            nBegin=qMax(nBegin,iter.key()+iter.value());
+            ++iter;
+        }
+        else
+        {
+            nBegin=nEnd;
+        }
+    }
+
+    return nResult;
+}
+
+QVector<qint64> XDisasm::_getCodeRoots()
+{
+    QVector<qint64> listResult;
+
+    int nNumberOfRoots=pOptions->stats.listRoots.count();
+
+    listResult.reserve(nNumberOfRoots);
+
+    for(int i=0;i<nNumberOfRoots;i++)
+    {
+        qint64 nAddress=pOptions->stats.listRoots.at(i);
+
+        if(!_isDataRange(nAddress))
+        {
+            listResult.append(nAddress);
+        }
+    }
+
+    return listResult;
+}
+
+bool XDisasm::_insertOpcode(qint64 nAddress, XDisasm::RECORD *pOpcode)
+{
+    pOptions->stats.mapRecords.insert(nAddress,*pOpcode);
+
+    if((nChangedStart==-1)||(nAddress<nChangedStart))
+    {
+        nChangedStart=nAddress;
+    }
+
+    nChangedEnd=qMax(nChangedEnd,nAddress+pOpcode->nSize);
+
+    bool bResult=true;
+
+    if(pOptions->nOpcodeLimit!=-1)
+    {
+        qint64 nCount=pOptions->stats.mapRecords.count();
+        qint64 nLimit=pOptions->nOpcodeLimit?pOptions->nOpcodeLimit:N_OPCODE_COUNT;
+
+        bResult=(nCount<nLimit);
+    }
+
+    return bResult;
+}
+
+bool XDisasm::_labelLessThan(const XDisasm::LABEL &label1, const XDisasm::LABEL &label2)
+{
+    bool bResult=false;
+
+    if(label1.nAddress!=label2.nAddress)
+    {
+        bResult=(label1.nAddress<label2.nAddress);
+    }
+    else
+    {
+        bResult=(label1.type<label2.type);
+    }
+
+    return bResult;
+}
+
+bool XDisasm::_symbolLessThan(const XDisasm::SYMBOL &symbol1, const XDisasm::SYMBOL &symbol2)
+{
+    bool bResult=false;
+
+    if(symbol1.nAddress!=symbol2.nAddress)
+    {
+        bResult=(symbol1.nAddress<symbol2.nAddress);
+    }
+    else
+    {
+        bResult=(symbol1.ss<symbol2.ss);
+    }
+
+    return bResult;
+}
+
+bool XDisasm::_xrefLessThan(const XDisasm::XREF &xref1, const XDisasm::XREF &xref2)
+{
+    bool bResult=false;
+
+    if(xref1.nFrom!=xref2.nFrom)
+    {
+        bResult=(xref1.nFrom<xref2.nFrom);
+    }
+    else
+    {
+        bResult=(xref1.nTo<xref2.nTo);
+    }
+
+    return bResult;
+}
+
+bool XDisasm::_xrefEqual(const XDisasm::XREF &xref1, const XDisasm::XREF &xref2)
+{
+    return (xref1.nFrom==xref2.nFrom)&&(xref1.nTo==xref2.nTo);
+}
+
+bool XDisasm::_xrefReverseLessThan(const XDisasm::XREF &xref1, const XDisasm::XREF &xref2)
+{
+    bool bResult=false;
+
+    if(xref1.nTo!=xref2.nTo)
+    {
+        bResult=(xref1.nTo<xref2.nTo);
+    }
+    else
+    {
+        bResult=(xref1.nFrom<xref2.nFrom);
+    }
+
+    return bResult;
+}
+
+void XDisasm::_patchXrefIndex(XDisasm::XREF_INDEX *pIndex, QVector<XDisasm::XREF> *pListRemove, QVector<XDisasm::XREF> *pListInsert, bool bReverse)
+{
+    // The rows before the first edited key stay where they are, the rows after it are moved as blocks,
+    // only the edited rows are merged. The removed edges are in the index, the inserted ones are not.
+    int nNumberOfRemove=pListRemove->count();
+    int nNumberOfInsert=pListInsert->count();
+
+    if(nNumberOfRemove||nNumberOfInsert)
+    {
+        const XREF *pRemove=pListRemove->constData();
+        const XREF *pInsert=pListInsert->constData();
+
+        if(pIndex->listOffsets.isEmpty())
+        {
+            pIndex->listOffsets.append(0);
+        }
+
+        const qint64 *pKeys=pIndex->listKeys.constData();
+        const qint32 *pOffsets=pIndex->listOffsets.constData();
+        const qint64 *pValues=pIndex->listValues.constData();
+        int nNumberOfKeys=pIndex->listKeys.count();
+
+        qint64 nFirstKey=0;
+
+        if(nNumberOfRemove&&nNumberOfInsert)
+        {
+            nFirstKey=qMin(bReverse?pRemove[0].nTo:pRemove[0].nFrom,bReverse?pInsert[0].nTo:pInsert[0].nFrom);
+        }
+        else if(nNumberOfRemove)
+        {
+            nFirstKey=bReverse?pRemove[0].nTo:pRemove[0].nFrom;
+        }
+        else
+        {
+            nFirstKey=bReverse?pInsert[0].nTo:pInsert[0].nFrom;
+        }
+
+        int nFirst=(int)(std::lower_bound(pKeys,pKeys+nNumberOfKeys,nFirstKey)-pKeys);
+        qint32 nValueBase=pOffsets[nFirst];
+
+        QVector<qint64> listKeys;
+        QVector<qint32> listOffsets;
+        QVector<qint64> listValues;
+
+        listKeys.reserve(nNumberOfKeys-nFirst+nNumberOfInsert);
+        listOffsets.reserve(nNumberOfKeys-nFirst+nNumberOfInsert);
+        listValues.reserve(pIndex->listValues.count()-nValueBase+nNumberOfInsert);
+
+        int nKey=nFirst;
+        int nRemove=0;
+        int nInsert=0;
+
+        while((nKey<nNumberOfKeys)||(nRemove<nNumberOfRemove)||(nInsert<nNumberOfInsert))
+        {
+            bool bEdit=(nRemove<nNumberOfRemove)||(nInsert<nNumberOfInsert);
+            qint64 nEditKey=0;
+
+            if((nRemove<nNumberOfRemove)&&(nInsert<nNumberOfInsert))
+            {
+                nEditKey=qMin(bReverse?pRemove[nRemove].nTo:pRemove[nRemove].nFrom,bReverse?pInsert[nInsert].nTo:pInsert[nInsert].nFrom);
+            }
+            else if(nRemove<nNumberOfRemove)
+            {
+                nEditKey=bReverse?pRemove[nRemove].nTo:pRemove[nRemove].nFrom;
+            }
+            else if(nInsert<nNumberOfInsert)
+            {
+                nEditKey=bReverse?pInsert[nInsert].nTo:pInsert[nInsert].nFrom;
+            }
+
+            // The rows up to the next edited key as one block
+            int nNext=nNumberOfKeys;
+
+            if(bEdit)
+            {
+                nNext=(int)(std::lower_bound(pKeys+nKey,pKeys+nNumberOfKeys,nEditKey)-pKeys);
+            }
+
+            if(nNext>nKey)
+            {
+                qint32 nShift=(nValueBase+listValues.count())-pOffsets[nKey];
+
+                for(int i=nKey;i<nNext;i++)
+                {
+                    listKeys.append(pKeys[i]);
+                    listOffsets.append(pOffsets[i]+nShift);
+                }
+
+                int nValuesCount=listValues.count();
+                int nBlockSize=pOffsets[nNext]-pOffsets[nKey];
+
+                listValues.resize(nValuesCount+nBlockSize);
+                std::copy(pValues+pOffsets[nKey],pValues+pOffsets[nNext],listValues.data()+nValuesCount);
+
+                nKey=nNext;
+            }
+
+            if(bEdit)
+            {
+                // The edited row: the old values without the removed ones, merged with the inserted ones
+                const qint64 *pRow=pValues;
+                const qint64 *pRowEnd=pValues;
+
+                if((nKey<nNumberOfKeys)&&(pKeys[nKey]==nEditKey))
+                {
+                    pRow=pValues+pOffsets[nKey];
+                    pRowEnd=pValues+pOffsets[nKey+1];
+                    nKey++;
+                }
+
+                qint32 nRowOffset=nValueBase+listValues.count();
+
+                while((pRow<pRowEnd)||((nInsert<nNumberOfInsert)&&((bReverse?pInsert[nInsert].nTo:pInsert[nInsert].nFrom)==nEditKey)))
+                {
+                    bool bOld=(pRow<pRowEnd);
+                    bool bNew=(nInsert<nNumberOfInsert)&&((bReverse?pInsert[nInsert].nTo:pInsert[nInsert].nFrom)==nEditKey);
+                    qint64 nNewValue=bNew?(bReverse?pInsert[nInsert].nFrom:pInsert[nInsert].nTo):0;
+
+                    if(bOld&&((!bNew)||(*pRow<nNewValue)))
+                    {
+                        qint64 nValue=*pRow;
+                        pRow++;
+
+                        while((nRemove<nNumberOfRemove)&&((bReverse?pRemove[nRemove].nTo:pRemove[nRemove].nFrom)==nEditKey)&&((bReverse?pRemove[nRemove].nFrom:pRemove[nRemove].nTo)<nValue))
+                        {
+                            nRemove++;
+                        }
+
+                        if((nRemove<nNumberOfRemove)&&((bReverse?pRemove[nRemove].nTo:pRemove[nRemove].nFrom)==nEditKey)&&((bReverse?pRemove[nRemove].nFrom:pRemove[nRemove].nTo)==nValue))
+                        {
+                            nRemove++;
+                        }
+                        else
+                        {
+                            listValues.append(nValue);
+                        }
+                    }
+                    else
+                    {
+                        listValues.append(nNewValue);
+                        nInsert++;
+                    }
+                }
+
+                // The removed edges of a key that the index does not have
+                while((nRemove<nNumberOfRemove)&&((bReverse?pRemove[nRemove].nTo:pRemove[nRemove].nFrom)==nEditKey))
+                {
+                    nRemove++;
+                }
+
+                if((nValueBase+listValues.count())>nRowOffset)
+                {
+                    listKeys.append(nEditKey);
+                    listOffsets.append(nRowOffset);
+                }
+            }
+        }
+
+        pIndex->listKeys.resize(nFirst);
+        pIndex->listKeys+=listKeys;
+        pIndex->listOffsets.resize(nFirst);
+        pIndex->listOffsets+=listOffsets;
+        pIndex->listOffsets.append(nValueBase+listValues.count());
+        pIndex->listValues.resize(nValueBase);
+        pIndex->listValues+=listValues;
+    }
+}
+
+const qint64 *XDisasm::_getRefs(XDisasm::XREF_INDEX *pIndex, qint64 nAddress, qint32 *pnCount)
+{
+    const qint64 *pResult=0;
+
+    *pnCount=0;
+
+    const qint64 *pBegin=pIndex->listKeys.constData();
+    const qint64 *pEnd=pBegin+pIndex->listKeys.count();
+
+    const qint64 *pKey=std::lower_bound(pBegin,pEnd,nAddress);
+
+    if((pKey!=pEnd)&&(*pKey==nAddress))
+    {
+        qint32 nIndex=(qint32)(pKey-pBegin);
+        qint32 nOffset=pIndex->listOffsets.at(nIndex);
+
+        *pnCount=pIndex->listOffsets.at(nIndex+1)-nOffset;
+        pResult=pIndex->listValues.constData()+nOffset;
+    }
+
+    return pResult;
+}
+
+qint32 XDisasm::_findBlockStart(XDisasm::CFG *pCFG, qint64 nAddress)
+{
+    qint32 nResult=-1;
+
+    const BASIC_BLOCK *pBegin=pCFG->listBlocks.constData();
+    const BASIC_BLOCK *pEnd=pBegin+pCFG->listBlocks.count();
+
+    const BASIC_BLOCK *pBlock=std::lower_bound(pBegin,pEnd,nAddress,[](const BASIC_BLOCK &block,qint64 nValue){return block.nAddress<nValue;});
+
+    if((pBlock!=pEnd)&&(pBlock->nAddress==nAddress))
+    {
+        nResult=(qint32)(pBlock-pBegin);
+    }
+
+    return nResult;
+}
+
+bool XDisasm::_entropyRegionLessThan(const XDisasm::ENTROPY_REGION &region1, const XDisasm::ENTROPY_REGION &region2)
+{
+    return region1.nAddress<region2.nAddress;
+}
+
+XDisasm::WINDOW XDisasm::_getWindow(const char *pData, qint32 nSize, const double *pdLogTable, quint32 *pHistogram)
+{
+    WINDOW result={};
+
+    // Four tables: consecutive equal bytes do not wait for each other's increments
+    quint32 histograms[4][256]={};
+
+    const quint8 *pBytes=(const quint8 *)pData;
+
+    qint32 i=0;
+
+    for(;(i+4)<=nSize;i+=4)
+    {
+        histograms[0][pBytes[i]]++;
+        histograms[1][pBytes[i+1]]++;
+        histograms[2][pBytes[i+2]]++;
+        histograms[3][pBytes[i+3]]++;
+    }
+
+    for(;i<nSize;i++)
+    {
+        histograms[0][pBytes[i]]++;
+    }
+
+    // Frequent first bytes of x86 instructions: mov, lea, push/pop, call/jmp/jcc, ret, test/cmp, 0F and REX prefixes
+    static const bool CODE_BYTES[256]=
+    {
+        0,1,0,1,0,0,0,0,0,1,0,1,0,0,0,1, // 00
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // 10
+        0,0,0,0,0,0,0,0,0,1,0,1,0,0,0,0, // 20
+        0,1,0,1,0,0,0,0,0,1,0,1,0,0,0,0, // 30
+        0,1,0,0,0,0,0,0,1,1,0,0,1,1,0,0, // 40
+        1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, // 50
+        0,0,0,0,0,0,0,0,1,0,1,0,0,0,0,0, // 60
+        0,0,0,0,1,1,0,0,0,0,0,0,1,1,1,1, // 70
+        0,0,0,1,0,1,0,0,0,1,0,1,0,1,0,0, // 80
+        1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // 90
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // A0
+        0,0,0,0,0,0,0,0,1,0,0,0,0,0,0,0, // B0
+        0,1,0,1,0,0,0,1,0,0,0,0,1,0,0,0, // C0
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, // D0
+        0,0,0,0,0,0,0,0,1,1,0,1,0,0,0,0, // E0
+        0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1  // F0
+    };
+
+    double dSum=0;
+    qint64 nCodeBytes=0;
+
+    for(int j=0;j<256;j++)
+    {
+        quint32 nCount=histograms[0][j]+histograms[1][j]+histograms[2][j]+histograms[3][j];
+
+        pHistogram[j]+=nCount;
+
+        dSum+=pdLogTable[nCount];
+
+        if(CODE_BYTES[j])
+        {
+            nCodeBytes+=nCount;
+        }
+    }
+
+    if(nSize)
+    {
+        double dEntropy=std::log2((double)nSize)-dSum/nSize;
+
+        quint32 nZeroCount=histograms[0][0]+histograms[1][0]+histograms[2][0]+histograms[3][0];
+
+        result.nEntropy=(quint16)qBound(0.0,dEntropy*1000,8000.0);
+        result.nCodeScore=(quint8)((nCodeBytes*255)/nSize);
+        result.nZeroScore=(quint8)((nZeroCount*255)/nSize);
+
+        if(result.nZeroScore>=230)
+        {
+            result.wc=WC_ZERO;
+        }
+        else if(result.nEntropy>=N_ENTROPY_PACKED)
+        {
+            result.wc=WC_PACKED;
+        }
+        else if(result.nCodeScore>=64)
+        {
+            result.wc=WC_CODE;
+        }
+        else
+        {
+            result.wc=WC_DATA;
+        }
+    }
+
+    return result;
+}
+
+const qint32 *XDisasm::_getRow(QVector<qint32> *pListOffsets, QVector<qint32> *pListValues, qint32 nIndex, qint32 *pnCount)
+{
+    const qint32 *pResult=0;
+
+    *pnCount=0;
+
+    if((nIndex>=0)&&(nIndex+1<pListOffsets->count()))
+    {
+        qint32 nOffset=pListOffsets->at(nIndex);
+
+        *pnCount=pListOffsets->at(nIndex+1)-nOffset;
+        pResult=pListValues->constData()+nOffset;
+    }
+
+    return pResult;
+}
+
+bool XDisasm::_openHandle()
+{
+    // The handle is kept between runs and reopened only if the mode changes
+    if(disasm_handle&&((csarchHandle!=pOptions->stats.csarch)||(csmodeHandle!=pOptions->stats.csmode)))
+    {
+        cs_close(&disasm_handle);
+        disasm_handle=0;
+    }
+
+    if(disasm_handle==0)
+    {
+        cs_err err=cs_open(pOptions->stats.csarch,pOptions->stats.csmode,&disasm_handle);
+        if(!err)
+        {
+            cs_option(disasm_handle,CS_OPT_DETAIL,CS_OPT_ON); // TODO Check
+
+            csarchHandle=pOptions->stats.csarch;
+            csmodeHandle=pOptions->stats.csmode;
+        }
+        else
+        {
+            disasm_handle=0;
+        }
+    }
+
+    return (disasm_handle!=0);
+}
+
+void XDisasm::_checkLimits()
+{
+    nLimitCounter++;
+
+    if((nLimitCounter&0xFFF)==0)
+    {
+        _testLimits();
+    }
+}
+
+void XDisasm::_testLimits()
+{
+    if(pOptions->nTimeLimit&&(timer.elapsed()>pOptions->nTimeLimit))
+    {
+        pOptions->stats.bTimeLimitReached=true;
+        bStop=true;
+    }
+
+    if(pOptions->nMemoryLimit&&(getMemoryEstimate(&(pOptions->stats))>pOptions->nMemoryLimit))
+    {
+        pOptions->stats.bMemoryLimitReached=true;
+        bStop=true;
+    }
+}
+
+qint64 XDisasm::getVBSize(QMap<qint64, XDisasm::VIEW_BLOCK> *pMapVB)
+{
+    qint64 nResult=0;
+
+    QMapIterator<qint64, XDisasm::VIEW_BLOCK> i(*pMapVB);
+    while(i.hasNext())
+    {
+        i.next();
+
+        nResult+=i.value().nSize;
+    }
+
+    return nResult;
+}
+
+QString XDisasm::phaseIdToString(XDisasm::PHASE phase)
+{
+    QString sResult="Unknown";
+
+    switch(phase)
+    {
+        case PHASE_MEMORYMAP:       sResult="Memory map";           break;
+        case PHASE_ENTROPY:         sResult="Entropy";              break;
+        case PHASE_STRINGS:         sResult="Strings";              break;
+        case PHASE_SYMBOLS:         sResult="Symbols";              break;
+        case PHASE_TRAVERSAL:       sResult="Traversal";            break;
+        case PHASE_PROLOGUES:       sResult="Prologues";            break;
+        case PHASE_CFG:             sResult="Control flow graph";   break;
+        case PHASE_ADJUST:          sResult="Adjust";               break;
+        case PHASE_UPDATEPOSITIONS: sResult="Update positions";     break;
+        default:                                                    break;
+    }
+
+    return sResult;
+}
+
+const XDisasm::LABEL *XDisasm::findLabel(XDisasm::STATS *pStats, qint64 nAddress)
+{
+    const LABEL *pResult=0;
+
+    const LABEL *pBegin=pStats->listLabels.constData();
+    const LABEL *pEnd=pBegin+pStats->listLabels.count();
+
+    LABEL label={};
+    label.nAddress=nAddress;
+
+    const LABEL *pLabel=std::lower_bound(pBegin,pEnd,label,_labelLessThan);
+
+    if((pLabel!=pEnd)&&(pLabel->nAddress==nAddress))
+    {
+        pResult=pLabel;
+    }
+
+    return pResult;
+}
+
+QString XDisasm::labelToString(XDisasm::STATS *pStats, const XDisasm::LABEL *pLabel)
+{
+    QString sResult;
+
+    switch(pLabel->type)
+    {
+        case LABEL_TYPE_USER:       sResult=getName(pStats,pLabel->nName);                  break;
+        case LABEL_TYPE_ENTRYPOINT: sResult="entry_point";                                  break;
+        case LABEL_TYPE_SYMBOL:     sResult=getName(pStats,pLabel->nName);                  break;
+        case LABEL_TYPE_FUNCTION:   sResult=QString("func_%1").arg(pLabel->nAddress,0,16);  break;
+        case LABEL_TYPE_JUMP:       sResult=QString("lab_%1").arg(pLabel->nAddress,0,16);   break;
+        case LABEL_TYPE_STRING:     sResult=QString("str_%1").arg(pLabel->nAddress,0,16);   break;
+        default:                                                                            break;
+    }
+
+    return sResult;
+}
+
+QString XDisasm::getLabelString(XDisasm::STATS *pStats, qint64 nAddress)
+{
+    QString sResult;
+
+    const LABEL *pLabel=findLabel(pStats,nAddress);
+
+    if(pLabel)
+    {
+        sResult=labelToString(pStats,pLabel);
+    }
+
+    return sResult;
+}
+
+qint32 XDisasm::addName(XDisasm::STATS *pStats, QString sName)
+{
+    qint32 nResult=pStats->names.hashNames.value(sName,-1);
+
+    if(nResult==-1)
+    {
+        nResult=pStats->names.listOffsets.count();
+
+        pStats->names.listOffsets.append(pStats->names.baData.size());
+        pStats->names.baData.append(sName.toUtf8());
+        pStats->names.baData.append('\0');
+
+        pStats->names.hashNames.insert(sName,nResult);
+    }
+
+    return nResult;
+}
+
+QString XDisasm::getName(XDisasm::STATS *pStats, qint32 nName)
+{
+    QString sResult;
+
+    if((nName>=0)&&(nName<pStats->names.listOffsets.count()))
+    {
+        sResult=QString::fromUtf8(pStats->names.baData.constData()+pStats->names.listOffsets.at(nName));
+    }
+
+    return sResult;
+}
+
+void XDisasm::setUserLabel(XDisasm::STATS *pStats, qint64 nAddress, QString sName)
+{
+    LABEL label={};
+    label.nAddress=nAddress;
+    label.type=LABEL_TYPE_USER;
+    label.nName=addName(pStats,sName);
+
+    pStats->mapUserLabels.insert(nAddress,label.nName);
+
+    QVector<LABEL>::iterator iter=std::lower_bound(pStats->listLabels.begin(),pStats->listLabels.end(),label,_labelLessThan);
+
+    if((iter!=pStats->listLabels.end())&&(iter->nAddress==nAddress))
+    {
+        *iter=label;
+    }
+    else
+    {
+        pStats->listLabels.insert(iter,label);
+    }
+}
+
+void XDisasm::removeUserLabel(XDisasm::STATS *pStats, qint64 nAddress)
+{
+    pStats->mapUserLabels.remove(nAddress);
+
+    LABEL label={};
+    label.nAddress=nAddress;
+
+    QVector<LABEL>::iterator iter=std::lower_bound(pStats->listLabels.begin(),pStats->listLabels.end(),label,_labelLessThan);
+
+    if((iter!=pStats->listLabels.end())&&(iter->nAddress==nAddress)&&(iter->type==LABEL_TYPE_USER))
+    {
+        // Back to the generated label, if there is one
+        iter->nName=-1;
+
+        const SYMBOL *pSymbol=findSymbol(pStats,nAddress);
+
+        if(nAddress==pStats->nEntryPointAddress)
+        {
+            iter->type=LABEL_TYPE_ENTRYPOINT;
+        }
+        else if(pSymbol&&(pSymbol->nName!=-1))
+        {
+            iter->type=LABEL_TYPE_SYMBOL;
+            iter->nName=pSymbol->nName;
+        }
+        else if(pSymbol||pStats->stCalls.contains(nAddress)||pStats->listRoots.contains(nAddress))
+        {
+            iter->type=LABEL_TYPE_FUNCTION;
+        }
+        else if(pStats->stJumps.contains(nAddress))
+        {
+            iter->type=LABEL_TYPE_JUMP;
+        }
+        else if(pStats->mapRecords.value(nAddress).nFlags&(RF_ANSISTRING|RF_UNICODESTRING))
+        {
+            iter->type=LABEL_TYPE_STRING;
+        }
+        else
+        {
+            pStats->listLabels.erase(iter);
+        }
+    }
+}
+
+const qint64 *XDisasm::getRefTo(XDisasm::STATS *pStats, qint64 nAddress, qint32 *pnCount)
+{
+    return _getRefs(&(pStats->refTo),nAddress,pnCount);
+}
+
+const qint64 *XDisasm::getRefFrom(XDisasm::STATS *pStats, qint64 nAddress, qint32 *pnCount)
+{
+    return _getRefs(&(pStats->refFrom),nAddress,pnCount);
+}
+
+qint64 XDisasm::getXrefCount(XDisasm::STATS *pStats)
+{
+    return pStats->refTo.listValues.count();
+}
+
+qint32 XDisasm::findBlock(XDisasm::STATS *pStats, qint64 nAddress)
+{
+    qint32 nResult=-1;
+
+    const BASIC_BLOCK *pBegin=pStats->cfg.listBlocks.constData();
+    const BASIC_BLOCK *pEnd=pBegin+pStats->cfg.listBlocks.count();
+
+    const BASIC_BLOCK *pBlock=std::upper_bound(pBegin,pEnd,nAddress,[](qint64 nValue,const BASIC_BLOCK &block){return nValue<block.nAddress;});
+
+    if(pBlock!=pBegin)
+    {
+        pBlock--;
+
+        if(nAddress<(pBlock->nAddress+pBlock->nSize))
+        {
+            nResult=(qint32)(pBlock-pBegin);
+        }
+    }
+
+    return nResult;
+}
+
+qint32 XDisasm::findFunction(XDisasm::STATS *pStats, qint64 nAddress)
+{
+    qint32 nResult=-1;
+
+    const FUNCTION *pBegin=pStats->cfg.listFunctions.constData();
+    const FUNCTION *pEnd=pBegin+pStats->cfg.listFunctions.count();
+
+    const FUNCTION *pFunction=std::lower_bound(pBegin,pEnd,nAddress,[](const FUNCTION &function,qint64 nValue){return function.nAddress<nValue;});
+
+    if((pFunction!=pEnd)&&(pFunction->nAddress==nAddress))
+    {
+        nResult=(qint32)(pFunction-pBegin);
+    }
+
+    return nResult;
+}
+
+const qint32 *XDisasm::getSuccessors(XDisasm::STATS *pStats, qint32 nBlock, qint32 *pnCount)
+{
+    return _getRow(&(pStats->cfg.listSuccessorOffsets),&(pStats->cfg.listSuccessors),nBlock,pnCount);
+}
+
+const qint32 *XDisasm::getPredecessors(XDisasm::STATS *pStats, qint32 nBlock, qint32 *pnCount)
+{
+    return _getRow(&(pStats->cfg.listPredecessorOffsets),&(pStats->cfg.listPredecessors),nBlock,pnCount);
+}
+
+const qint32 *XDisasm::getFunctionBlocks(XDisasm::STATS *pStats, qint32 nFunction, qint32 *pnCount)
+{
+    return _getRow(&(pStats->cfg.listFunctionBlockOffsets),&(pStats->cfg.listFunctionBlocks),nFunction,pnCount);
+}
+
+const qint32 *XDisasm::getCallees(XDisasm::STATS *pStats, qint32 nFunction, qint32 *pnCount)
+{
+    return _getRow(&(pStats->cfg.listCalleeOffsets),&(pStats->cfg.listCallees),nFunction,pnCount);
+}
+
+const XDisasm::SYMBOL *XDisasm::findSymbol(XDisasm::STATS *pStats, qint64 nAddress)
+{
+    const SYMBOL *pResult=0;
+
+    const SYMBOL *pBegin=pStats->listSymbols.constData();
+    const SYMBOL *pEnd=pBegin+pStats->listSymbols.count();
+
+    SYMBOL symbol={};
+    symbol.nAddress=nAddress;
+
+    const SYMBOL *pSymbol=std::lower_bound(pBegin,pEnd,symbol,_symbolLessThan);
+
+    if((pSymbol!=pEnd)&&(pSymbol->nAddress==nAddress))
+    {
+        pResult=pSymbol;
+    }
+
+    return pResult;
+}
+
+QString XDisasm::symbolSourceToString(XDisasm::SS ss)
+{
+    QString sResult="Unknown";
+
+    switch(ss)
+    {
+        case SS_EXPORT:     sResult="Export";       break;
+        case SS_TLS:        sResult="TLS";          break;
+        case SS_EXCEPTION:  sResult="Exception";    break;
+        case SS_SYMBOL:     sResult="Symbol";       break;
+        default:                                    break;
+    }
+
+    return sResult;
+}
+
+const XDisasm::WINDOW *XDisasm::getWindow(XDisasm::STATS *pStats, qint64 nAddress)
+{
+    const WINDOW *pResult=0;
+
+    const ENTROPY_REGION *pBegin=pStats->entropy.listRegions.constData();
+    const ENTROPY_REGION *pEnd=pBegin+pStats->entropy.listRegions.count();
+
+    ENTROPY_REGION region={};
+    region.nAddress=nAddress;
+
+    const ENTROPY_REGION *pRegion=std::upper_bound(pBegin,pEnd,region,_entropyRegionLessThan);
+
+    if(pRegion!=pBegin)
+    {
+        pRegion--;
+
+        if(nAddress<(pRegion->nAddress+pRegion->nSize))
+        {
+            qint32 nWindow=pRegion->nWindow+(qint32)((nAddress-pRegion->nAddress)/pStats->entropy.nWindowSize);
+
+            if(nWindow<pStats->entropy.listWindows.count())
+            {
+                pResult=&(pStats->entropy.listWindows.at(nWindow));
+            }
+        }
+    }
+
+    return pResult;
+}
+
+QString XDisasm::windowClassToString(XDisasm::WC wc)
+{
+    QString sResult="Unknown";
+
+    switch(wc)
+    {
+        case WC_CODE:       sResult="Code";         break;
+        case WC_DATA:       sResult="Data";         break;
+        case WC_ZERO:       sResult="Zero";         break;
+        case WC_PACKED:     sResult="Packed";       break;
+        default:                                    break;
+    }
+
+    return sResult;
+}
+
+QString XDisasm::getDisasmString(csh disasm_handle, qint64 nAddress, char *pData, qint32 nDataSize)
+{
+    QString sResult;
+
+    cs_insn *insn;
+    size_t count=cs_disasm(disasm_handle,(uint8_t *)pData,nDataSize,nAddress,1,&insn);
+
+    if(count>0)
+    {
+        QString sMnemonic=insn->mnemonic;
+        QString sArgs=insn->op_str;
+
+        sResult=sMnemonic;
+        if(sArgs!="")
+        {
+            sResult+=" "+sArgs;
+        }
+
+        cs_free(insn,count);
+    }
+
+    return sResult;
+}
+
+QList<XDisasm::SIGNATURE_RECORD> XDisasm::getSignature(XDisasm::SIGNATURE_OPTIONS *pSignatureOptions, qint64 nAddress)
+{
+    QList<SIGNATURE_RECORD> listResult;
+
+    SIGNATURE_CONTEXT context={};
+
+    if(openSignature(&context,pSignatureOptions,nAddress))
+    {
+        resizeSignature(&context,pSignatureOptions,&listResult,pSignatureOptions->nCount);
+    }
+
+    closeSignature(&context);
+
+    return listResult;
+}
+
+bool XDisasm::openSignature(XDisasm::SIGNATURE_CONTEXT *pContext, XDisasm::SIGNATURE_OPTIONS *pSignatureOptions, qint64 nAddress)
+{
+    cs_err err=cs_open(pSignatureOptions->csarch,pSignatureOptions->csmode,&(pContext->handle));
+    if(!err)
+    {
+        cs_option(pContext->handle,CS_OPT_DETAIL,CS_OPT_ON);
+    }
+
+    pContext->bIsOpen=(err==CS_ERR_OK);
+    pContext->nAddress=nAddress;
+    pContext->nNextAddress=nAddress;
+    pContext->bIsStopped=!(pContext->bIsOpen);
+    pContext->stAddresses.clear();
+
+    return pContext->bIsOpen;
+}
+
+void XDisasm::closeSignature(XDisasm::SIGNATURE_CONTEXT *pContext)
+{
+    if(pContext->bIsOpen)
+    {
+        cs_close(&(pContext->handle));
+
+        pContext->bIsOpen=false;
+    }
+}
+
+void XDisasm::resizeSignature(XDisasm::SIGNATURE_CONTEXT *pContext, XDisasm::SIGNATURE_OPTIONS *pSignatureOptions, QList<XDisasm::SIGNATURE_RECORD> *pListRecords, qint32 nCount)
+{
+    if(nCount<pListRecords->count())
+    {
+        while(pListRecords->count()>nCount)
+        {
+            pContext->stAddresses.remove(pListRecords->last().nAddress);
+            pListRecords->removeLast();
+        }
+
+        // The record that stopped the walk is past the end now
+        pContext->nNextAddress=pListRecords->count()?pListRecords->last().nNextAddress:pContext->nAddress;
+        pContext->bIsStopped=!(pContext->bIsOpen);
+    }
+
+    qint64 nAddress=pContext->nNextAddress;
+
+    while((pListRecords->count()<nCount)&&(!pContext->bIsStopped))
+    {
+        qint64 nOffset=XBinary::addressToOffset(&(pSignatureOptions->memoryMap),nAddress);
+        if(nOffset!=-1)
+        {
+            char opcode[N_X64_OPCODE_SIZE];
+
+            XBinary::_zeroMemory(opcode,N_X64_OPCODE_SIZE);
+
+            size_t nDataSize=XBinary::read_array(pSignatureOptions->pDevice,nOffset,opcode,N_X64_OPCODE_SIZE);
+
+            uint8_t *pData=(uint8_t *)opcode;
+
+            cs_insn *insn;
+            size_t count=cs_disasm(pContext->handle,pData,nDataSize,nAddress,1,&insn);
+
+            if(count>0)
+            {
+                if(insn->size>1)
+                {
+                    pContext->bIsStopped=!XBinary::isAddressPhysical(&(pSignatureOptions->memoryMap),nAddress+insn->size-1);
+                }
+
+                if(pContext->stAddresses.contains(nAddress))
+                {
+                    pContext->bIsStopped=true;
+                }
+
+                if(!pContext->bIsStopped)
+                {
+                    SIGNATURE_RECORD record={};
+
+                    record.nAddress=nAddress;
+                    record.sOpcode=insn->mnemonic;
+                    QString sArgs=insn->op_str;
+
+                    if(sArgs!="")
+                    {
+                        record.sOpcode+=" "+sArgs;
+                    }
+
+                    record.baOpcode=QByteArray(opcode,insn->size);
+
+                    record.nDispOffset=insn->detail->x86.encoding.disp_offset;
+                    record.nDispSize=insn->detail->x86.encoding.disp_size;
+                    record.nImmOffset=insn->detail->x86.encoding.imm_offset;
+                    record.nImmSize=insn->detail->x86.encoding.imm_size;
+
+                    pContext->stAddresses.insert(nAddress);
+
+                    nAddress+=insn->size;
+
+                    if(pSignatureOptions->sm==XDisasm::SM_RELATIVEADDRESS)
+                    {
+                        for(int i=0; i<insn->detail->x86.op_count; i++)
+                        {
+                            if(insn->detail->x86.operands[i].type==X86_OP_IMM)
+                            {
+                                qint64 nImm=insn->detail->x86.operands[i].imm;
+
+                                if(isJmpOpcode(insn->id))
+                                {
+                                    nAddress=nImm;
+                                    record.bIsConst=true;
+                                }
+                            }
+                        }
+                    }
+
+                    record.nNextAddress=nAddress;
+
+                    pListRecords->append(record);
+                }
+
+                cs_free(insn,count);
+            }
+            else
+            {
+                pContext->bIsStopped=true;
+            }
+        }
+        else
+        {
+            pContext->bIsStopped=true;
+        }
+    }
+
+    pContext->nNextAddress=nAddress;
+}
+
+bool XDisasm::isEndBranchOpcode(uint nOpcodeID)
+{
+    bool bResult=false;
+
+    // TODO more checks
+    if( (nOpcodeID==X86_INS_JMP)||
+        (nOpcodeID==X86_INS_RET)||
+        (nOpcodeID==X86_INS_INT3))
+    {
+        bResult=true;
+    }
+
+    return bResult;
+}
+
+bool XDisasm::isJmpOpcode(uint nOpcodeID)
+{
+    bool bResult=false;
+
+    if( (nOpcodeID==X86_INS_JMP)||
+        (nOpcodeID==X86_INS_JA)||
+        (nOpcodeID==X86_INS_JAE)||
+        (nOpcodeID==X86_INS_JB)||
+        (nOpcodeID==X86_INS_JBE)||
+        (nOpcodeID==X86_INS_JCXZ)||
+        (nOpcodeID==X86_INS_JE)||
+        (nOpcodeID==X86_INS_JECXZ)||
+        (nOpcodeID==X86_INS_JG)||
+        (nOpcodeID==X86_INS_JGE)||
+        (nOpcodeID==X86_INS_JL)||
+        (nOpcodeID==X86_INS_JLE)||
+        (nOpcodeID==X86_INS_JNE)||
+        (nOpcodeID==X86_INS_JNO)||
+        (nOpcodeID==X86_INS_JNP)||
+        (nOpcodeID==X86_INS_JNS)||
+        (nOpcodeID==X86_INS_JO)||
+        (nOpcodeID==X86_INS_JP)||
+        (nOpcodeID==X86_INS_JRCXZ)||
+        (nOpcodeID==X86_INS_JS)||
+        (nOpcodeID==X86_INS_LOOP)||
+        (nOpcodeID==X86_INS_LOOPE)||
+        (nOpcodeID==X86_INS_LOOPNE)||
+        (nOpcodeID==X86_INS_CALL))
+    {
+        bResult=true;
+    }
+
+    return bResult;
+}
+
+bool XDisasm::isCallOpcode(uint nOpcodeID)
+{
+    bool bResult=false;
+
+    if(nOpcodeID==X86_INS_CALL)
+    {
+        bResult=true;
+    }
+
+    return bResult;
+}
+
+void XDisasm::_beginPhase(XDisasm::PHASE phase)
+{
+    currentPhase=phase;
+
+    if(pOptions->bInstrumentation)
+    {
+        pPhaseStat=&(pOptions->stats.phaseStat[phase]);
+    }
+
+    nTraceStart=XDisasmTrace::isEnabled()?XDisasmTrace::getTime():-1;
+
+    timerPhase.start();
+}
+
+void XDisasm::_endPhase()
+{
+    PHASE_STAT *pStat=&(pOptions->stats.phaseStat[currentPhase]);
+
+    pStat->nTime+=timerPhase.nsecsElapsed();
+    pStat->nCount++;
+
+    if(nTraceStart!=-1)
+    {
+        // The tracer keeps the pointer, the names must be literals
+        const char *pszNames[__PHASE_SIZE]={"Memory map","_updateEntropy","_updateStrings","_updateSymbols","Traversal","_updatePrologues","_updateCFG","_adjust","_updatePositions"};
+
+        XDisasmTrace::addEvent(pszNames[currentPhase],nTraceStart,XDisasmTrace::getTime()-nTraceStart);
+    }
+
+    if(currentPhase==PHASE_MEMORYMAP)
+    {
+        pStat->nContainerSize=pOptions->stats.memoryMap.listRecords.count();
+    }
+    else if(currentPhase==PHASE_ENTROPY)
+    {
+        pStat->nContainerSize=pOptions->stats.entropy.listWindows.count();
+    }
+    else if(currentPhase==PHASE_STRINGS)
+    {
+        pStat->nContainerSize=pOptions->stats.listStrings.count();
+    }
+    else if(currentPhase==PHASE_SYMBOLS)
+    {
+        pStat->nContainerSize=pOptions->stats.listSymbols.count();
+    }
+    else if(currentPhase==PHASE_TRAVERSAL)
+    {
+        pStat->nContainerSize=  pOptions->stats.mapRecords.count()+
+                                pOptions->stats.refTo.listValues.count()+
+                                pOptions->stats.refFrom.listValues.count()+
+                                pOptions->stats.stCalls.count()+
+                                pOptions->stats.stJumps.count();
+    }
+    else if(currentPhase==PHASE_PROLOGUES)
+    {
+        pStat->nContainerSize=pOptions->stats.prologues.nConfirmed;
+    }
+    else if(currentPhase==PHASE_CFG)
+    {
+        pStat->nContainerSize=  pOptions->stats.cfg.listBlocks.count()+
+                                pOptions->stats.cfg.listSuccessors.count()+
+                                pOptions->stats.cfg.listFunctions.count();
+    }
+    else if(currentPhase==PHASE_ADJUST)
+    {
+        pStat->nContainerSize=pOptions->stats.mapVB.count()+pOptions->stats.listLabels.count();
+    }
+    else if(currentPhase==PHASE_UPDATEPOSITIONS)
+    {
+        pStat->nContainerSize=pOptions->stats.mapPositions.count()+pOptions->stats.mapAddresses.count();
+    }
+
+    pPhaseStat=0;
+
+    // Only the counters: a snapshot here would share the containers that the next phases change
+    _publishProgress();
+}
+
+void XDisasm::_publishProgress()
+{
+    PROGRESS _progress={};
+
+    _progress.nOpcodes=pOptions->stats.mapRecords.count()-pOptions->stats.nStringRecords;
+    _progress.nCalls=pOptions->stats.stCalls.count();
+    _progress.nJumps=pOptions->stats.stJumps.count();
+    _progress.nRefFrom=pOptions->stats.refFrom.listValues.count();
+    _progress.nRefTo=pOptions->stats.refTo.listValues.count()+pOptions->stats.listPendingRefs.count();
+    _progress.nDataLabels=pOptions->stats.nStringRecords;
+    _progress.nVB=pOptions->stats.mapVB.count();
+    _progress.nLabels=pOptions->stats.listLabels.count();
+    _progress.nPositions=pOptions->stats.mapPositions.count();
+    _progress.nAddresses=pOptions->stats.mapAddresses.count();
+
+    for(int i=0;i<__PHASE_SIZE;i++)
+    {
+        _progress.phaseStat[i]=pOptions->stats.phaseStat[i];
+    }
+
+    _progress.listMemoryRecords=getMemoryRecords(&(pOptions->stats));
+
+    QMutexLocker locker(&mutexProgress);
+
+    progress=_progress;
+}
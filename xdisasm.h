@@ -1,181 +1,578 @@
-// copyright (c) 2019-2020 hors<horsicq@gmail.com>
-//
-// Permission is hereby granted, free of charge, to any person obtaining a copy
-// of this software and associated documentation files (the "Software"), to deal
-// in the Software without restriction, including without limitation the rights
-// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-// copies of the Software, and to permit persons to whom the Software is
-// furnished to do so, subject to the following conditions:
-
-// The above copyright notice and this permission notice shall be included in all
-// copies or substantial portions of the Software.
-
-// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-// SOFTWARE.
-//
-#ifndef XDISASM_H
-#define XDISASM_H
-
-#include <QObject>
-#include "xformats.h"
-#include "capstone/capstone.h"
-
-
-class XDisasm : public QObject
-{
-    Q_OBJECT
-    static const int N_X64_OPCODE_SIZE=15;
-    static const int N_OPCODE_COUNT=100000;
-public:
-    enum DM
-    {
-        DM_UNKNOWN=0,
-        DM_DISASM,
-        DM_TODATA
-    };
-
-    enum VBT
-    {
-        VBT_UNKNOWN=0,
-        VBT_OPCODE,
-        VBT_DATA,
-        VBT_DATABLOCK
-    };
-
-    enum RECORD_TYPE
-    {
-        RECORD_TYPE_UNKNOWN=0,
-        RECORD_TYPE_OPCODE,
-        RECORD_TYPE_DATA,
-    };
-
-    struct RECORD
-    {
-        qint64 nOffset;
-        qint64 nSize;
-        RECORD_TYPE type;
-    };
-
-//    enum LABEL_TYPE
-//    {
-//        LABEL_TYPE_UNKNOWN=0;
-//        LABEL_TYPE_
-//    };
-
-    struct LABEL
-    {
-        qint64 nName;
-    };
-
-    struct VIEW_BLOCK
-    {
-        qint64 nAddress;
-        qint64 nOffset;
-        qint64 nSize;
-        VBT type;
-    };
-
-    struct STATS
-    {
-        bool bInit;
-        XBinary::_MEMORY_MAP memoryMap;
-        cs_arch csarch;
-        cs_mode csmode;
-        qint64 nImageBase;
-        qint64 nImageSize;
-        qint64 nEntryPointAddress;
-        QMap<qint64,RECORD> mapRecords;
-        QMultiMap<qint64,qint64> mmapRefTo;
-        QMultiMap<qint64,qint64> mmapRefFrom;
-        QSet<qint64> stCalls;
-        QSet<qint64> stJumps;
-        QMultiMap<qint64,qint64> mmapDataLabels; // TODO Check
-        QMap<qint64,VIEW_BLOCK> mapVB;
-        QMap<qint64,QString> mapLabelStrings;
-        qint64 nPositions;
-        QMap<qint64,qint64> mapPositions;
-        QMap<qint64,qint64> mapAddresses;
-        bool bIsOverlayPresent;
-        qint64 nOverlayOffset;
-        qint64 nOverlaySize;
-    };
-
-    struct OPTIONS
-    {
-        bool bIsImage;
-        qint64 nImageBase;
-        XBinary::FT ft;
-        XDisasm::STATS stats;
-    };
-
-    explicit XDisasm(QObject *pParent=nullptr);
-    ~XDisasm();
-    void setData(QIODevice *pDevice,OPTIONS *pOptions, qint64 nStartAddress,DM dm);
-    void stop();
-    STATS *getStats();
-    static qint64 getVBSize(QMap<qint64,VIEW_BLOCK> *pMapVB);
-    static QString getDisasmString(csh disasm_handle, qint64 nAddress, char *pData, qint32 nDataSize);
-
-    enum SM
-    {
-        SM_NORMAL=0,
-        SM_RELATIVEADDRESS
-    };
-
-    struct SIGNATURE_OPTIONS
-    {
-        QIODevice *pDevice;
-        XBinary::_MEMORY_MAP memoryMap;
-        cs_arch csarch;
-        cs_mode csmode;
-        int nCount;
-        SM sm;
-    };
-
-    struct SIGNATURE_RECORD
-    {
-        qint64 nAddress;
-        QString sOpcode;
-        QByteArray baOpcode;
-        qint32 nDispOffset;
-        qint32 nDispSize;
-        qint32 nImmOffset;
-        qint32 nImmSize;
-        bool bIsConst;
-    };
-
-    static QList<SIGNATURE_RECORD> getSignature(SIGNATURE_OPTIONS *pSignatureOptions,qint64 nAddress);
-
-public slots:
-    void processDisasm();
-    void processToData();
-    void process();
-
-private:
-    bool isEndBranchOpcode(uint nOpcodeID);
-    static bool isJmpOpcode(uint nOpcodeID);
-    static bool isCallOpcode(uint nOpcodeID);
-    void _disasm(qint64 nInitAddress, qint64 nAddress);
-    void _adjust();
-    void _updatePositions();
-    bool _insertOpcode(qint64 nAddress,RECORD *pOpcode);
-
-signals:
-    void errorMessage(QString sText);
-    void processFinished();
-
-private:
-    DM dm;
-    csh disasm_handle;
-    bool bStop;
-    QIODevice *pDevice;
-    OPTIONS *pOptions;
-    qint64 nStartAddress;
-};
-
-#endif // XDISASM_H
+// copyright (c) 2019-2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef XDISASM_H
+#define XDISASM_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QHash>
+#include <QFile>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QtEndian>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include "xformats.h"
+#include "capstone/capstone.h"
+#include "xdisasmtrace.h"
+
+
+class XDisasm : public QObject
+{
+    Q_OBJECT
+    static const int N_X64_OPCODE_SIZE=15;
+    static const int N_OPCODE_COUNT=100000;
+    static const int N_NAME_LENGTH=16; // average user name, for the memory estimate
+    static const int N_ENTROPY_WINDOW=0x1000;
+    static const int N_ENTROPY_PACKED=7200; // bits per byte * 1000, x86 code is 5.5-6.8
+    static const int N_STRING_MIN_LENGTH=5;
+    static const int N_ROOTS_PER_THREAD=16; // fewer roots are traversed by the calling thread
+    static const int N_MAX_SYMBOL_TABLE=0x10000000;
+    static const int N_PROLOGUE_CHUNK=0x10000;
+    static const int N_PROLOGUE_INSTRUCTIONS=8; // decoded to confirm a candidate
+    static const int N_PROLOGUE_MIN_INSTRUCTIONS=4; // or fewer, up to a ret
+    static const int N_LIMIT_POLL=50; // msec, the limits are tested while the worker threads run
+public:
+    enum DM
+    {
+        DM_UNKNOWN=0,
+        DM_DISASM,
+        DM_TODATA
+    };
+
+    enum VBT
+    {
+        VBT_UNKNOWN=0,
+        VBT_OPCODE,
+        VBT_DATA,
+        VBT_DATABLOCK
+    };
+
+    enum RECORD_TYPE
+    {
+        RECORD_TYPE_UNKNOWN=0,
+        RECORD_TYPE_OPCODE,
+        RECORD_TYPE_DATA,
+    };
+
+    enum RF
+    {
+        RF_CALL=0x1,
+        RF_JUMP=0x2, // unconditional
+        RF_CONDJUMP=0x4,
+        RF_ENDBRANCH=0x8,
+        RF_ANSISTRING=0x10, // RECORD_TYPE_DATA
+        RF_UNICODESTRING=0x20 // RECORD_TYPE_DATA, UTF-16LE
+    };
+
+    struct RECORD
+    {
+        qint64 nOffset;
+        qint64 nSize;
+        RECORD_TYPE type;
+        quint32 nFlags; // RF_*
+    };
+
+    enum LABEL_TYPE
+    {
+        LABEL_TYPE_UNKNOWN=0,
+        LABEL_TYPE_USER,
+        LABEL_TYPE_ENTRYPOINT,
+        LABEL_TYPE_SYMBOL,
+        LABEL_TYPE_FUNCTION,
+        LABEL_TYPE_JUMP,
+        LABEL_TYPE_STRING
+    };
+
+    // The text is generated from the type and the address when it is displayed
+    struct LABEL
+    {
+        qint64 nAddress;
+        LABEL_TYPE type;
+        qint32 nName; // LABEL_TYPE_USER, LABEL_TYPE_SYMBOL: index in STATS::names
+    };
+
+    // Interned user names
+    struct NAME_ARENA
+    {
+        QByteArray baData; // UTF-8, 0-terminated
+        QVector<qint32> listOffsets;
+        QHash<QString,qint32> hashNames;
+    };
+
+    enum PHASE
+    {
+        PHASE_MEMORYMAP=0,
+        PHASE_ENTROPY,
+        PHASE_STRINGS,
+        PHASE_SYMBOLS,
+        PHASE_TRAVERSAL,
+        PHASE_PROLOGUES,
+        PHASE_CFG,
+        PHASE_ADJUST,
+        PHASE_UPDATEPOSITIONS,
+        __PHASE_SIZE
+    };
+
+    struct PHASE_STAT
+    {
+        qint64 nCount; // runs
+        qint64 nTime; // nsec
+        qint64 nInstructions; // OPTIONS::bInstrumentation
+        qint64 nBytesRead; // OPTIONS::bInstrumentation
+        qint64 nDecoderCalls; // OPTIONS::bInstrumentation
+        qint64 nContainerSize; // entries produced by the phase
+    };
+
+    struct XREF
+    {
+        qint64 nFrom;
+        qint64 nTo;
+    };
+
+    // Compressed sparse rows: the refs of listKeys[i] are listValues[listOffsets[i]..listOffsets[i+1])
+    struct XREF_INDEX
+    {
+        QVector<qint64> listKeys; // sorted
+        QVector<qint32> listOffsets; // listKeys.count()+1
+        QVector<qint64> listValues; // sorted per key, no duplicates
+    };
+
+    struct BASIC_BLOCK
+    {
+        qint64 nAddress;
+        qint64 nSize;
+        qint32 nInstructions;
+        qint32 nFunction; // owner, -1 if no function reaches the block
+    };
+
+    struct FUNCTION
+    {
+        qint64 nAddress;
+        qint64 nSize; // sum of the block sizes
+        qint32 nBlock; // entry block
+        qint32 nBlockCount;
+        qint32 nInstructions;
+        qint32 nCalleeCount;
+    };
+
+    // Blocks and functions are referenced by their index, the edge lists are compressed sparse rows
+    struct CFG
+    {
+        QVector<BASIC_BLOCK> listBlocks; // sorted by address
+        QVector<qint32> listSuccessorOffsets;
+        QVector<qint32> listSuccessors;
+        QVector<qint32> listPredecessorOffsets;
+        QVector<qint32> listPredecessors;
+        QVector<FUNCTION> listFunctions; // sorted by address
+        QVector<qint32> listFunctionBlockOffsets;
+        QVector<qint32> listFunctionBlocks; // sorted per function, a block can be shared
+        QVector<qint32> listCalleeOffsets;
+        QVector<qint32> listCallees; // function indexes
+    };
+
+    // Window class of the entropy pre-pass
+    enum WC
+    {
+        WC_UNKNOWN=0,
+        WC_CODE,
+        WC_DATA,
+        WC_ZERO, // padding, uninitialized data
+        WC_PACKED // compressed or encrypted
+    };
+
+    struct WINDOW
+    {
+        quint16 nEntropy; // bits per byte * 1000
+        quint8 nCodeScore; // share of frequent opcode bytes, 0..255
+        quint8 nZeroScore; // share of zero bytes, 0..255
+        quint8 wc; // WC
+    };
+
+    struct ENTROPY_REGION
+    {
+        qint64 nAddress;
+        qint64 nOffset;
+        qint64 nSize;
+        qint32 nWindow; // first window in ENTROPY::listWindows
+        quint32 histogram[256];
+    };
+
+    // File-backed regions split into N_ENTROPY_WINDOW windows, built once with the memory map
+    struct ENTROPY
+    {
+        qint32 nWindowSize;
+        QVector<ENTROPY_REGION> listRegions; // sorted by address
+        QVector<WINDOW> listWindows;
+        qint64 nRejectedTargets; // branch targets in WC_PACKED windows
+    };
+
+    enum ST
+    {
+        ST_UNKNOWN=0,
+        ST_ANSI,
+        ST_UNICODE
+    };
+
+    // 0-terminated string found in the file-backed regions, a candidate for a data record
+    struct STRING
+    {
+        qint64 nAddress;
+        qint32 nSize; // bytes with the terminator
+        quint8 st; // ST
+    };
+
+    // Source of a symbol
+    enum SS
+    {
+        SS_UNKNOWN=0,
+        SS_EXPORT, // PE export table
+        SS_TLS, // PE TLS callback
+        SS_EXCEPTION, // PE64 .pdata, the begin of a function
+        SS_SYMBOL // ELF .symtab/.dynsym function, Mach-O LC_SYMTAB
+    };
+
+    // A root taken from the headers of the format
+    struct SYMBOL
+    {
+        qint64 nAddress;
+        qint32 nName; // index in STATS::names, -1 if the source has no name
+        quint8 ss; // SS
+    };
+
+    // OPTIONS::bPrologueScan: the code windows that the traversal did not reach
+    struct PROLOGUES
+    {
+        qint64 nUncoveredSize; // bytes in WC_CODE windows without records, before the scan
+        qint64 nRemainingSize; // after the roots of the scan are traversed
+        qint64 nCandidates; // pattern matches at a function boundary
+        qint64 nConfirmed; // decoded, new roots
+    };
+
+    struct VIEW_BLOCK
+    {
+        qint64 nAddress;
+        qint64 nOffset;
+        qint64 nSize;
+        VBT type;
+    };
+
+    struct STATS
+    {
+        bool bInit;
+        XBinary::_MEMORY_MAP memoryMap;
+        cs_arch csarch;
+        cs_mode csmode;
+        qint64 nImageBase;
+        qint64 nImageSize;
+        qint64 nEntryPointAddress;
+        QVector<qint64> listRoots; // extra entry points (signature matches ...), kept between runs
+        QVector<SYMBOL> listSymbols; // sorted by address, one per address, built once with the memory map
+        QMap<qint64,RECORD> mapRecords;
+        QVector<XREF> listPendingRefs; // found by the traversal, not yet in the indexes
+        XREF_INDEX refTo; // instruction -> targets
+        XREF_INDEX refFrom; // target -> instructions
+        QSet<qint64> stCalls;
+        QSet<qint64> stJumps;
+        CFG cfg;
+        ENTROPY entropy;
+        QVector<STRING> listStrings; // sorted by address, built once with the memory map
+        QVector<XREF> listDataRefs; // instruction -> immediate or memory operand inside the image
+        PROLOGUES prologues;
+        qint64 nStringRecords; // strings that do not overlap instructions, RECORD_TYPE_DATA
+        QMap<qint64,VIEW_BLOCK> mapVB;
+        QVector<LABEL> listLabels; // sorted by address
+        QMap<qint64,qint32> mapUserLabels; // address -> name, kept between runs
+        QMap<qint64,qint64> mapDataRanges; // address -> size, converted to data by the user, not decoded again, kept between runs
+        NAME_ARENA names;
+        qint64 nPositions;
+        QMap<qint64,qint64> mapPositions;
+        QMap<qint64,qint64> mapAddresses;
+        bool bIsOverlayPresent;
+        qint64 nOverlayOffset;
+        qint64 nOverlaySize;
+        bool bTimeLimitReached;
+        bool bMemoryLimitReached;
+        PHASE_STAT phaseStat[__PHASE_SIZE];
+    };
+
+    struct OPTIONS
+    {
+        bool bIsImage;
+        qint64 nImageBase;
+        XBinary::FT ft;
+        qint64 nTimeLimit; // msec, 0 - no limit
+        qint64 nMemoryLimit; // bytes, 0 - no limit
+        qint64 nOpcodeLimit; // 0 - N_OPCODE_COUNT, -1 - no limit
+        bool bInstrumentation; // per instruction counters
+        bool bNoEntropyFilter; // follow branches into WC_PACKED windows
+        qint32 nStringMinLength; // characters, 0 - N_STRING_MIN_LENGTH
+        qint32 nThreads; // traversal of the roots, string scan, prologue scan, 0 - ideal thread count
+        bool bPrologueScan; // look for functions that the traversal did not reach
+        XDisasm::STATS stats; // changed by the engine
+        std::shared_ptr<QSharedPointer<XDisasm::STATS> > pSnapshot; // the last published copy of stats, swapped with std::atomic_store, see getSnapshot()
+    };
+
+    struct MEMORY_RECORD
+    {
+        QString sName;
+        qint64 nCount; // entries
+        qint64 nSize; // bytes, estimated
+    };
+
+    // The counters of a running analysis, published after every phase instead of a snapshot of the whole stats
+    struct PROGRESS
+    {
+        qint64 nOpcodes;
+        qint64 nCalls;
+        qint64 nJumps;
+        qint64 nRefFrom;
+        qint64 nRefTo;
+        qint64 nDataLabels;
+        qint64 nVB;
+        qint64 nLabels;
+        qint64 nPositions;
+        qint64 nAddresses;
+        PHASE_STAT phaseStat[__PHASE_SIZE];
+        QList<MEMORY_RECORD> listMemoryRecords;
+    };
+
+    explicit XDisasm(QObject *pParent=nullptr);
+    ~XDisasm();
+    void setData(QIODevice *pDevice,OPTIONS *pOptions, qint64 nStartAddress,DM dm,qint64 nSize=0); // nSize: the range of DM_TODATA/DM_DISASM, 0 - the record at nStartAddress
+    void stop();
+    STATS *getStats();
+    QSharedPointer<STATS> getSnapshot();
+    static QSharedPointer<STATS> getSnapshot(OPTIONS *pOptions); // lock-free, never changed after it is published, 0 if there is none
+    static void publishSnapshot(OPTIONS *pOptions); // at the end of a run, or after stats are changed outside of the engine
+    PROGRESS getProgress(); // from any thread, the state after the last phase that is done
+    static QList<MEMORY_RECORD> getMemoryRecords(STATS *pStats);
+    static qint64 getMemoryEstimate(STATS *pStats);
+    static qint64 getPeakMemoryUsage();
+    static qint64 getVBSize(QMap<qint64,VIEW_BLOCK> *pMapVB);
+    static QString phaseIdToString(PHASE phase);
+    static const LABEL *findLabel(STATS *pStats,qint64 nAddress);
+    static QString labelToString(STATS *pStats,const LABEL *pLabel);
+    static QString getLabelString(STATS *pStats,qint64 nAddress);
+    static qint32 addName(STATS *pStats,QString sName);
+    static QString getName(STATS *pStats,qint32 nName);
+    static void setUserLabel(STATS *pStats,qint64 nAddress,QString sName);
+    static void removeUserLabel(STATS *pStats,qint64 nAddress);
+    static const qint64 *getRefTo(STATS *pStats,qint64 nAddress,qint32 *pnCount);
+    static const qint64 *getRefFrom(STATS *pStats,qint64 nAddress,qint32 *pnCount);
+    static qint64 getXrefCount(STATS *pStats);
+    static qint32 findBlock(STATS *pStats,qint64 nAddress); // the block containing the address
+    static qint32 findFunction(STATS *pStats,qint64 nAddress); // the function starting at the address
+    static const qint32 *getSuccessors(STATS *pStats,qint32 nBlock,qint32 *pnCount);
+    static const qint32 *getPredecessors(STATS *pStats,qint32 nBlock,qint32 *pnCount);
+    static const qint32 *getFunctionBlocks(STATS *pStats,qint32 nFunction,qint32 *pnCount);
+    static const qint32 *getCallees(STATS *pStats,qint32 nFunction,qint32 *pnCount);
+    static const SYMBOL *findSymbol(STATS *pStats,qint64 nAddress);
+    static QString symbolSourceToString(SS ss);
+    static const WINDOW *getWindow(STATS *pStats,qint64 nAddress); // 0 if the address is not file-backed
+    static QString windowClassToString(WC wc);
+    static QString getDisasmString(csh disasm_handle, qint64 nAddress, char *pData, qint32 nDataSize);
+
+    enum SM
+    {
+        SM_NORMAL=0,
+        SM_RELATIVEADDRESS
+    };
+
+    struct SIGNATURE_OPTIONS
+    {
+        QIODevice *pDevice;
+        XBinary::_MEMORY_MAP memoryMap;
+        cs_arch csarch;
+        cs_mode csmode;
+        int nCount;
+        SM sm;
+    };
+
+    struct SIGNATURE_RECORD
+    {
+        qint64 nAddress;
+        QString sOpcode;
+        QByteArray baOpcode;
+        qint32 nDispOffset;
+        qint32 nDispSize;
+        qint32 nImmOffset;
+        qint32 nImmSize;
+        bool bIsConst;
+        qint64 nNextAddress; // the address of the next record
+    };
+
+    // The decoder and the walk state of a signature, kept open while the signature is resized
+    struct SIGNATURE_CONTEXT
+    {
+        csh handle;
+        bool bIsOpen;
+        qint64 nAddress; // the first record
+        qint64 nNextAddress;
+        bool bIsStopped;
+        QSet<qint64> stAddresses;
+    };
+
+    static QList<SIGNATURE_RECORD> getSignature(SIGNATURE_OPTIONS *pSignatureOptions,qint64 nAddress);
+    static bool openSignature(SIGNATURE_CONTEXT *pContext,SIGNATURE_OPTIONS *pSignatureOptions,qint64 nAddress);
+    static void closeSignature(SIGNATURE_CONTEXT *pContext);
+    static void resizeSignature(SIGNATURE_CONTEXT *pContext,SIGNATURE_OPTIONS *pSignatureOptions,QList<SIGNATURE_RECORD> *pListRecords,qint32 nCount); // appends or removes records at the end
+
+public slots:
+    void processDisasm();
+    void processToData();
+    void process();
+
+private:
+    // State of one traversal thread, merged into STATS when it is done
+    struct TRAVERSAL
+    {
+        csh handle;
+        QIODevice *pDevice;
+        QMutex *pMutexDevice; // 0 if the device is not shared
+        QMutex *pMutex; // mapRecords, 0 if there is one thread
+        QVector<XREF> listWork; // branch targets to decode, a stack
+        QVector<XREF> listRefs;
+        QVector<XREF> listDataRefs;
+        QSet<qint64> stCalls;
+        QSet<qint64> stJumps;
+        qint64 nRejectedTargets;
+        qint64 nInstructions;
+        qint64 nBytesRead;
+        qint64 nDecoderCalls;
+    };
+
+    struct RANGE
+    {
+        qint64 nAddress;
+        qint64 nOffset;
+        qint64 nSize;
+    };
+
+    struct PROLOGUE_CHUNK
+    {
+        qint64 nAddress;
+        qint64 nOffset;
+        qint64 nSize;
+        qint64 nRangeEnd; // address, the candidates are decoded up to it
+    };
+
+    bool isEndBranchOpcode(uint nOpcodeID);
+    static bool isJmpOpcode(uint nOpcodeID);
+    static bool isCallOpcode(uint nOpcodeID);
+    void _disasm(TRAVERSAL *pTraversal,qint64 nInitAddress,qint64 nAddress);
+    void _disasmBranch(TRAVERSAL *pTraversal,qint64 nInitAddress,qint64 nAddress);
+    void _disasmRoot(qint64 nAddress);
+    void _disasmRoots();
+    void _disasmRootWork();
+    void _disasmRootsWorker();
+    void _mergeTraversal(TRAVERSAL *pTraversal);
+    void _addSymbol(QVector<SYMBOL> *pListSymbols,qint64 nAddress,QString sName,SS ss);
+    void _addPESymbols(QVector<SYMBOL> *pListSymbols,XPE *pPE);
+    void _addELFSymbols(QVector<SYMBOL> *pListSymbols,XELF *pELF);
+    void _addMACHSymbols(QVector<SYMBOL> *pListSymbols,XMACH *pMACH);
+    QByteArray _readData(qint64 nOffset,qint64 nSize); // bounded by the size of the device
+    qint64 _getUncoveredRanges(QVector<RANGE> *pListRanges); // WC_CODE windows without records, returns the size
+    qint64 _addUncoveredRange(QVector<RANGE> *pListRanges,const ENTROPY_REGION *pRegion,qint64 nBegin,qint64 nEnd); // without the data ranges, returns the size
+    QVector<qint64> _getCodeRoots(); // listRoots without the roots inside of the data ranges
+    void _prologuesWorker();
+    static bool _isPrologue(const quint8 *pData,qint64 nDataSize,cs_mode csmode); // a pattern of the mode
+    static bool _checkPrologue(csh handle,const quint8 *pData,qint64 nDataSize,qint64 nAddress); // decodes the first instructions
+    void _disasmRange(qint64 nAddress,qint64 nSize); // every address of the range that is not covered yet is a root
+    void _removeRange(qint64 nAddress,qint64 nSize); // the instructions of the range and their xrefs, the range becomes a data range
+    void _removeDataRanges(qint64 nAddress,qint64 nSize);
+    bool _isDataRange(qint64 nAddress);
+    void _extendRange(qint64 *pnStart,qint64 *pnEnd); // to the records and the view blocks that cross the ends
+    void _addDataBlocks(qint64 nAddress,qint64 nSize);
+    void _adjust();
+    void _adjustRange(qint64 nAddress,qint64 nSize); // the labels of the range and of stChangedTargets, the view blocks of the range
+    void _updatePositions(qint64 nAddress=-1); // from the address, -1 - the whole image
+    void _updateXrefs();
+    void _updateCFG();
+    void _updateEntropy();
+    void _updateStrings();
+    void _updateSymbols(XBinary::FT ft);
+    void _updatePrologues();
+    void _updateLabels();
+    void _updateLabels(qint64 nAddress,qint64 nSize); // the labels outside of the range stay
+    void _updateTargetLabels(); // stChangedTargets
+    void _removeStringRecords();
+    void _addStringRecords();
+    bool _insertOpcode(qint64 nAddress,RECORD *pOpcode);
+    static bool _labelLessThan(const LABEL &label1,const LABEL &label2);
+    static bool _symbolLessThan(const SYMBOL &symbol1,const SYMBOL &symbol2);
+    static bool _xrefLessThan(const XREF &xref1,const XREF &xref2);
+    static bool _xrefEqual(const XREF &xref1,const XREF &xref2);
+    static bool _xrefReverseLessThan(const XREF &xref1,const XREF &xref2);
+    static void _patchXrefIndex(XREF_INDEX *pIndex,QVector<XREF> *pListRemove,QVector<XREF> *pListInsert,bool bReverse); // the lists are sorted in the order of the index
+    static const qint64 *_getRefs(XREF_INDEX *pIndex,qint64 nAddress,qint32 *pnCount);
+    static qint32 _findBlockStart(CFG *pCFG,qint64 nAddress);
+    static bool _entropyRegionLessThan(const ENTROPY_REGION &region1,const ENTROPY_REGION &region2);
+    static WINDOW _getWindow(const char *pData,qint32 nSize,const double *pdLogTable,quint32 *pHistogram);
+    static const qint32 *_getRow(QVector<qint32> *pListOffsets,QVector<qint32> *pListValues,qint32 nIndex,qint32 *pnCount);
+    bool _openHandle();
+    void _checkLimits(); // tests the limits every 0x1000 calls
+    void _testLimits();
+    void _beginPhase(PHASE phase);
+    void _endPhase();
+    void _publishProgress();
+
+signals:
+    void errorMessage(QString sText);
+    void processFinished();
+
+private:
+    DM dm;
+    csh disasm_handle;
+    cs_arch csarchHandle;
+    cs_mode csmodeHandle;
+    bool bStop;
+    QElapsedTimer timer;
+    qint32 nLimitCounter;
+    PHASE currentPhase;
+    QElapsedTimer timerPhase;
+    qint64 nTraceStart; // -1 if the tracer is disabled
+    PHASE_STAT *pPhaseStat; // 0 if the instrumentation is disabled
+    QIODevice *pDevice;
+    OPTIONS *pOptions;
+    qint64 nStartAddress;
+    qint64 nRangeSize;
+    qint64 nChangedStart; // the records inserted by the run, -1 if there are none
+    qint64 nChangedEnd;
+    QSet<qint64> stChangedTargets; // the targets of the xrefs that an incremental run has removed or inserted
+    QVector<qint64> listRootWork; // _disasmRootsWorker
+    QAtomicInt nCurrentRoot;
+    QVector<PROLOGUE_CHUNK> listPrologueChunks; // _prologuesWorker
+    QAtomicInt nCurrentChunk;
+    QVector<qint64> listPrologues;
+    qint64 nPrologueCandidates;
+    QString sFileName; // the workers open their own file if the device is a file
+    QMutex mutexTraversal;
+    QMutex mutexDevice;
+    PROGRESS progress;
+    QMutex mutexProgress;
+};
+
+#endif // XDISASM_H
@@ -0,0 +1,308 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "xdisasmbatch.h"
+
+XDisasmBatch::XDisasmBatch(QObject *pParent) : QObject(pParent)
+{
+    pOptions=0;
+    pOutput=0;
+    bStop=false;
+    result={};
+}
+
+void XDisasmBatch::setData(XDisasmBatch::OPTIONS *pOptions, QIODevice *pOutput)
+{
+    this->pOptions=pOptions;
+    this->pOutput=pOutput;
+}
+
+void XDisasmBatch::stop()
+{
+    QMutexLocker locker(&mutex);
+
+    bStop=true;
+
+    QSetIterator<XDisasm *> iDisasm(stActive);
+    while(iDisasm.hasNext())
+    {
+        iDisasm.next()->stop();
+    }
+}
+
+XDisasmBatch::RESULT XDisasmBatch::getResult()
+{
+    QMutexLocker locker(&mutex);
+
+    return result;
+}
+
+QList<QString> XDisasmBatch::getFileNames(QList<QString> listPaths)
+{
+    QList<QString> listResult;
+
+    int nCount=listPaths.count();
+
+    for(int i=0;i<nCount;i++)
+    {
+        QString sPath=listPaths.at(i);
+
+        if(sPath.startsWith("@"))
+        {
+            // List file: one file name per line
+            QFile file;
+            file.setFileName(sPath.mid(1));
+
+            if(file.open(QIODevice::ReadOnly|QIODevice::Text))
+            {
+                QTextStream stream(&file);
+
+                while(!stream.atEnd())
+                {
+                    QString sFileName=stream.readLine().trimmed();
+
+                    if(sFileName!="")
+                    {
+                        listResult.append(sFileName);
+                    }
+                }
+
+                file.close();
+            }
+        }
+        else if(QFileInfo(sPath).isDir())
+        {
+            QDirIterator it(sPath,QDir::Files|QDir::Hidden|QDir::NoSymLinks,QDirIterator::Subdirectories);
+
+            while(it.hasNext())
+            {
+                listResult.append(it.next());
+            }
+        }
+        else
+        {
+            listResult.append(sPath);
+        }
+    }
+
+    return listResult;
+}
+
+QString XDisasmBatch::statusToString(XDisasmBatch::STATUS status)
+{
+    QString sResult="unknown";
+
+    switch(status)
+    {
+        case STATUS_UNKNOWN:        sResult="unknown";          break;
+        case STATUS_OK:             sResult="ok";               break;
+        case STATUS_ERROR:          sResult="error";            break;
+        case STATUS_TIMELIMIT:      sResult="timelimit";        break;
+        case STATUS_MEMORYLIMIT:    sResult="memorylimit";      break;
+    }
+
+    return sResult;
+}
+
+QJsonObject XDisasmBatch::recordToJson(XDisasmBatch::RECORD *pRecord)
+{
+    QJsonObject result;
+
+    result.insert("file",pRecord->sFileName);
+    result.insert("size",pRecord->nFileSize);
+    result.insert("arch",pRecord->sArch);
+    result.insert("status",statusToString(pRecord->status));
+    result.insert("truncated",pRecord->bTruncated);
+    result.insert("instructions",pRecord->nInstructions);
+    result.insert("functions",pRecord->nFunctions);
+    result.insert("xrefs",pRecord->nXrefs);
+    result.insert("labels",pRecord->nLabels);
+    result.insert("memory",pRecord->nMemory);
+    result.insert("time",pRecord->nTime);
+
+    return result;
+}
+
+QJsonObject XDisasmBatch::resultToJson(XDisasmBatch::RESULT *pResult)
+{
+    QJsonObject result;
+
+    double dSeconds=qMax(pResult->nTime,(qint64)1)/1000.0;
+
+    result.insert("files",pResult->nFiles);
+    result.insert("errors",pResult->nErrors);
+    result.insert("bytes",pResult->nBytes);
+    result.insert("instructions",pResult->nInstructions);
+    result.insert("peak_memory",pResult->nPeakMemory);
+    result.insert("time",pResult->nTime);
+    result.insert("files_per_second",pResult->nFiles/dSeconds);
+    result.insert("mbytes_per_second",(pResult->nBytes/(1024.0*1024.0))/dSeconds);
+    result.insert("instructions_per_second",pResult->nInstructions/dSeconds);
+
+    QJsonObject summary;
+    summary.insert("summary",result);
+
+    return summary;
+}
+
+void XDisasmBatch::process()
+{
+    bStop=false;
+    result={};
+    nCurrentIndex=0;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    int nThreads=pOptions->nThreads;
+
+    if(nThreads<=0)
+    {
+        nThreads=QThread::idealThreadCount();
+    }
+
+    nThreads=qMin(nThreads,qMax(pOptions->listFileNames.count(),1));
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(nThreads);
+
+    for(int i=0;i<nThreads;i++)
+    {
+        QtConcurrent::run(&threadPool,this,&XDisasmBatch::_worker);
+    }
+
+    threadPool.waitForDone();
+
+    mutex.lock();
+    result.nTime=timer.elapsed();
+    result.nPeakMemory=XDisasm::getPeakMemoryUsage();
+    mutex.unlock();
+
+    emit processFinished();
+}
+
+void XDisasmBatch::_worker()
+{
+    // One engine per thread: the decoder handle is reused for the next files
+    XDisasm disasm;
+
+    mutex.lock();
+    stActive.insert(&disasm);
+    mutex.unlock();
+
+    int nCount=pOptions->listFileNames.count();
+
+    while(!bStop)
+    {
+        int nIndex=nCurrentIndex.fetchAndAddOrdered(1);
+
+        if(nIndex>=nCount)
+        {
+            break;
+        }
+
+        RECORD record={};
+
+        _analyzeFile(&disasm,pOptions->listFileNames.at(nIndex),&record);
+        _writeRecord(&record);
+    }
+
+    mutex.lock();
+    stActive.remove(&disasm);
+    mutex.unlock();
+}
+
+void XDisasmBatch::_analyzeFile(XDisasm *pDisasm, QString sFileName, XDisasmBatch::RECORD *pRecord)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    pRecord->sFileName=sFileName;
+    pRecord->status=STATUS_ERROR;
+
+    QFile file;
+    file.setFileName(sFileName);
+
+    if(file.open(QIODevice::ReadOnly))
+    {
+        pRecord->nFileSize=file.size();
+
+        XDisasm::OPTIONS options={};
+        options.ft=XBinary::FT_UNKNOWN;
+        options.nImageBase=-1;
+        options.nTimeLimit=pOptions->nTimeLimit;
+        options.nMemoryLimit=pOptions->nMemoryLimit;
+        options.nOpcodeLimit=pOptions->nOpcodeLimit;
+        options.nThreads=1; // the files are analyzed in parallel
+
+        pDisasm->setData(&file,&options,-1,XDisasm::DM_DISASM);
+        pDisasm->process();
+
+        if(options.stats.bInit)
+        {
+            if(options.stats.bTimeLimitReached)
+            {
+                pRecord->status=STATUS_TIMELIMIT;
+            }
+            else if(options.stats.bMemoryLimitReached)
+            {
+                pRecord->status=STATUS_MEMORYLIMIT;
+            }
+            else
+            {
+                pRecord->status=STATUS_OK;
+            }
+
+            pRecord->bTruncated=(options.stats.bTimeLimitReached||options.stats.bMemoryLimitReached);
+
+            pRecord->sArch=options.stats.memoryMap.sArch;
+            pRecord->nInstructions=options.stats.mapRecords.count()-options.stats.nStringRecords;
+            pRecord->nFunctions=options.stats.cfg.listFunctions.count();
+
+            pRecord->nXrefs=XDisasm::getXrefCount(&(options.stats));
+            pRecord->nLabels=options.stats.listLabels.count();
+            pRecord->nMemory=XDisasm::getMemoryEstimate(&(options.stats));
+        }
+
+        file.close();
+    }
+
+    pRecord->nTime=timer.elapsed();
+}
+
+void XDisasmBatch::_writeRecord(XDisasmBatch::RECORD *pRecord)
+{
+    QMutexLocker locker(&mutex);
+
+    result.nFiles++;
+    result.nBytes+=pRecord->nFileSize;
+    result.nInstructions+=pRecord->nInstructions;
+
+    if(pRecord->status!=STATUS_OK)
+    {
+        result.nErrors++;
+    }
+
+    if(pOutput)
+    {
+        pOutput->write(QJsonDocument(recordToJson(pRecord)).toJson(QJsonDocument::Compact));
+        pOutput->write("\n");
+    }
+}
@@ -0,0 +1,112 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef XDISASMBATCH_H
+#define XDISASMBATCH_H
+
+#include <QObject>
+#include <QMutex>
+#include <QThreadPool>
+#include <QDirIterator>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QtConcurrent>
+#include "xdisasm.h"
+
+class XDisasmBatch : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum STATUS
+    {
+        STATUS_UNKNOWN=0,
+        STATUS_OK,
+        STATUS_ERROR,
+        STATUS_TIMELIMIT,
+        STATUS_MEMORYLIMIT
+    };
+
+    struct OPTIONS
+    {
+        QList<QString> listFileNames;
+        qint32 nThreads; // 0 - QThread::idealThreadCount()
+        qint64 nTimeLimit; // msec per file, 0 - no limit
+        qint64 nMemoryLimit; // bytes per file, 0 - no limit
+        qint64 nOpcodeLimit; // 0 - XDisasm::N_OPCODE_COUNT, -1 - no limit
+    };
+
+    struct RECORD
+    {
+        QString sFileName;
+        qint64 nFileSize;
+        QString sArch;
+        STATUS status;
+        bool bTruncated; // a limit ended the analysis, the counts are of what has been found
+        qint64 nInstructions;
+        qint64 nFunctions;
+        qint64 nXrefs;
+        qint64 nLabels;
+        qint64 nMemory; // estimated size of STATS, bytes
+        qint64 nTime;
+    };
+
+    struct RESULT
+    {
+        qint64 nFiles;
+        qint64 nErrors;
+        qint64 nBytes;
+        qint64 nInstructions;
+        qint64 nPeakMemory; // RSS, bytes
+        qint64 nTime;
+    };
+
+    explicit XDisasmBatch(QObject *pParent=nullptr);
+    void setData(OPTIONS *pOptions,QIODevice *pOutput);
+    void stop();
+    RESULT getResult();
+    static QList<QString> getFileNames(QList<QString> listPaths);
+    static QString statusToString(STATUS status);
+    static QJsonObject recordToJson(RECORD *pRecord);
+    static QJsonObject resultToJson(RESULT *pResult);
+
+public slots:
+    void process();
+
+signals:
+    void errorMessage(QString sText);
+    void processFinished();
+
+private:
+    void _worker();
+    void _analyzeFile(XDisasm *pDisasm,QString sFileName,RECORD *pRecord);
+    void _writeRecord(RECORD *pRecord);
+
+private:
+    OPTIONS *pOptions;
+    QIODevice *pOutput;
+    QMutex mutex;
+    QSet<XDisasm *> stActive;
+    QAtomicInt nCurrentIndex;
+    bool bStop;
+    RESULT result;
+};
+
+#endif // XDISASMBATCH_H
@@ -0,0 +1,95 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "xdisasmbuttondelegate.h"
+
+XDisasmButtonDelegate::XDisasmButtonDelegate(QObject *pParent) : QStyledItemDelegate(pParent)
+{
+
+}
+
+void XDisasmButtonDelegate::paint(QPainter *pPainter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    if(index.flags()&Qt::ItemIsUserCheckable)
+    {
+        QStyleOptionButton optionButton;
+
+        optionButton.rect=option.rect;
+        optionButton.fontMetrics=option.fontMetrics;
+        optionButton.palette=option.palette;
+        optionButton.text=option.fontMetrics.elidedText(index.data(Qt::DisplayRole).toString(),Qt::ElideRight,option.rect.width()-2*option.fontMetrics.averageCharWidth());
+
+        if(index.flags()&Qt::ItemIsEnabled)
+        {
+            optionButton.state|=QStyle::State_Enabled;
+        }
+
+        if(index.data(Qt::CheckStateRole).toInt()==Qt::Checked)
+        {
+            optionButton.state|=QStyle::State_On|QStyle::State_Sunken;
+        }
+        else
+        {
+            optionButton.state|=QStyle::State_Off|QStyle::State_Raised;
+        }
+
+        QStyle *pStyle=option.widget?option.widget->style():QApplication::style();
+
+        pStyle->drawControl(QStyle::CE_PushButton,&optionButton,pPainter,option.widget);
+    }
+    else
+    {
+        QStyledItemDelegate::paint(pPainter,option,index);
+    }
+}
+
+bool XDisasmButtonDelegate::editorEvent(QEvent *pEvent, QAbstractItemModel *pModel, const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    bool bResult=false;
+
+    Qt::ItemFlags flags=index.flags();
+
+    if((flags&Qt::ItemIsUserCheckable)&&(flags&Qt::ItemIsEnabled))
+    {
+        if((pEvent->type()==QEvent::MouseButtonPress)||(pEvent->type()==QEvent::MouseButtonDblClick))
+        {
+            bResult=true;
+        }
+        else if(pEvent->type()==QEvent::MouseButtonRelease)
+        {
+            QMouseEvent *pMouseEvent=static_cast<QMouseEvent *>(pEvent);
+
+            if((pMouseEvent->button()==Qt::LeftButton)&&option.rect.contains(pMouseEvent->pos()))
+            {
+                Qt::CheckState state=(index.data(Qt::CheckStateRole).toInt()==Qt::Checked)?Qt::Unchecked:Qt::Checked;
+
+                pModel->setData(index,state,Qt::CheckStateRole);
+            }
+
+            bResult=true;
+        }
+    }
+    else
+    {
+        bResult=QStyledItemDelegate::editorEvent(pEvent,pModel,option,index);
+    }
+
+    return bResult;
+}
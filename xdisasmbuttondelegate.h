@@ -0,0 +1,39 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef XDISASMBUTTONDELEGATE_H
+#define XDISASMBUTTONDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QApplication>
+#include <QMouseEvent>
+
+// Paints the checkable cells as toggle buttons and toggles Qt::CheckStateRole on click, without a widget per cell.
+class XDisasmButtonDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit XDisasmButtonDelegate(QObject *pParent=nullptr);
+    void paint(QPainter *pPainter,const QStyleOptionViewItem &option,const QModelIndex &index) const override;
+    bool editorEvent(QEvent *pEvent,QAbstractItemModel *pModel,const QStyleOptionViewItem &option,const QModelIndex &index) override;
+};
+
+#endif // XDISASMBUTTONDELEGATE_H
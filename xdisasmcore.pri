@@ -0,0 +1,52 @@
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+QT += concurrent
+
+win32 {
+    LIBS += -lpsapi
+}
+
+SOURCES += \
+    $$PWD/xdisasm.cpp \
+    $$PWD/xdisasmbatch.cpp \
+    $$PWD/xdisasmexport.cpp \
+    $$PWD/xdisasmgenerator.cpp \
+    $$PWD/xdisasmlabelmodel.cpp \
+    $$PWD/xdisasmlisting.cpp \
+    $$PWD/xdisasmmodel.cpp \
+    $$PWD/xdisasmrowformatter.cpp \
+    $$PWD/xdisasmsearch.cpp \
+    $$PWD/xdisasmsignaturemodel.cpp \
+    $$PWD/xdisasmsignaturescanner.cpp \
+    $$PWD/xdisasmstringscanner.cpp \
+    $$PWD/xdisasmtextindex.cpp \
+    $$PWD/xdisasmtrace.cpp \
+    $$PWD/xdisasmxrefmodel.cpp
+
+HEADERS += \
+    $$PWD/xdisasm.h \
+    $$PWD/xdisasmbatch.h \
+    $$PWD/xdisasmexport.h \
+    $$PWD/xdisasmgenerator.h \
+    $$PWD/xdisasmlabelmodel.h \
+    $$PWD/xdisasmlisting.h \
+    $$PWD/xdisasmmodel.h \
+    $$PWD/xdisasmrowformatter.h \
+    $$PWD/xdisasmsearch.h \
+    $$PWD/xdisasmsignaturemodel.h \
+    $$PWD/xdisasmsignaturescanner.h \
+    $$PWD/xdisasmstringscanner.h \
+    $$PWD/xdisasmtextindex.h \
+    $$PWD/xdisasmtrace.h \
+    $$PWD/xdisasmxrefmodel.h
+
+!contains(XCONFIG, xcapstone) {
+    XCONFIG += xcapstone
+    include($$PWD/../XCapstone/xcapstone.pri)
+}
+
+!contains(XCONFIG, xformats) {
+    XCONFIG += xformats
+    include($$PWD/../Formats/xformats.pri)
+}
@@ -0,0 +1,437 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "xdisasmexport.h"
+
+bool XDisasmExport::exportReport(QIODevice *pDevice, XDisasm::STATS *pStats, QIODevice *pOutput, XDisasmExport::REPORT_OPTIONS *pOptions)
+{
+    XDISASM_TRACE("XDisasmExport::exportReport");
+
+    bool bResult=false;
+
+    if(pStats->bInit)
+    {
+        csh disasm_handle=0;
+
+        if(pOptions->bInstructions)
+        {
+            cs_err err=cs_open(pStats->csarch,pStats->csmode,&disasm_handle);
+
+            if(err)
+            {
+                disasm_handle=0;
+            }
+        }
+
+        QTextStream stream(pOutput);
+
+        if(pOptions->reportType==RT_JSON)
+        {
+            _writeJson(pDevice,pStats,disasm_handle,&stream,pOptions);
+        }
+        else
+        {
+            _writeText(pDevice,pStats,disasm_handle,&stream,pOptions);
+        }
+
+        stream.flush();
+
+        if(disasm_handle)
+        {
+            cs_close(&disasm_handle);
+        }
+
+        bResult=(stream.status()==QTextStream::Ok);
+    }
+
+    return bResult;
+}
+
+QList<qint64> XDisasmExport::getFunctionAddresses(XDisasm::STATS *pStats)
+{
+    QList<qint64> listResult;
+
+    int nCount=pStats->cfg.listFunctions.count();
+
+    listResult.reserve(nCount);
+
+    for(int i=0;i<nCount;i++)
+    {
+        listResult.append(pStats->cfg.listFunctions.at(i).nAddress);
+    }
+
+    return listResult;
+}
+
+QString XDisasmExport::addressToString(qint64 nAddress)
+{
+    return QString("0x%1").arg(nAddress,0,16);
+}
+
+QJsonArray XDisasmExport::phaseStatsToJson(XDisasm::STATS *pStats)
+{
+    QJsonArray result;
+
+    for(int i=0;i<XDisasm::__PHASE_SIZE;i++)
+    {
+        XDisasm::PHASE_STAT *pStat=&(pStats->phaseStat[i]);
+
+        QJsonObject record;
+
+        record.insert("phase",XDisasm::phaseIdToString((XDisasm::PHASE)i));
+        record.insert("count",pStat->nCount);
+        record.insert("time_ns",pStat->nTime);
+        record.insert("instructions",pStat->nInstructions);
+        record.insert("bytes_read",pStat->nBytesRead);
+        record.insert("decoder_calls",pStat->nDecoderCalls);
+        record.insert("container_size",pStat->nContainerSize);
+
+        if(i==XDisasm::PHASE_PROLOGUES)
+        {
+            // Coverage of the WC_CODE windows
+            record.insert("uncovered_size",pStats->prologues.nUncoveredSize);
+            record.insert("remaining_size",pStats->prologues.nRemainingSize);
+            record.insert("candidates",pStats->prologues.nCandidates);
+            record.insert("confirmed",pStats->prologues.nConfirmed);
+        }
+
+        result.append(record);
+    }
+
+    return result;
+}
+
+QJsonObject XDisasmExport::memoryToJson(XDisasm::STATS *pStats)
+{
+    QJsonObject result;
+
+    QJsonArray jsonContainers;
+
+    QList<XDisasm::MEMORY_RECORD> listRecords=XDisasm::getMemoryRecords(pStats);
+
+    qint64 nTotal=0;
+
+    int nCount=listRecords.count();
+
+    for(int i=0;i<nCount;i++)
+    {
+        QJsonObject record;
+
+        record.insert("name",listRecords.at(i).sName);
+        record.insert("count",listRecords.at(i).nCount);
+        record.insert("size",listRecords.at(i).nSize);
+
+        jsonContainers.append(record);
+
+        nTotal+=listRecords.at(i).nSize;
+    }
+
+    result.insert("containers",jsonContainers);
+    result.insert("total",nTotal);
+    result.insert("peak_rss",XDisasm::getPeakMemoryUsage());
+
+    return result;
+}
+
+void XDisasmExport::_writeText(QIODevice *pDevice, XDisasm::STATS *pStats, csh disasm_handle, QTextStream *pStream, XDisasmExport::REPORT_OPTIONS *pOptions)
+{
+    (*pStream)<<QString("File: %1").arg(pOptions->sFileName)<<endl;
+    (*pStream)<<QString("Architecture: %1").arg(pStats->memoryMap.sArch)<<endl;
+    (*pStream)<<QString("Image base: %1").arg(addressToString(pStats->nImageBase))<<endl;
+    (*pStream)<<QString("Image size: %1").arg(addressToString(pStats->nImageSize))<<endl;
+    (*pStream)<<QString("Entry point: %1").arg(addressToString(pStats->nEntryPointAddress))<<endl;
+
+    if(pOptions->bInstructions)
+    {
+        QByteArray baData;
+        XDisasmRowFormatter formatter;
+
+        (*pStream)<<endl<<QString("[Instructions] %1").arg(pStats->mapRecords.count()-pStats->nStringRecords)<<endl;
+
+        QMapIterator<qint64,XDisasm::RECORD> iRecords(pStats->mapRecords);
+        while(iRecords.hasNext())
+        {
+            iRecords.next();
+
+            XDisasm::RECORD record=iRecords.value();
+
+            if(record.type==XDisasm::RECORD_TYPE_OPCODE)
+            {
+                QString sOpcode=_getOpcodeString(pDevice,disasm_handle,iRecords.key(),&record,&baData);
+
+                (*pStream)<<"0x"<<formatter.valueToString(iRecords.key(),0)<<" "<<formatter.bytesToString(baData.constData(),baData.size())<<" "<<sOpcode<<endl;
+            }
+        }
+    }
+
+    if(pOptions->bFunctions)
+    {
+        int nCount=pStats->cfg.listFunctions.count();
+
+        (*pStream)<<endl<<QString("[Functions] %1").arg(nCount)<<endl;
+
+        for(int i=0;i<nCount;i++)
+        {
+            const XDisasm::FUNCTION *pFunction=&(pStats->cfg.listFunctions.at(i));
+
+            (*pStream)<<addressToString(pFunction->nAddress)<<" "<<XDisasm::getLabelString(pStats,pFunction->nAddress)
+                      <<QString(" size=%1 blocks=%2 instructions=%3 callees=%4")
+                        .arg(pFunction->nSize)
+                        .arg(pFunction->nBlockCount)
+                        .arg(pFunction->nInstructions)
+                        .arg(pFunction->nCalleeCount)<<endl;
+        }
+    }
+
+    if(pOptions->bXrefs)
+    {
+        (*pStream)<<endl<<QString("[Xrefs] %1").arg(XDisasm::getXrefCount(pStats))<<endl;
+
+        int nNumberOfKeys=pStats->refTo.listKeys.count();
+
+        for(int i=0;i<nNumberOfKeys;i++)
+        {
+            qint64 nFrom=pStats->refTo.listKeys.at(i);
+            qint32 nEnd=pStats->refTo.listOffsets.at(i+1);
+
+            for(qint32 j=pStats->refTo.listOffsets.at(i);j<nEnd;j++)
+            {
+                (*pStream)<<addressToString(nFrom)<<" -> "<<addressToString(pStats->refTo.listValues.at(j))<<endl;
+            }
+        }
+    }
+
+    if(pOptions->bLabels)
+    {
+        int nCount=pStats->listLabels.count();
+
+        (*pStream)<<endl<<QString("[Labels] %1").arg(nCount)<<endl;
+
+        for(int i=0;i<nCount;i++)
+        {
+            const XDisasm::LABEL *pLabel=&(pStats->listLabels.at(i));
+
+            (*pStream)<<addressToString(pLabel->nAddress)<<" "<<XDisasm::labelToString(pStats,pLabel)<<endl;
+        }
+    }
+
+    if(pOptions->bMemory)
+    {
+        QList<XDisasm::MEMORY_RECORD> listRecords=XDisasm::getMemoryRecords(pStats);
+
+        int nCount=listRecords.count();
+
+        (*pStream)<<endl<<QString("[Memory] %1").arg(nCount)<<endl;
+
+        qint64 nTotal=0;
+
+        for(int i=0;i<nCount;i++)
+        {
+            (*pStream)<<QString("%1 %2 entries %3 bytes").arg(listRecords.at(i).sName).arg(listRecords.at(i).nCount).arg(listRecords.at(i).nSize)<<endl;
+
+            nTotal+=listRecords.at(i).nSize;
+        }
+
+        (*pStream)<<QString("Total: %1 bytes").arg(nTotal)<<endl;
+        (*pStream)<<QString("Peak RSS: %1 bytes").arg(XDisasm::getPeakMemoryUsage())<<endl;
+    }
+}
+
+void XDisasmExport::_writeJson(QIODevice *pDevice, XDisasm::STATS *pStats, csh disasm_handle, QTextStream *pStream, XDisasmExport::REPORT_OPTIONS *pOptions)
+{
+    // Written as a stream: a QJsonDocument of a large image does not fit in memory
+    (*pStream)<<"{"<<endl;
+    (*pStream)<<QString("\"file\":\"%1\",").arg(_escapeJson(pOptions->sFileName))<<endl;
+    (*pStream)<<QString("\"arch\":\"%1\",").arg(_escapeJson(pStats->memoryMap.sArch))<<endl;
+    (*pStream)<<QString("\"imagebase\":\"%1\",").arg(addressToString(pStats->nImageBase))<<endl;
+    (*pStream)<<QString("\"imagesize\":\"%1\",").arg(addressToString(pStats->nImageSize))<<endl;
+    (*pStream)<<QString("\"entrypoint\":\"%1\"").arg(addressToString(pStats->nEntryPointAddress));
+
+    if(pOptions->bInstructions)
+    {
+        QByteArray baData;
+        XDisasmRowFormatter formatter;
+        bool bFirst=true;
+
+        (*pStream)<<","<<endl<<"\"instructions\":["<<endl;
+
+        QMapIterator<qint64,XDisasm::RECORD> iRecords(pStats->mapRecords);
+        while(iRecords.hasNext())
+        {
+            iRecords.next();
+
+            XDisasm::RECORD record=iRecords.value();
+
+            if(record.type==XDisasm::RECORD_TYPE_OPCODE)
+            {
+                QString sOpcode=_getOpcodeString(pDevice,disasm_handle,iRecords.key(),&record,&baData);
+
+                if(!bFirst)
+                {
+                    (*pStream)<<","<<endl;
+                }
+
+                (*pStream)<<QString("{\"address\":\"%1\",\"size\":%2,\"bytes\":\"%3\",\"opcode\":\"%4\"}")
+                            .arg("0x"+formatter.valueToString(iRecords.key(),0))
+                            .arg(record.nSize)
+                            .arg(formatter.bytesToString(baData.constData(),baData.size()))
+                            .arg(_escapeJson(sOpcode));
+
+                bFirst=false;
+            }
+        }
+
+        (*pStream)<<endl<<"]";
+    }
+
+    if(pOptions->bFunctions)
+    {
+        int nCount=pStats->cfg.listFunctions.count();
+
+        (*pStream)<<","<<endl<<"\"functions\":["<<endl;
+
+        for(int i=0;i<nCount;i++)
+        {
+            const XDisasm::FUNCTION *pFunction=&(pStats->cfg.listFunctions.at(i));
+
+            if(i)
+            {
+                (*pStream)<<","<<endl;
+            }
+
+            (*pStream)<<QString("{\"address\":\"%1\",\"name\":\"%2\",\"size\":%3,\"blocks\":%4,\"instructions\":%5,\"callees\":%6}")
+                        .arg(addressToString(pFunction->nAddress))
+                        .arg(_escapeJson(XDisasm::getLabelString(pStats,pFunction->nAddress)))
+                        .arg(pFunction->nSize)
+                        .arg(pFunction->nBlockCount)
+                        .arg(pFunction->nInstructions)
+                        .arg(pFunction->nCalleeCount);
+        }
+
+        (*pStream)<<endl<<"]";
+    }
+
+    if(pOptions->bXrefs)
+    {
+        bool bFirst=true;
+
+        (*pStream)<<","<<endl<<"\"xrefs\":["<<endl;
+
+        int nNumberOfKeys=pStats->refTo.listKeys.count();
+
+        for(int i=0;i<nNumberOfKeys;i++)
+        {
+            qint64 nFrom=pStats->refTo.listKeys.at(i);
+            qint32 nEnd=pStats->refTo.listOffsets.at(i+1);
+
+            for(qint32 j=pStats->refTo.listOffsets.at(i);j<nEnd;j++)
+            {
+                if(!bFirst)
+                {
+                    (*pStream)<<","<<endl;
+                }
+
+                (*pStream)<<QString("{\"from\":\"%1\",\"to\":\"%2\"}").arg(addressToString(nFrom)).arg(addressToString(pStats->refTo.listValues.at(j)));
+
+                bFirst=false;
+            }
+        }
+
+        (*pStream)<<endl<<"]";
+    }
+
+    if(pOptions->bLabels)
+    {
+        (*pStream)<<","<<endl<<"\"labels\":["<<endl;
+
+        int nCount=pStats->listLabels.count();
+
+        for(int i=0;i<nCount;i++)
+        {
+            const XDisasm::LABEL *pLabel=&(pStats->listLabels.at(i));
+
+            if(i)
+            {
+                (*pStream)<<","<<endl;
+            }
+
+            (*pStream)<<QString("{\"address\":\"%1\",\"name\":\"%2\"}").arg(addressToString(pLabel->nAddress)).arg(_escapeJson(XDisasm::labelToString(pStats,pLabel)));
+        }
+
+        (*pStream)<<endl<<"]";
+    }
+
+    if(pOptions->bMemory)
+    {
+        (*pStream)<<","<<endl<<"\"memory\":"<<QJsonDocument(memoryToJson(pStats)).toJson(QJsonDocument::Compact);
+    }
+
+    (*pStream)<<endl<<"}"<<endl;
+}
+
+QString XDisasmExport::_getOpcodeString(QIODevice *pDevice, csh disasm_handle, qint64 nAddress, XDisasm::RECORD *pRecord, QByteArray *pBaData)
+{
+    QString sResult;
+
+    pBaData->clear();
+
+    if(pDevice->seek(pRecord->nOffset))
+    {
+        *pBaData=pDevice->read(pRecord->nSize);
+    }
+
+    if(disasm_handle&&pBaData->size())
+    {
+        sResult=XDisasm::getDisasmString(disasm_handle,nAddress,pBaData->data(),pBaData->size());
+    }
+
+    return sResult;
+}
+
+QString XDisasmExport::_escapeJson(QString sString)
+{
+    QString sResult;
+
+    int nSize=sString.size();
+
+    for(int i=0;i<nSize;i++)
+    {
+        QChar c=sString.at(i);
+
+        if(c==QChar('"'))
+        {
+            sResult+="\\\"";
+        }
+        else if(c==QChar('\\'))
+        {
+            sResult+="\\\\";
+        }
+        else if(c.unicode()<0x20)
+        {
+            sResult+=QString("\\u%1").arg(c.unicode(),4,16,QChar('0'));
+        }
+        else
+        {
+            sResult+=c;
+        }
+    }
+
+    return sResult;
+}
@@ -0,0 +1,65 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef XDISASMEXPORT_H
+#define XDISASMEXPORT_H
+
+#include <QTextStream>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <algorithm>
+#include "xdisasm.h"
+#include "xdisasmrowformatter.h"
+
+class XDisasmExport
+{
+public:
+    enum RT
+    {
+        RT_TEXT=0,
+        RT_JSON
+    };
+
+    struct REPORT_OPTIONS
+    {
+        RT reportType;
+        QString sFileName;
+        bool bInstructions;
+        bool bFunctions;
+        bool bXrefs;
+        bool bLabels;
+        bool bMemory;
+    };
+
+    static bool exportReport(QIODevice *pDevice,XDisasm::STATS *pStats,QIODevice *pOutput,REPORT_OPTIONS *pOptions);
+    static QList<qint64> getFunctionAddresses(XDisasm::STATS *pStats);
+    static QString addressToString(qint64 nAddress);
+    static QJsonArray phaseStatsToJson(XDisasm::STATS *pStats);
+    static QJsonObject memoryToJson(XDisasm::STATS *pStats);
+
+private:
+    static void _writeText(QIODevice *pDevice,XDisasm::STATS *pStats,csh disasm_handle,QTextStream *pStream,REPORT_OPTIONS *pOptions);
+    static void _writeJson(QIODevice *pDevice,XDisasm::STATS *pStats,csh disasm_handle,QTextStream *pStream,REPORT_OPTIONS *pOptions);
+    static QString _getOpcodeString(QIODevice *pDevice,csh disasm_handle,qint64 nAddress,XDisasm::RECORD *pRecord,QByteArray *pBaData);
+    static QString _escapeJson(QString sString);
+};
+
+#endif // XDISASMEXPORT_H
@@ -0,0 +1,445 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "xdisasmgenerator.h"
+
+bool XDisasmGenerator::isLayoutValid(XDisasmGenerator::OPTIONS *pOptions)
+{
+    bool bResult=true;
+
+    if((pOptions->fileType==XBinary::FT_PE32)||(pOptions->fileType==XBinary::FT_PE64))
+    {
+        LAYOUT layout=_getLayout(pOptions);
+
+        // SizeOfImage, VirtualSize and the RVAs are 32-bit, PE32 addresses too
+        qint64 nMaxSize=layout.b64?(0xFFFFFFFFLL):(0xFFFFFFFFLL-layout.nImageBase);
+
+        bResult=(layout.nImageSize<=nMaxSize);
+    }
+
+    return bResult;
+}
+
+bool XDisasmGenerator::generate(XDisasmGenerator::OPTIONS *pOptions, QIODevice *pDevice, XDisasmGenerator::RESULT *pResult)
+{
+    bool bResult=isLayoutValid(pOptions);
+
+    LAYOUT layout=_getLayout(pOptions);
+
+    QByteArray baHeader;
+
+    if((pOptions->fileType==XBinary::FT_PE32)||(pOptions->fileType==XBinary::FT_PE64))
+    {
+        baHeader=_getPEHeader(&layout);
+    }
+    else if(pOptions->fileType==XBinary::FT_ELF64)
+    {
+        baHeader=_getELFHeader(&layout);
+    }
+
+    if(bResult&&baHeader.size())
+    {
+        bResult=(pDevice->write(baHeader)==baHeader.size());
+    }
+
+    QByteArray baBuffer;
+    baBuffer.resize(N_BUFFER_SIZE+layout.nStride);
+
+    char *pBuffer=baBuffer.data();
+    qint64 nBufferSize=0;
+    quint32 nState=pOptions->nSeed;
+
+    for(qint64 i=0;(i<layout.nFunctions)&&bResult;i++)
+    {
+        nBufferSize+=_writeFunction(pBuffer+nBufferSize,&layout,pOptions,i);
+
+        if(layout.nDataSize)
+        {
+            if(pOptions->bSparse)
+            {
+                // Leave a hole: multi-GB images do not take disk space
+                bResult=(pDevice->write(pBuffer,nBufferSize)==nBufferSize);
+                bResult=bResult&&pDevice->seek(pDevice->pos()+layout.nDataSize);
+
+                nBufferSize=0;
+            }
+            else
+            {
+                _writeData(pBuffer+nBufferSize,layout.nDataSize,&nState);
+
+                nBufferSize+=layout.nDataSize;
+            }
+        }
+
+        if(bResult&&((nBufferSize>=N_BUFFER_SIZE)||(i==(layout.nFunctions-1))))
+        {
+            bResult=(pDevice->write(pBuffer,nBufferSize)==nBufferSize);
+
+            nBufferSize=0;
+        }
+    }
+
+    if(bResult)
+    {
+        qint64 nFileSize=layout.nHeaderSize+layout.nCodeSize;
+
+        if((pOptions->fileType==XBinary::FT_PE32)||(pOptions->fileType==XBinary::FT_PE64))
+        {
+            // SizeOfRawData is aligned to FileAlignment
+            nFileSize=layout.nHeaderSize+_align(layout.nCodeSize,0x200);
+        }
+
+        if(pDevice->pos()<nFileSize)
+        {
+            bResult=pDevice->seek(nFileSize-1)&&(pDevice->write("\0",1)==1);
+        }
+    }
+
+    *pResult={};
+
+    pResult->nFileSize=pDevice->pos();
+    pResult->nImageSize=layout.nImageSize;
+    pResult->nEntryPointAddress=layout.nCodeAddress;
+    pResult->nFunctions=layout.nFunctions;
+    pResult->nFunctionSize=layout.nStride;
+    // push, mov, body, 2 call slots, jz/mov pairs, pop, ret
+    pResult->nInstructions=layout.nFunctions*(pOptions->nBodyCount+6+2*layout.nJumpCount);
+    pResult->nCalls=layout.nFunctions-1;
+    pResult->nJumps=layout.nFunctions*layout.nJumpCount;
+    pResult->nReferences=pResult->nCalls+pResult->nJumps;
+
+    return bResult;
+}
+
+bool XDisasmGenerator::generate(XDisasmGenerator::OPTIONS *pOptions, QString sFileName, XDisasmGenerator::RESULT *pResult)
+{
+    bool bResult=false;
+
+    QFile file;
+    file.setFileName(sFileName);
+
+    if(file.open(QIODevice::WriteOnly|QIODevice::Truncate))
+    {
+        bResult=generate(pOptions,&file,pResult);
+
+        file.close();
+    }
+
+    return bResult;
+}
+
+QJsonObject XDisasmGenerator::resultToJson(XDisasmGenerator::RESULT *pResult)
+{
+    QJsonObject result;
+
+    result.insert("file_size",pResult->nFileSize);
+    result.insert("image_size",pResult->nImageSize);
+    result.insert("entry_point",QString("0x%1").arg(pResult->nEntryPointAddress,0,16));
+    result.insert("functions",pResult->nFunctions);
+    result.insert("function_size",pResult->nFunctionSize);
+    result.insert("instructions",pResult->nInstructions);
+    result.insert("calls",pResult->nCalls);
+    result.insert("jumps",pResult->nJumps);
+    result.insert("references",pResult->nReferences);
+
+    return result;
+}
+
+XDisasmGenerator::LAYOUT XDisasmGenerator::_getLayout(XDisasmGenerator::OPTIONS *pOptions)
+{
+    LAYOUT result={};
+
+    XBinary::FT fileType=pOptions->fileType;
+
+    result.b64=(fileType==XBinary::FT_PE64)||(fileType==XBinary::FT_ELF64)||(fileType==XBinary::FT_BINARY64);
+
+    if((fileType==XBinary::FT_PE32)||(fileType==XBinary::FT_PE64))
+    {
+        result.nImageBase=result.b64?0x140000000LL:0x400000;
+        result.nHeaderSize=0x400;
+        result.nCodeRelAddress=0x1000;
+        result.nVirtualSize=pOptions->nVirtualSize;
+    }
+    else if(fileType==XBinary::FT_ELF64)
+    {
+        result.nImageBase=0x400000;
+        result.nHeaderSize=0x1000;
+        result.nCodeRelAddress=0x1000;
+        result.nVirtualSize=pOptions->nVirtualSize;
+    }
+
+    result.nCodeAddress=result.nImageBase+result.nCodeRelAddress;
+
+    result.nJumpCount=qMin(qMax(pOptions->nJumpCount,0),(qint32)N_MAX_JUMPS);
+
+    qint32 nDataRatio=qMin(qMax(pOptions->nDataRatio,0),90);
+
+    qint64 nRawSize=1+(result.b64?3:2)+5*pOptions->nBodyCount+2*5+11*result.nJumpCount+2;
+
+    result.nFunctionSize=_align(nRawSize,16);
+    result.nPaddingSize=_align((result.nFunctionSize*qMax(pOptions->nPaddingRatio,0))/100,16);
+    result.nDataSize=_align(((result.nFunctionSize+result.nPaddingSize)*nDataRatio)/(100-nDataRatio),16);
+    result.nStride=result.nFunctionSize+result.nPaddingSize+result.nDataSize;
+    result.nFunctions=qMax(pOptions->nSize/result.nStride,(qint64)1);
+    result.nCodeSize=result.nFunctions*result.nStride;
+    result.nVirtualRelAddress=_align(result.nCodeRelAddress+result.nCodeSize,0x1000);
+
+    if(result.nHeaderSize)
+    {
+        result.nImageSize=result.nVirtualRelAddress+_align(result.nVirtualSize,0x1000);
+    }
+    else
+    {
+        result.nImageSize=result.nCodeSize;
+    }
+
+    return result;
+}
+
+qint32 XDisasmGenerator::_writeFunction(char *pBuffer, XDisasmGenerator::LAYOUT *pLayout, XDisasmGenerator::OPTIONS *pOptions, qint64 nIndex)
+{
+    // Every function has the same size, so call targets are known in advance
+    quint8 *pData=(quint8 *)pBuffer;
+    qint64 nAddress=pLayout->nCodeAddress+nIndex*pLayout->nStride;
+    qint32 nSize=0;
+
+    pData[nSize++]=0x55; // push ebp
+
+    if(pLayout->b64)
+    {
+        pData[nSize++]=0x48;
+    }
+
+    pData[nSize++]=0x89; // mov ebp,esp
+    pData[nSize++]=0xE5;
+
+    for(qint32 i=0;i<pOptions->nBodyCount;i++)
+    {
+        pData[nSize++]=0xB8; // mov eax,imm32
+        qToLittleEndian<quint32>((quint32)(nIndex+i),pData+nSize);
+        nSize+=4;
+    }
+
+    for(qint32 i=1;i<=2;i++)
+    {
+        qint64 nChild=2*nIndex+i;
+
+        if(nChild<pLayout->nFunctions)
+        {
+            qint64 nTarget=pLayout->nCodeAddress+nChild*pLayout->nStride;
+
+            pData[nSize++]=0xE8; // call rel32
+            qToLittleEndian<quint32>((quint32)(nTarget-(nAddress+nSize+4)),pData+nSize);
+        }
+        else
+        {
+            pData[nSize++]=0xB8; // mov eax,imm32
+            qToLittleEndian<quint32>((quint32)nChild,pData+nSize);
+        }
+
+        nSize+=4;
+    }
+
+    for(qint32 i=0;i<pLayout->nJumpCount;i++)
+    {
+        pData[nSize++]=0x0F; // jz +5
+        pData[nSize++]=0x84;
+        qToLittleEndian<quint32>(5,pData+nSize);
+        nSize+=4;
+
+        pData[nSize++]=0xB8; // mov eax,imm32
+        qToLittleEndian<quint32>((quint32)i,pData+nSize);
+        nSize+=4;
+    }
+
+    pData[nSize++]=0x5D; // pop ebp
+    pData[nSize++]=0xC3; // ret
+
+    while(nSize<(pLayout->nFunctionSize+pLayout->nPaddingSize))
+    {
+        pData[nSize++]=0xCC; // int3
+    }
+
+    return nSize;
+}
+
+void XDisasmGenerator::_writeData(char *pBuffer, qint64 nSize, quint32 *pnState)
+{
+    for(qint64 i=0;i<nSize;i++)
+    {
+        *pnState=(*pnState)*1103515245+12345;
+
+        pBuffer[i]=(char)((*pnState)>>16);
+    }
+}
+
+QByteArray XDisasmGenerator::_getPEHeader(XDisasmGenerator::LAYOUT *pLayout)
+{
+    QByteArray baResult(pLayout->nHeaderSize,0);
+
+    bool b64=pLayout->b64;
+
+    _write16(&baResult,0x00,0x5A4D); // MZ
+    _write32(&baResult,0x3C,0x40); // e_lfanew
+    _write32(&baResult,0x40,0x00004550); // PE
+
+    qint64 nFileHeader=0x44;
+    qint64 nOptionalHeaderSize=b64?0xF0:0xE0;
+
+    _write16(&baResult,nFileHeader+0,b64?0x8664:0x014C); // Machine
+    _write16(&baResult,nFileHeader+2,pLayout->nVirtualSize?2:1); // NumberOfSections
+    _write16(&baResult,nFileHeader+16,nOptionalHeaderSize);
+    _write16(&baResult,nFileHeader+18,b64?0x0022:0x0102); // Characteristics
+
+    qint64 nOptionalHeader=nFileHeader+20;
+    qint64 nRawSize=_align(pLayout->nCodeSize,0x200);
+
+    _write16(&baResult,nOptionalHeader+0,b64?0x020B:0x010B); // Magic
+    _write32(&baResult,nOptionalHeader+4,nRawSize); // SizeOfCode
+    _write32(&baResult,nOptionalHeader+12,pLayout->nVirtualSize); // SizeOfUninitializedData
+    _write32(&baResult,nOptionalHeader+16,pLayout->nCodeRelAddress); // AddressOfEntryPoint
+    _write32(&baResult,nOptionalHeader+20,pLayout->nCodeRelAddress); // BaseOfCode
+
+    if(b64)
+    {
+        _write64(&baResult,nOptionalHeader+24,pLayout->nImageBase);
+    }
+    else
+    {
+        _write32(&baResult,nOptionalHeader+28,pLayout->nImageBase);
+    }
+
+    _write32(&baResult,nOptionalHeader+32,0x1000); // SectionAlignment
+    _write32(&baResult,nOptionalHeader+36,0x200); // FileAlignment
+    _write16(&baResult,nOptionalHeader+40,6); // MajorOperatingSystemVersion
+    _write16(&baResult,nOptionalHeader+48,6); // MajorSubsystemVersion
+    _write32(&baResult,nOptionalHeader+56,pLayout->nImageSize); // SizeOfImage
+    _write32(&baResult,nOptionalHeader+60,pLayout->nHeaderSize); // SizeOfHeaders
+    _write16(&baResult,nOptionalHeader+68,3); // Subsystem: console
+
+    if(b64)
+    {
+        _write64(&baResult,nOptionalHeader+72,0x100000);
+        _write64(&baResult,nOptionalHeader+80,0x1000);
+        _write64(&baResult,nOptionalHeader+88,0x100000);
+        _write64(&baResult,nOptionalHeader+96,0x1000);
+        _write32(&baResult,nOptionalHeader+108,16); // NumberOfRvaAndSizes
+    }
+    else
+    {
+        _write32(&baResult,nOptionalHeader+72,0x100000);
+        _write32(&baResult,nOptionalHeader+76,0x1000);
+        _write32(&baResult,nOptionalHeader+80,0x100000);
+        _write32(&baResult,nOptionalHeader+84,0x1000);
+        _write32(&baResult,nOptionalHeader+92,16); // NumberOfRvaAndSizes
+    }
+
+    qint64 nSection=nOptionalHeader+nOptionalHeaderSize;
+
+    memcpy(baResult.data()+nSection,".text",5);
+    _write32(&baResult,nSection+8,pLayout->nCodeSize); // VirtualSize
+    _write32(&baResult,nSection+12,pLayout->nCodeRelAddress); // VirtualAddress
+    _write32(&baResult,nSection+16,nRawSize); // SizeOfRawData
+    _write32(&baResult,nSection+20,pLayout->nHeaderSize); // PointerToRawData
+    _write32(&baResult,nSection+36,0x60000020); // code, execute, read
+
+    if(pLayout->nVirtualSize)
+    {
+        nSection+=40;
+
+        memcpy(baResult.data()+nSection,".bss",4);
+        _write32(&baResult,nSection+8,pLayout->nVirtualSize); // VirtualSize
+        _write32(&baResult,nSection+12,pLayout->nVirtualRelAddress); // VirtualAddress
+        _write32(&baResult,nSection+36,0xC0000080); // uninitialized data, read, write
+    }
+
+    return baResult;
+}
+
+QByteArray XDisasmGenerator::_getELFHeader(XDisasmGenerator::LAYOUT *pLayout)
+{
+    QByteArray baResult(pLayout->nHeaderSize,0);
+
+    _write32(&baResult,0,0x464C457F); // \x7FELF
+    baResult[4]=2; // ELFCLASS64
+    baResult[5]=1; // ELFDATA2LSB
+    baResult[6]=1; // EV_CURRENT
+
+    _write16(&baResult,16,2); // ET_EXEC
+    _write16(&baResult,18,0x3E); // EM_X86_64
+    _write32(&baResult,20,1); // e_version
+    _write64(&baResult,24,pLayout->nCodeAddress); // e_entry
+    _write64(&baResult,32,64); // e_phoff
+    _write16(&baResult,52,64); // e_ehsize
+    _write16(&baResult,54,56); // e_phentsize
+    _write16(&baResult,56,pLayout->nVirtualSize?2:1); // e_phnum
+    _write16(&baResult,58,64); // e_shentsize
+
+    qint64 nProgramHeader=64;
+
+    _write32(&baResult,nProgramHeader+0,1); // PT_LOAD
+    _write32(&baResult,nProgramHeader+4,5); // PF_R|PF_X
+    _write64(&baResult,nProgramHeader+8,pLayout->nHeaderSize); // p_offset
+    _write64(&baResult,nProgramHeader+16,pLayout->nCodeAddress); // p_vaddr
+    _write64(&baResult,nProgramHeader+24,pLayout->nCodeAddress); // p_paddr
+    _write64(&baResult,nProgramHeader+32,pLayout->nCodeSize); // p_filesz
+    _write64(&baResult,nProgramHeader+40,pLayout->nCodeSize); // p_memsz
+    _write64(&baResult,nProgramHeader+48,0x1000); // p_align
+
+    if(pLayout->nVirtualSize)
+    {
+        nProgramHeader+=56;
+
+        // No file data: p_offset only has to be congruent to p_vaddr
+        qint64 nOffset=pLayout->nHeaderSize+pLayout->nCodeSize;
+        qint64 nAddress=pLayout->nImageBase+pLayout->nVirtualRelAddress+(nOffset%0x1000);
+
+        _write32(&baResult,nProgramHeader+0,1); // PT_LOAD
+        _write32(&baResult,nProgramHeader+4,6); // PF_R|PF_W
+        _write64(&baResult,nProgramHeader+8,nOffset); // p_offset
+        _write64(&baResult,nProgramHeader+16,nAddress); // p_vaddr
+        _write64(&baResult,nProgramHeader+24,nAddress); // p_paddr
+        _write64(&baResult,nProgramHeader+32,0); // p_filesz
+        _write64(&baResult,nProgramHeader+40,pLayout->nVirtualSize); // p_memsz
+        _write64(&baResult,nProgramHeader+48,0x1000); // p_align
+    }
+
+    return baResult;
+}
+
+qint64 XDisasmGenerator::_align(qint64 nValue, qint64 nAlignment)
+{
+    return ((nValue+nAlignment-1)/nAlignment)*nAlignment;
+}
+
+void XDisasmGenerator::_write16(QByteArray *pData, qint64 nOffset, quint16 nValue)
+{
+    qToLittleEndian<quint16>(nValue,(uchar *)(pData->data()+nOffset));
+}
+
+void XDisasmGenerator::_write32(QByteArray *pData, qint64 nOffset, quint32 nValue)
+{
+    qToLittleEndian<quint32>(nValue,(uchar *)(pData->data()+nOffset));
+}
+
+void XDisasmGenerator::_write64(QByteArray *pData, qint64 nOffset, quint64 nValue)
+{
+    qToLittleEndian<quint64>(nValue,(uchar *)(pData->data()+nOffset));
+}
@@ -0,0 +1,101 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef XDISASMGENERATOR_H
+#define XDISASMGENERATOR_H
+
+#include <QFile>
+#include <QtEndian>
+#include <QJsonObject>
+#include "xformats.h"
+
+// Writes synthetic images with a known call graph.
+// Function N calls 2N+1 and 2N+2, so every function is reachable from the entry point
+// and the traversal depth stays log2(functions). The expected counts in RESULT are exact
+// as long as the number of instructions is below XDisasm::OPTIONS::nOpcodeLimit (-1 - no limit).
+class XDisasmGenerator
+{
+    static const qint64 N_BUFFER_SIZE=0x100000;
+    static const qint32 N_MAX_JUMPS=64;
+
+public:
+    struct OPTIONS
+    {
+        XBinary::FT fileType; // FT_PE32, FT_PE64, FT_ELF64, FT_BINARY32, FT_BINARY64
+        qint64 nSize; // size of the code section, bytes
+        qint32 nBodyCount; // "mov" instructions per function
+        qint32 nJumpCount; // conditional jumps per function
+        qint32 nPaddingRatio; // int3 padding, percent of the function size
+        qint32 nDataRatio; // unreachable data, percent of the code section
+        bool bSparse; // data blocks are zero holes in the file
+        qint64 nVirtualSize; // size of an uninitialized section after the code, 0 - none
+        quint32 nSeed;
+    };
+
+    struct RESULT
+    {
+        qint64 nFileSize;
+        qint64 nImageSize;
+        qint64 nEntryPointAddress;
+        qint64 nFunctions;
+        qint64 nFunctionSize;
+        qint64 nInstructions;
+        qint64 nCalls;
+        qint64 nJumps;
+        qint64 nReferences;
+    };
+
+    static bool isLayoutValid(OPTIONS *pOptions); // the sizes fit the fields of the headers, PE: 32-bit
+    static bool generate(OPTIONS *pOptions,QIODevice *pDevice,RESULT *pResult); // false if the layout is not valid
+    static bool generate(OPTIONS *pOptions,QString sFileName,RESULT *pResult);
+    static QJsonObject resultToJson(RESULT *pResult);
+
+private:
+    struct LAYOUT
+    {
+        bool b64;
+        qint64 nImageBase;
+        qint64 nHeaderSize; // file
+        qint64 nCodeRelAddress;
+        qint64 nCodeAddress;
+        qint32 nJumpCount;
+        qint64 nFunctionSize;
+        qint64 nPaddingSize;
+        qint64 nDataSize;
+        qint64 nStride;
+        qint64 nFunctions;
+        qint64 nCodeSize;
+        qint64 nVirtualRelAddress;
+        qint64 nVirtualSize;
+        qint64 nImageSize;
+    };
+
+    static LAYOUT _getLayout(OPTIONS *pOptions);
+    static qint32 _writeFunction(char *pBuffer,LAYOUT *pLayout,OPTIONS *pOptions,qint64 nIndex);
+    static void _writeData(char *pBuffer,qint64 nSize,quint32 *pnState);
+    static QByteArray _getPEHeader(LAYOUT *pLayout);
+    static QByteArray _getELFHeader(LAYOUT *pLayout);
+    static qint64 _align(qint64 nValue,qint64 nAlignment);
+    static void _write16(QByteArray *pData,qint64 nOffset,quint16 nValue);
+    static void _write32(QByteArray *pData,qint64 nOffset,quint32 nValue);
+    static void _write64(QByteArray *pData,qint64 nOffset,quint64 nValue);
+};
+
+#endif // XDISASMGENERATOR_H
@@ -0,0 +1,251 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "xdisasmlabelmodel.h"
+
+XDisasmLabelModel::XDisasmLabelModel(QSharedPointer<XDisasm::STATS> pSnapshot, QObject *pParent)
+    : QAbstractTableModel(pParent)
+{
+    this->pSnapshot=pSnapshot;
+    pStats=pSnapshot.data();
+
+    bIndex=false;
+    bFiltered=false;
+}
+
+void XDisasmLabelModel::setFilter(QString sFilter)
+{
+    QByteArray baNewFilter=sFilter.toLower().toUtf8();
+    baNewFilter.replace('\n',"");
+
+    if(baNewFilter!=baFilter)
+    {
+        QVector<qint32> listNewRows;
+
+        if(baNewFilter.size())
+        {
+            if(!bIndex)
+            {
+                _buildIndex();
+            }
+
+            if(bFiltered&&baNewFilter.contains(baFilter))
+            {
+                // Every match of the longer text is a match of the previous one
+                listNewRows=listRows;
+                _narrow(baNewFilter,&listNewRows);
+            }
+            else
+            {
+                _search(baNewFilter,&listNewRows);
+            }
+        }
+
+        beginResetModel();
+
+        baFilter=baNewFilter;
+        bFiltered=(baFilter.size()!=0);
+        listRows=listNewRows;
+
+        endResetModel();
+    }
+}
+
+qint32 XDisasmLabelModel::getNumberOfLabels()
+{
+    return pStats->listLabels.count();
+}
+
+qint64 XDisasmLabelModel::rowToAddress(int nRow) const
+{
+    qint64 nResult=-1;
+
+    qint32 nLabel=rowToLabel(nRow);
+
+    if(nLabel!=-1)
+    {
+        nResult=pStats->listLabels.at(nLabel).nAddress;
+    }
+
+    return nResult;
+}
+
+QVariant XDisasmLabelModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    QVariant result;
+
+    if(orientation==Qt::Horizontal)
+    {
+        if(role==Qt::DisplayRole)
+        {
+            switch(section)
+            {
+                case LCOLUMN_NAME:      result=tr("Name");      break;
+                case LCOLUMN_ADDRESS:   result=tr("Address");   break;
+            }
+        }
+    }
+
+    return result;
+}
+
+int XDisasmLabelModel::rowCount(const QModelIndex &parent) const
+{
+    int nResult=bFiltered?listRows.count():pStats->listLabels.count();
+
+    if(parent.isValid())
+    {
+        nResult=0;
+    }
+
+    return nResult;
+}
+
+int XDisasmLabelModel::columnCount(const QModelIndex &parent) const
+{
+    int nResult=__LCOLUMN_SIZE;
+
+    if(parent.isValid())
+    {
+        nResult=0;
+    }
+
+    return nResult;
+}
+
+QVariant XDisasmLabelModel::data(const QModelIndex &index, int role) const
+{
+    QVariant result;
+
+    if(index.isValid())
+    {
+        qint32 nLabel=rowToLabel(index.row());
+
+        if(nLabel!=-1)
+        {
+            const XDisasm::LABEL *pLabel=&(pStats->listLabels.at(nLabel));
+
+            if(role==Qt::DisplayRole)
+            {
+                switch(index.column())
+                {
+                    case LCOLUMN_NAME:      result=XDisasm::labelToString(pStats,pLabel);                   break;
+                    case LCOLUMN_ADDRESS:   result=QString("0x%1").arg(pLabel->nAddress,8,16,QChar('0'));  break; // TODO function in Binary
+                }
+            }
+            else if(role==Qt::UserRole)
+            {
+                result=pLabel->nAddress;
+            }
+        }
+    }
+
+    return result;
+}
+
+qint32 XDisasmLabelModel::rowToLabel(int nRow) const
+{
+    qint32 nResult=-1;
+
+    if(bFiltered)
+    {
+        if((nRow>=0)&&(nRow<listRows.count()))
+        {
+            nResult=listRows.at(nRow);
+        }
+    }
+    else
+    {
+        if((nRow>=0)&&(nRow<pStats->listLabels.count()))
+        {
+            nResult=nRow;
+        }
+    }
+
+    return nResult;
+}
+
+void XDisasmLabelModel::_buildIndex()
+{
+    qint32 nNumberOfLabels=pStats->listLabels.count();
+
+    baText.clear();
+    listOffsets.resize(nNumberOfLabels+1);
+
+    for(qint32 i=0;i<nNumberOfLabels;i++)
+    {
+        listOffsets[i]=baText.size();
+
+        QByteArray baName=XDisasm::labelToString(pStats,&(pStats->listLabels.at(i))).toLower().toUtf8();
+        baName.replace('\n'," ");
+
+        baText.append(baName);
+        baText.append('\n');
+    }
+
+    listOffsets[nNumberOfLabels]=baText.size();
+
+    bIndex=true;
+}
+
+void XDisasmLabelModel::_search(const QByteArray &baFilter, QVector<qint32> *pListRows)
+{
+    QByteArrayMatcher matcher(baFilter);
+
+    const char *pData=baText.constData();
+    qint32 nSize=baText.size();
+    const qint32 *pOffsetsBegin=listOffsets.constData();
+    const qint32 *pOffsetsEnd=pOffsetsBegin+listOffsets.count();
+
+    qint32 nOffset=matcher.indexIn(pData,nSize,0);
+
+    // The filter has no '\n', a match never crosses a name
+    while(nOffset!=-1)
+    {
+        qint32 nLabel=(qint32)(std::upper_bound(pOffsetsBegin,pOffsetsEnd,nOffset)-pOffsetsBegin)-1;
+
+        pListRows->append(nLabel);
+
+        nOffset=matcher.indexIn(pData,nSize,listOffsets.at(nLabel+1));
+    }
+}
+
+void XDisasmLabelModel::_narrow(const QByteArray &baFilter, QVector<qint32> *pListRows)
+{
+    QByteArrayMatcher matcher(baFilter);
+
+    const char *pData=baText.constData();
+    qint32 nNumberOfRows=pListRows->count();
+    qint32 nCount=0;
+
+    for(qint32 i=0;i<nNumberOfRows;i++)
+    {
+        qint32 nLabel=pListRows->at(i);
+        qint32 nOffset=listOffsets.at(nLabel);
+
+        if(matcher.indexIn(pData+nOffset,listOffsets.at(nLabel+1)-nOffset,0)!=-1)
+        {
+            (*pListRows)[nCount]=nLabel;
+            nCount++;
+        }
+    }
+
+    pListRows->resize(nCount);
+}
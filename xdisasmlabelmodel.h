@@ -0,0 +1,66 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef XDISASMLABELMODEL_H
+#define XDISASMLABELMODEL_H
+
+#include <QAbstractTableModel>
+#include "xdisasm.h"
+
+// Labels of a STATS snapshot. Names are made on demand, only the filter keeps an index:
+// the lowercase names in one buffer, the matches are the rows.
+class XDisasmLabelModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum LCOLUMN
+    {
+        LCOLUMN_NAME=0,
+        LCOLUMN_ADDRESS,
+        __LCOLUMN_SIZE
+    };
+
+    explicit XDisasmLabelModel(QSharedPointer<XDisasm::STATS> pSnapshot,QObject *pParent);
+    void setFilter(QString sFilter); // case insensitive substring
+    qint32 getNumberOfLabels();
+    qint64 rowToAddress(int nRow) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role=Qt::DisplayRole) const override;
+    int rowCount(const QModelIndex &parent=QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent=QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role=Qt::DisplayRole) const override;
+
+private:
+    qint32 rowToLabel(int nRow) const;
+    void _buildIndex();
+    void _search(const QByteArray &baFilter,QVector<qint32> *pListRows);
+    void _narrow(const QByteArray &baFilter,QVector<qint32> *pListRows);
+
+    QSharedPointer<XDisasm::STATS> pSnapshot;
+    XDisasm::STATS *pStats;
+    bool bIndex;
+    QByteArray baText; // names, '\n' after each one
+    QVector<qint32> listOffsets; // label -> offset in baText, the last one is the size
+    bool bFiltered;
+    QByteArray baFilter;
+    QVector<qint32> listRows; // row -> label, when filtered
+};
+
+#endif // XDISASMLABELMODEL_H
@@ -0,0 +1,457 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "xdisasmlisting.h"
+
+XDisasmListing::XDisasmListing(QObject *pParent) : QObject(pParent)
+{
+    pDevice=0;
+    pStats=0;
+    pOutput=0;
+    pOptions=0;
+    nNextChunk=0;
+    nWritten=0;
+    bStop=false;
+    result={};
+    nAddressDigits=8;
+    nOffsetDigits=8;
+}
+
+void XDisasmListing::setData(QIODevice *pDevice, XDisasm::STATS *pStats, QIODevice *pOutput, XDisasmListing::OPTIONS *pOptions)
+{
+    this->pDevice=pDevice;
+    this->pStats=pStats;
+    this->pOutput=pOutput;
+    this->pOptions=pOptions;
+
+    QFile *pFile=dynamic_cast<QFile *>(pDevice);
+
+    sFileName=pFile?pFile->fileName():QString();
+}
+
+void XDisasmListing::stop()
+{
+    QMutexLocker locker(&mutex);
+
+    bStop=true;
+
+    waitWritten.wakeAll();
+    waitReady.wakeAll();
+}
+
+XDisasmListing::RESULT XDisasmListing::getResult()
+{
+    QMutexLocker locker(&mutex);
+
+    return result;
+}
+
+void XDisasmListing::process()
+{
+    XDISASM_TRACE("XDisasmListing::process");
+
+    QElapsedTimer timer;
+    timer.start();
+
+    bStop=false;
+    result={};
+    listChunks.clear();
+    nNextChunk=0;
+    nWritten=0;
+
+    // One width per listing: 16 digits if the image or the file is above 4 GB
+    nAddressDigits=((quint64)(pStats->nImageBase+pStats->nImageSize)>0xFFFFFFFF)?16:8;
+    nOffsetDigits=((quint64)pDevice->size()>0xFFFFFFFF)?16:8;
+
+    // The whole image: the rows of every position, a range: the rows from the one containing its address
+    qint64 nAddress=pStats->nImageBase;
+    qint64 nEndAddress=-1;
+    qint64 nNumberOfRows=pStats->nPositions;
+
+    if(pOptions->nSize)
+    {
+        nAddress=pOptions->nAddress;
+        nEndAddress=pOptions->nAddress+pOptions->nSize;
+        nNumberOfRows=-1;
+    }
+
+    QMap<qint64,XDisasm::VIEW_BLOCK>::const_iterator iter=pStats->mapVB.lowerBound(nAddress);
+
+    if(pOptions->nSize&&(iter!=pStats->mapVB.constBegin()))
+    {
+        QMap<qint64,XDisasm::VIEW_BLOCK>::const_iterator iterPrev=iter-1;
+
+        if((iterPrev.key()+iterPrev.value().nSize)>nAddress)
+        {
+            iter=iterPrev;
+            nAddress=iterPrev.key();
+        }
+    }
+
+    // Only the first row of a chunk is kept, the chunks are rendered straight from the view blocks
+    qint64 nRow=0;
+
+    while(((nNumberOfRows==-1)||(nRow<nNumberOfRows))&&((nEndAddress==-1)||(nAddress<nEndAddress)))
+    {
+        CHUNK chunk={};
+        chunk.nAddress=nAddress;
+        chunk.iterBegin=iter;
+
+        while((chunk.nCount<N_CHUNK_ROWS)&&((nNumberOfRows==-1)||(nRow<nNumberOfRows))&&((nEndAddress==-1)||(nAddress<nEndAddress)))
+        {
+            ROW row={};
+            _getRow(&iter,nAddress,&row);
+
+            nAddress+=row.nSize;
+            chunk.nCount++;
+            nRow++;
+        }
+
+        listChunks.append(chunk);
+    }
+
+    int nNumberOfChunks=listChunks.count();
+
+    listOutputs.clear();
+    listOutputs.resize(nNumberOfChunks);
+    listReady.fill(false,nNumberOfChunks);
+
+    int nThreads=pOptions->nThreads;
+
+    if(nThreads<=0)
+    {
+        nThreads=QThread::idealThreadCount();
+    }
+
+    nThreads=qMin(nThreads,qMax(nNumberOfChunks,1));
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(nThreads);
+
+    for(int i=0;i<nThreads;i++)
+    {
+        QtConcurrent::run(&threadPool,this,&XDisasmListing::_worker);
+    }
+
+    for(int i=0;i<nNumberOfChunks;i++)
+    {
+        QByteArray baData;
+
+        mutex.lock();
+
+        while((!listReady.at(i))&&(!bStop))
+        {
+            waitReady.wait(&mutex);
+        }
+
+        bool bCurrentStop=bStop;
+
+        if(!bCurrentStop)
+        {
+            baData.swap(listOutputs[i]);
+            nWritten=i+1;
+            waitWritten.wakeAll();
+        }
+
+        mutex.unlock();
+
+        if(bCurrentStop)
+        {
+            break;
+        }
+
+        qint64 nDataSize=baData.size();
+
+        if(pOutput->write(baData)!=nDataSize)
+        {
+            emit errorMessage(QString("%1: %2").arg(tr("Cannot write")).arg(pOutput->errorString()));
+
+            mutex.lock();
+            result.bError=true;
+            mutex.unlock();
+
+            stop();
+
+            break;
+        }
+
+        mutex.lock();
+        result.nRows+=listChunks.at(i).nCount;
+        result.nBytes+=nDataSize;
+        mutex.unlock();
+    }
+
+    threadPool.waitForDone();
+
+    listOutputs.clear();
+    listReady.clear();
+
+    mutex.lock();
+    result.nTime=timer.elapsed();
+    mutex.unlock();
+
+    emit processFinished();
+}
+
+void XDisasmListing::_worker()
+{
+    XDISASM_TRACE("XDisasmListing::_worker");
+
+    QFile file;
+    QIODevice *pWorkerDevice=pDevice;
+
+    if(sFileName!="")
+    {
+        file.setFileName(sFileName);
+
+        if(file.open(QIODevice::ReadOnly))
+        {
+            pWorkerDevice=&file;
+        }
+    }
+
+    csh disasm_handle=0;
+
+    if(cs_open(pStats->csarch,pStats->csmode,&disasm_handle)==CS_ERR_OK)
+    {
+        int nNumberOfChunks=listChunks.count();
+
+        while(true)
+        {
+            int nIndex=-1;
+
+            mutex.lock();
+
+            // Bounded memory: do not run too far ahead of the writer
+            while((!bStop)&&(nNextChunk<nNumberOfChunks)&&(nNextChunk>=(nWritten+N_MAX_PENDING)))
+            {
+                waitWritten.wait(&mutex);
+            }
+
+            if((!bStop)&&(nNextChunk<nNumberOfChunks))
+            {
+                nIndex=nNextChunk;
+                nNextChunk++;
+            }
+
+            mutex.unlock();
+
+            if(nIndex==-1)
+            {
+                break;
+            }
+
+            QByteArray baResult;
+
+            _renderChunk(disasm_handle,pWorkerDevice,&(listChunks.at(nIndex)),&baResult);
+
+            mutex.lock();
+            listOutputs[nIndex].swap(baResult);
+            listReady[nIndex]=true;
+            waitReady.wakeAll();
+            mutex.unlock();
+        }
+
+        cs_close(&disasm_handle);
+    }
+    else
+    {
+        stop();
+    }
+}
+
+void XDisasmListing::_getRow(QMap<qint64, XDisasm::VIEW_BLOCK>::const_iterator *pIter, qint64 nAddress, XDisasmListing::ROW *pRow)
+{
+    pRow->nAddress=nAddress;
+
+    if(((*pIter)!=pStats->mapVB.constEnd())&&((*pIter).key()==nAddress))
+    {
+        pRow->nOffset=(*pIter).value().nOffset;
+        pRow->nSize=(*pIter).value().nSize;
+        pRow->type=(*pIter).value().type;
+    }
+    else
+    {
+        // A byte between the view blocks, one row as in XDisasmModel
+        pRow->nOffset=XBinary::addressToOffset(&(pStats->memoryMap),nAddress);
+        pRow->nSize=1;
+        pRow->type=XDisasm::VBT_UNKNOWN;
+    }
+
+    // A block inside of the row has no row
+    while(((*pIter)!=pStats->mapVB.constEnd())&&((*pIter).key()<(nAddress+pRow->nSize)))
+    {
+        ++(*pIter);
+    }
+}
+
+void XDisasmListing::_renderChunk(csh disasm_handle, QIODevice *pWorkerDevice, const XDisasmListing::CHUNK *pChunk, QByteArray *pBaResult)
+{
+    bool bLockDevice=(pWorkerDevice==pDevice);
+
+    QVector<ROW> listRows(pChunk->nCount);
+
+    // The rows of a chunk are mostly contiguous in the file, read them at once
+    qint64 nSpanOffset=-1;
+    qint64 nSpanEnd=-1;
+
+    QMap<qint64,XDisasm::VIEW_BLOCK>::const_iterator iter=pChunk->iterBegin;
+    qint64 nAddress=pChunk->nAddress;
+
+    for(qint32 i=0;i<pChunk->nCount;i++)
+    {
+        ROW *pRow=&(listRows[i]);
+
+        _getRow(&iter,nAddress,pRow);
+
+        nAddress+=pRow->nSize;
+
+        if(pRow->nOffset!=-1)
+        {
+            nSpanOffset=(nSpanOffset==-1)?pRow->nOffset:qMin(nSpanOffset,pRow->nOffset);
+            nSpanEnd=qMax(nSpanEnd,pRow->nOffset+pRow->nSize);
+        }
+    }
+
+    qint64 nMaxSpan=N_MAX_SPAN;
+    bool bSpan=(nSpanOffset!=-1)&&((nSpanEnd-nSpanOffset)<=nMaxSpan);
+
+    QByteArray baSpan;
+    QByteArray baBuffer;
+    qint64 nSpanSize=0;
+
+    if(bSpan)
+    {
+        baSpan.resize(nSpanEnd-nSpanOffset);
+
+        if(bLockDevice) mutexDevice.lock();
+        nSpanSize=XBinary::read_array(pWorkerDevice,nSpanOffset,baSpan.data(),baSpan.size());
+        if(bLockDevice) mutexDevice.unlock();
+    }
+
+    pBaResult->reserve(pChunk->nCount*64);
+
+    for(qint32 i=0;i<pChunk->nCount;i++)
+    {
+        const ROW &row=listRows.at(i);
+
+        _appendHex(pBaResult,(quint64)row.nAddress,nAddressDigits);
+        pBaResult->append('\t');
+
+        const char *pData=nullptr;
+        qint64 nDataSize=0;
+
+        if(row.nOffset!=-1)
+        {
+            _appendHex(pBaResult,(quint64)row.nOffset,nOffsetDigits);
+
+            if(bSpan)
+            {
+                pData=baSpan.constData()+(row.nOffset-nSpanOffset);
+                nDataSize=qBound((qint64)0,nSpanSize-(row.nOffset-nSpanOffset),row.nSize);
+            }
+            else
+            {
+                baBuffer.resize(row.nSize);
+
+                if(bLockDevice) mutexDevice.lock();
+                nDataSize=qMax(XBinary::read_array(pWorkerDevice,row.nOffset,baBuffer.data(),row.nSize),(qint64)0);
+                if(bLockDevice) mutexDevice.unlock();
+
+                pData=baBuffer.constData();
+            }
+        }
+
+        pBaResult->append('\t');
+
+        pBaResult->append(XDisasm::getLabelString(pStats,row.nAddress).toUtf8());
+        pBaResult->append('\t');
+
+        if(row.nOffset!=-1)
+        {
+            _appendBytes(pBaResult,pData,nDataSize);
+        }
+        else
+        {
+            pBaResult->append("byte 0x");
+            pBaResult->append(QByteArray::number(row.nSize,16));
+            pBaResult->append(" dup(?)");
+        }
+
+        if((row.type==XDisasm::VBT_OPCODE)&&(nDataSize>0))
+        {
+            pBaResult->append('\t');
+
+            cs_insn *insn;
+            size_t count=cs_disasm(disasm_handle,(const uint8_t *)pData,nDataSize,row.nAddress,1,&insn);
+
+            if(count>0)
+            {
+                QByteArray baOpcode=insn->mnemonic;
+
+                if(insn->op_str[0])
+                {
+                    baOpcode.append(' ');
+                    baOpcode.append(insn->op_str);
+                }
+
+                cs_free(insn,count);
+
+                if(pOptions->bShowLabels)
+                {
+                    qint32 nNumberOfRefs=0;
+                    const qint64 *pRefs=XDisasm::getRefTo(pStats,row.nAddress,&nNumberOfRefs);
+
+                    for(qint32 j=0;j<nNumberOfRefs;j++)
+                    {
+                        const XDisasm::LABEL *pLabel=XDisasm::findLabel(pStats,pRefs[j]);
+
+                        if(pLabel)
+                        {
+                            QByteArray baAddress="0x"+QByteArray::number(pRefs[j],16);
+                            baOpcode.replace(baAddress,XDisasm::labelToString(pStats,pLabel).toUtf8());
+                        }
+                    }
+                }
+
+                pBaResult->append(baOpcode);
+            }
+        }
+
+        pBaResult->append('\n');
+    }
+}
+
+void XDisasmListing::_appendHex(QByteArray *pBaResult, quint64 nValue, int nDigits)
+{
+    char szBuffer[16];
+
+    qint32 nSize=XDisasmRowFormatter::writeValue(szBuffer,nValue,nDigits);
+
+    pBaResult->append(szBuffer,nSize);
+}
+
+void XDisasmListing::_appendBytes(QByteArray *pBaResult, const char *pData, qint64 nSize)
+{
+    int nStart=pBaResult->size();
+    pBaResult->resize(nStart+nSize*2);
+
+    XDisasmRowFormatter::writeBytes(pBaResult->data()+nStart,pData,nSize);
+}
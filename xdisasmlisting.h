@@ -0,0 +1,116 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef XDISASMLISTING_H
+#define XDISASMLISTING_H
+
+#include <QObject>
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include "xdisasm.h"
+#include "xdisasmrowformatter.h"
+
+// Writes the listing (address, offset, label, bytes, opcode; tab separated) with the rows of XDisasmModel:
+// a row per view block and per byte between the view blocks.
+// Chunks of rows are rendered in parallel and written in order, at most N_MAX_PENDING chunks are in memory.
+class XDisasmListing : public QObject
+{
+    Q_OBJECT
+
+    static const qint32 N_CHUNK_ROWS=0x1000;
+    static const qint32 N_MAX_PENDING=64;
+    static const qint64 N_MAX_SPAN=0x400000; // bytes read at once for a chunk
+
+public:
+    struct OPTIONS
+    {
+        qint64 nAddress;
+        qint64 nSize; // 0 - the whole image
+        bool bShowLabels; // replace the target addresses in the opcodes with labels
+        qint32 nThreads; // 0 - QThread::idealThreadCount()
+    };
+
+    struct RESULT
+    {
+        bool bError;
+        qint64 nRows;
+        qint64 nBytes; // written
+        qint64 nTime; // msec
+    };
+
+    explicit XDisasmListing(QObject *pParent=nullptr);
+    void setData(QIODevice *pDevice,XDisasm::STATS *pStats,QIODevice *pOutput,OPTIONS *pOptions);
+    void stop();
+    RESULT getResult();
+
+public slots:
+    void process();
+
+signals:
+    void errorMessage(QString sText);
+    void processFinished();
+
+private:
+    struct CHUNK
+    {
+        qint64 nAddress; // the first row
+        QMap<qint64,XDisasm::VIEW_BLOCK>::const_iterator iterBegin; // the first view block at or after nAddress
+        qint32 nCount;
+    };
+
+    struct ROW
+    {
+        qint64 nAddress;
+        qint64 nOffset; // -1 if there is no file data
+        qint64 nSize;
+        XDisasm::VBT type; // VBT_UNKNOWN for a byte between the view blocks
+    };
+
+    void _worker();
+    void _getRow(QMap<qint64,XDisasm::VIEW_BLOCK>::const_iterator *pIter,qint64 nAddress,ROW *pRow); // moves the iterator past the row
+    void _renderChunk(csh disasm_handle,QIODevice *pWorkerDevice,const CHUNK *pChunk,QByteArray *pBaResult);
+    static void _appendHex(QByteArray *pBaResult,quint64 nValue,int nDigits);
+    static void _appendBytes(QByteArray *pBaResult,const char *pData,qint64 nSize);
+
+private:
+    QIODevice *pDevice;
+    QString sFileName; // the workers open their own file if the device is a file
+    XDisasm::STATS *pStats;
+    QIODevice *pOutput;
+    OPTIONS *pOptions;
+    QVector<CHUNK> listChunks;
+    QVector<QByteArray> listOutputs;
+    QVector<bool> listReady;
+    qint32 nNextChunk;
+    qint32 nWritten;
+    QMutex mutex;
+    QMutex mutexDevice;
+    QWaitCondition waitReady;
+    QWaitCondition waitWritten;
+    bool bStop;
+    RESULT result;
+    qint32 nAddressDigits; // 8 or 16, the same for every row
+    qint32 nOffsetDigits;
+};
+
+#endif // XDISASMLISTING_H
@@ -1,95 +1,108 @@
-// copyright (c) 2019-2020 hors<horsicq@gmail.com>
-//
-// Permission is hereby granted, free of charge, to any person obtaining a copy
-// of this software and associated documentation files (the "Software"), to deal
-// in the Software without restriction, including without limitation the rights
-// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
-// copies of the Software, and to permit persons to whom the Software is
-// furnished to do so, subject to the following conditions:
-
-// The above copyright notice and this permission notice shall be included in all
-// copies or substantial portions of the Software.
-
-// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
-// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
-// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
-// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
-// SOFTWARE.
-//
-#ifndef XDISASMMODEL_H
-#define XDISASMMODEL_H
-
-#include <QAbstractTableModel>
-#include <QQueue>
-#include "xdisasm.h"
-
-class XDisasmModel : public QAbstractTableModel
-{
-    Q_OBJECT
-
-public:
-    enum UD
-    {
-        UD_ADDRESS=0,
-        UD_OFFSET,
-        UD_RELADDRESS,
-        UD_SIZE
-    };
-
-    enum DMCOLUMN
-    {
-        DMCOLUMN_ADDRESS=0,
-        DMCOLUMN_OFFSET,
-        DMCOLUMN_LABEL,
-        DMCOLUMN_BYTES,
-        DMCOLUMN_OPCODE
-    };
-
-    struct VEIW_RECORD
-    {
-        QString sAddress;
-        QString sOffset;
-        QString sLabel;
-        QString sBytes;
-        QString sOpcode;
-    };
-
-    struct SHOWOPTIONS
-    {
-        bool bShowLabels;
-    };
-
-    explicit XDisasmModel(QIODevice *pDevice, XDisasm::STATS *pStats,SHOWOPTIONS *pShowOptions,QObject *pParent);
-    ~XDisasmModel();
-    // Header:
-    QVariant headerData(int section, Qt::Orientation orientation, int role=Qt::DisplayRole) const override;
-    // Basic functionality:
-    int rowCount(const QModelIndex &parent=QModelIndex()) const override;
-    int columnCount(const QModelIndex &parent=QModelIndex()) const override;
-    QVariant data(const QModelIndex &index, int role=Qt::DisplayRole) const override;
-    VEIW_RECORD getViewRecord(int nRow);
-    qint64 getPositionCount() const;
-    qint64 positionToAddress(qint64 nPosition);
-    qint64 addressToPosition(qint64 nAddress);
-    qint64 offsetToPosition(qint64 nOffset);
-    qint64 relAddressToPosition(qint64 nRelAddress);
-    XDisasm::STATS *getStats();
-    void _beginResetModel();
-    void _endResetModel();
-    void resetCache();
-    bool initDisasm();
-
-private:
-    QIODevice *pDevice;
-    XDisasm::STATS *pStats;
-    SHOWOPTIONS *pShowOptions;
-
-    QQueue<qint64> quRecords;
-    QMap<qint64,VEIW_RECORD> mapRecords;
-    csh disasm_handle;
-    bool bDisasmInit;
-};
-
-#endif // XDISASMMODEL_H
+// copyright (c) 2019-2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef XDISASMMODEL_H
+#define XDISASMMODEL_H
+
+#include <QAbstractTableModel>
+#include <QQueue>
+#include "xdisasm.h"
+#include "xdisasmrowformatter.h"
+
+class XDisasmModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum UD
+    {
+        UD_ADDRESS=0,
+        UD_OFFSET,
+        UD_RELADDRESS,
+        UD_SIZE,
+        UD_WINDOWCLASS // XDisasm::WC, WC_UNKNOWN if SHOWOPTIONS::bShowEntropy is not set
+    };
+
+    enum DMCOLUMN
+    {
+        DMCOLUMN_ADDRESS=0,
+        DMCOLUMN_OFFSET,
+        DMCOLUMN_LABEL,
+        DMCOLUMN_BYTES,
+        DMCOLUMN_OPCODE
+    };
+
+    struct VEIW_RECORD
+    {
+        QString sAddress;
+        QString sOffset;
+        QString sLabel;
+        QString sBytes;
+        QString sOpcode;
+    };
+
+    struct SHOWOPTIONS
+    {
+        bool bShowLabels;
+        bool bShowEntropy; // window classes of the entropy pre-pass
+    };
+
+    explicit XDisasmModel(QIODevice *pDevice,QSharedPointer<XDisasm::STATS> pSnapshot,SHOWOPTIONS *pShowOptions,QObject *pParent);
+    ~XDisasmModel();
+    // Header:
+    QVariant headerData(int section, Qt::Orientation orientation, int role=Qt::DisplayRole) const override;
+    // Basic functionality:
+    int rowCount(const QModelIndex &parent=QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent=QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role=Qt::DisplayRole) const override;
+    VEIW_RECORD getViewRecord(qint64 nPosition);
+    XDisasm::WC getWindowClass(qint64 nPosition); // WC_UNKNOWN if SHOWOPTIONS::bShowEntropy is not set
+    QString getWindowToolTip(qint64 nPosition);
+    qint64 getPositionCount() const;
+    qint64 getRowCount(qint64 nAddress,qint64 nSize); // the positions of the range, nSize 0 - the whole image
+    qint64 positionToAddress(qint64 nPosition);
+    qint64 positionToSize(qint64 nPosition); // 1 if there is no view block
+    qint64 addressToPosition(qint64 nAddress);
+    qint64 offsetToPosition(qint64 nOffset);
+    qint64 relAddressToPosition(qint64 nRelAddress);
+    XDisasm::STATS *getStats(); // the snapshot, read only
+    void setSnapshot(QSharedPointer<XDisasm::STATS> pSnapshot);
+    SHOWOPTIONS *getShowOptions();
+    void _beginResetModel();
+    void _endResetModel();
+    void resetCache();
+    bool initDisasm();
+    static QString _escapeString(QString sString); // quoted, cut at 256 characters
+
+private:
+    QIODevice *pDevice;
+    QSharedPointer<XDisasm::STATS> pSnapshot; // published by XDisasm, the engine may change its own stats meanwhile
+    XDisasm::STATS *pStats; // pSnapshot
+    SHOWOPTIONS *pShowOptions;
+
+    QQueue<qint64> quRecords;
+    QMap<qint64,VEIW_RECORD> mapRecords;
+    csh disasm_handle;
+    bool bDisasmInit;
+    XDisasmRowFormatter formatter;
+    QByteArray baData; // reused by getViewRecord
+};
+
+#endif // XDISASMMODEL_H
@@ -0,0 +1,166 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "xdisasmrowformatter.h"
+
+#if defined(__AVX2__)
+#define XDISASMROWFORMATTER_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(__SSE2__)||defined(_M_X64)||(defined(_M_IX86_FP)&&(_M_IX86_FP>=2))
+#define XDISASMROWFORMATTER_SSE2
+#include <emmintrin.h>
+#endif
+
+static const char HEX_DIGITS[]="0123456789abcdef";
+
+XDisasmRowFormatter::XDisasmRowFormatter()
+{
+    baBuffer.resize(64);
+}
+
+QString XDisasmRowFormatter::addressToString(qint64 nAddress)
+{
+    char *pBuffer=_getBuffer(16);
+
+    qint32 nSize=writeValue(pBuffer,(quint64)nAddress,(nAddress>0xFFFFFFFF)?16:8);
+
+    return QString::fromLatin1(pBuffer,nSize);
+}
+
+QString XDisasmRowFormatter::offsetToString(qint64 nOffset)
+{
+    char *pBuffer=_getBuffer(8);
+
+    qint32 nSize=writeValue(pBuffer,(quint32)nOffset,8);
+
+    return QString::fromLatin1(pBuffer,nSize);
+}
+
+QString XDisasmRowFormatter::valueToString(quint64 nValue, qint32 nDigits)
+{
+    char *pBuffer=_getBuffer(16);
+
+    qint32 nSize=writeValue(pBuffer,nValue,nDigits);
+
+    return QString::fromLatin1(pBuffer,nSize);
+}
+
+QString XDisasmRowFormatter::bytesToString(const char *pData, qint64 nSize)
+{
+    char *pBuffer=_getBuffer(nSize*2);
+
+    writeBytes(pBuffer,pData,nSize);
+
+    return QString::fromLatin1(pBuffer,nSize*2);
+}
+
+qint32 XDisasmRowFormatter::writeValue(char *pDest, quint64 nValue, qint32 nDigits)
+{
+    if(nDigits<=0)
+    {
+        nDigits=1;
+
+        for(quint64 nCurrent=nValue>>4;nCurrent;nCurrent>>=4)
+        {
+            nDigits++;
+        }
+    }
+
+    nDigits=qMin(nDigits,16);
+
+    for(qint32 i=nDigits-1;i>=0;i--)
+    {
+        pDest[i]=HEX_DIGITS[nValue&0xF];
+        nValue>>=4;
+    }
+
+    return nDigits;
+}
+
+void XDisasmRowFormatter::writeBytes(char *pDest, const char *pData, qint64 nSize)
+{
+    qint64 i=0;
+
+#ifdef XDISASMROWFORMATTER_AVX2
+    // nibble+'0', +39 more for a-f; the unpacks work per 128-bit lane, the permutes restore the order
+    const __m256i mask=_mm256_set1_epi8(0x0F);
+    const __m256i nine=_mm256_set1_epi8(9);
+    const __m256i zero=_mm256_set1_epi8('0');
+    const __m256i letters=_mm256_set1_epi8('a'-'0'-10);
+
+    for(;(i+32)<=nSize;i+=32)
+    {
+        __m256i data=_mm256_loadu_si256((const __m256i *)(pData+i));
+        __m256i high=_mm256_and_si256(_mm256_srli_epi16(data,4),mask);
+        __m256i low=_mm256_and_si256(data,mask);
+
+        high=_mm256_add_epi8(_mm256_add_epi8(high,zero),_mm256_and_si256(_mm256_cmpgt_epi8(high,nine),letters));
+        low=_mm256_add_epi8(_mm256_add_epi8(low,zero),_mm256_and_si256(_mm256_cmpgt_epi8(low,nine),letters));
+
+        __m256i first=_mm256_unpacklo_epi8(high,low);
+        __m256i second=_mm256_unpackhi_epi8(high,low);
+
+        _mm256_storeu_si256((__m256i *)(pDest+i*2),_mm256_permute2x128_si256(first,second,0x20));
+        _mm256_storeu_si256((__m256i *)(pDest+i*2+32),_mm256_permute2x128_si256(first,second,0x31));
+    }
+#endif
+
+#ifdef XDISASMROWFORMATTER_SSE2
+    {
+        const __m128i mask=_mm_set1_epi8(0x0F);
+        const __m128i nine=_mm_set1_epi8(9);
+        const __m128i zero=_mm_set1_epi8('0');
+        const __m128i letters=_mm_set1_epi8('a'-'0'-10);
+
+        for(;(i+16)<=nSize;i+=16)
+        {
+            __m128i data=_mm_loadu_si128((const __m128i *)(pData+i));
+            __m128i high=_mm_and_si128(_mm_srli_epi16(data,4),mask);
+            __m128i low=_mm_and_si128(data,mask);
+
+            high=_mm_add_epi8(_mm_add_epi8(high,zero),_mm_and_si128(_mm_cmpgt_epi8(high,nine),letters));
+            low=_mm_add_epi8(_mm_add_epi8(low,zero),_mm_and_si128(_mm_cmpgt_epi8(low,nine),letters));
+
+            _mm_storeu_si128((__m128i *)(pDest+i*2),_mm_unpacklo_epi8(high,low));
+            _mm_storeu_si128((__m128i *)(pDest+i*2+16),_mm_unpackhi_epi8(high,low));
+        }
+    }
+#endif
+
+    for(;i<nSize;i++)
+    {
+        quint8 nByte=(quint8)pData[i];
+
+        pDest[i*2]=HEX_DIGITS[nByte>>4];
+        pDest[i*2+1]=HEX_DIGITS[nByte&0xF];
+    }
+}
+
+char *XDisasmRowFormatter::_getBuffer(qint64 nSize)
+{
+    if(baBuffer.size()<nSize)
+    {
+        baBuffer.resize(nSize);
+    }
+
+    return baBuffer.data();
+}
@@ -0,0 +1,46 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef XDISASMROWFORMATTER_H
+#define XDISASMROWFORMATTER_H
+
+#include <QString>
+#include <QByteArray>
+
+// Hex formatting of the listing rows into a reusable buffer. The digits are lowercase, as XBinary::valueToHex and QByteArray::toHex.
+class XDisasmRowFormatter
+{
+public:
+    XDisasmRowFormatter();
+    QString addressToString(qint64 nAddress); // 8 or 16 digits
+    QString offsetToString(qint64 nOffset); // 8 digits
+    QString valueToString(quint64 nValue,qint32 nDigits); // nDigits 0 - without leading zeros
+    QString bytesToString(const char *pData,qint64 nSize);
+    static qint32 writeValue(char *pDest,quint64 nValue,qint32 nDigits); // returns the number of chars, at most 16
+    static void writeBytes(char *pDest,const char *pData,qint64 nSize); // writes 2*nSize chars
+
+private:
+    char *_getBuffer(qint64 nSize);
+
+private:
+    QByteArray baBuffer;
+};
+
+#endif // XDISASMROWFORMATTER_H
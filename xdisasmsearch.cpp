@@ -0,0 +1,426 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "xdisasmsearch.h"
+#include <cstring>
+
+#if defined(__SSE2__)||defined(_M_X64)||(defined(_M_IX86_FP)&&(_M_IX86_FP>=2))
+#define XDISASMSEARCH_SSE2
+#include <emmintrin.h>
+#endif
+
+XDisasmSearch::XDisasmSearch(QObject *pParent) : QObject(pParent)
+{
+    pDevice=0;
+    pMemoryMap=0;
+    pOptions=0;
+    pattern={};
+    bStop=false;
+    result={};
+}
+
+void XDisasmSearch::setData(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap, XDisasmSearch::OPTIONS *pOptions)
+{
+    this->pDevice=pDevice;
+    this->pMemoryMap=pMemoryMap;
+    this->pOptions=pOptions;
+
+    QFile *pFile=dynamic_cast<QFile *>(pDevice);
+
+    sFileName=pFile?pFile->fileName():QString();
+}
+
+void XDisasmSearch::stop()
+{
+    bStop=true;
+}
+
+XDisasmSearch::RESULT XDisasmSearch::getResult()
+{
+    QMutexLocker locker(&mutex);
+
+    return result;
+}
+
+bool XDisasmSearch::compilePattern(QString sSignature, QChar cWild, XDisasmSearch::PATTERN *pPattern)
+{
+    bool bResult=true;
+
+    *pPattern={};
+    pPattern->nAnchor1=-1;
+    pPattern->nAnchor2=-1;
+
+    sSignature=sSignature.remove(QChar(' ')).toLower();
+    cWild=cWild.toLower(); // compared with the lowered signature
+
+    int nLength=sSignature.size();
+
+    if((nLength==0)||(nLength%2))
+    {
+        bResult=false;
+    }
+
+    int nSize=nLength/2;
+
+    pPattern->baValues.fill(0,nSize);
+    pPattern->baMasks.fill(0,nSize);
+
+    for(int i=0;(i<nLength)&&bResult;i++)
+    {
+        QChar cChar=sSignature.at(i);
+
+        quint8 nNibble=0;
+        quint8 nMask=0;
+
+        if((cChar>=QChar('0'))&&(cChar<=QChar('9')))
+        {
+            nNibble=cChar.unicode()-'0';
+            nMask=0xF;
+        }
+        else if((cChar>=QChar('a'))&&(cChar<=QChar('f')))
+        {
+            nNibble=cChar.unicode()-'a'+10;
+            nMask=0xF;
+        }
+        else if((cChar!=cWild)&&(cChar!=QChar('.'))&&(cChar!=QChar('?'))&&(cChar!=QChar('$')))
+        {
+            bResult=false;
+        }
+
+        int nShift=(i%2)?0:4;
+
+        pPattern->baValues[i/2]=(char)(((quint8)pPattern->baValues.at(i/2))|(nNibble<<nShift));
+        pPattern->baMasks[i/2]=(char)(((quint8)pPattern->baMasks.at(i/2))|(nMask<<nShift));
+    }
+
+    if(bResult)
+    {
+        // The first anchor is the earliest rarest byte, the second one the latest
+        int nRank1=-1;
+        int nRank2=-1;
+
+        for(int i=0;i<nSize;i++)
+        {
+            if((quint8)pPattern->baMasks.at(i)==0xFF)
+            {
+                int nRank=_getByteRank((quint8)pPattern->baValues.at(i));
+
+                if((nRank1==-1)||(nRank<nRank1))
+                {
+                    nRank1=nRank;
+                    pPattern->nAnchor1=i;
+                }
+            }
+        }
+
+        for(int i=nSize-1;i>=0;i--)
+        {
+            if(((quint8)pPattern->baMasks.at(i)==0xFF)&&(i!=pPattern->nAnchor1))
+            {
+                int nRank=_getByteRank((quint8)pPattern->baValues.at(i));
+
+                if((nRank2==-1)||(nRank<nRank2))
+                {
+                    nRank2=nRank;
+                    pPattern->nAnchor2=i;
+                }
+            }
+        }
+
+        if(pPattern->nAnchor2==-1)
+        {
+            pPattern->nAnchor2=pPattern->nAnchor1;
+        }
+    }
+
+    return bResult;
+}
+
+void XDisasmSearch::scan(const char *pData, qint64 nPositions, const XDisasmSearch::PATTERN *pPattern, qint64 nAddress, QList<qint64> *pListResults)
+{
+    const quint8 *pBytes=(const quint8 *)pData;
+
+    qint64 i=0;
+
+    if(pPattern->nAnchor1!=-1)
+    {
+        qint32 nAnchor1=pPattern->nAnchor1;
+        qint32 nAnchor2=pPattern->nAnchor2;
+        quint8 nByte1=(quint8)pPattern->baValues.at(nAnchor1);
+        quint8 nByte2=(quint8)pPattern->baValues.at(nAnchor2);
+
+#ifdef XDISASMSEARCH_SSE2
+        // 16 start positions at once: both anchor bytes must match
+        __m128i xmmByte1=_mm_set1_epi8((char)nByte1);
+        __m128i xmmByte2=_mm_set1_epi8((char)nByte2);
+
+        for(;i+16<=nPositions;i+=16)
+        {
+            __m128i xmmData1=_mm_loadu_si128((const __m128i *)(pBytes+i+nAnchor1));
+            __m128i xmmData2=_mm_loadu_si128((const __m128i *)(pBytes+i+nAnchor2));
+
+            quint32 nMask=(quint32)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(xmmData1,xmmByte1),_mm_cmpeq_epi8(xmmData2,xmmByte2)));
+
+            while(nMask)
+            {
+                qint64 nPosition=i+qCountTrailingZeroBits(nMask);
+
+                if(compare(pBytes+nPosition,pPattern))
+                {
+                    pListResults->append(nAddress+nPosition);
+                }
+
+                nMask&=(nMask-1);
+            }
+        }
+#endif
+        while(i<nPositions)
+        {
+            // memchr is vectorized by the C library
+            const quint8 *pFound=(const quint8 *)memchr(pBytes+i+nAnchor1,nByte1,nPositions-i);
+
+            if(pFound==0)
+            {
+                break;
+            }
+
+            i=(pFound-pBytes)-nAnchor1;
+
+            if((pBytes[i+nAnchor2]==nByte2)&&compare(pBytes+i,pPattern))
+            {
+                pListResults->append(nAddress+i);
+            }
+
+            i++;
+        }
+    }
+    else
+    {
+        for(;i<nPositions;i++)
+        {
+            if(compare(pBytes+i,pPattern))
+            {
+                pListResults->append(nAddress+i);
+            }
+        }
+    }
+}
+
+void XDisasmSearch::process()
+{
+    XDISASM_TRACE("XDisasmSearch::process");
+
+    QElapsedTimer timer;
+    timer.start();
+
+    bStop=false;
+    result={};
+    listChunks.clear();
+    nCurrentChunk=0;
+    nNumberOfResults=0;
+
+    result.bValid=compilePattern(pOptions->sSignature,pOptions->cWild,&pattern);
+
+    if(result.bValid)
+    {
+        qint64 nPatternSize=pattern.baValues.size();
+        qint64 nChunkSize=N_CHUNK_SIZE;
+        qint64 nDeviceSize=pDevice->size();
+
+        int nNumberOfRecords=pMemoryMap->listRecords.count();
+
+        for(int i=0;i<nNumberOfRecords;i++)
+        {
+            qint64 nRegionOffset=pMemoryMap->listRecords.at(i).nOffset;
+            qint64 nRegionAddress=pMemoryMap->listRecords.at(i).nAddress;
+            qint64 nRegionSize=pMemoryMap->listRecords.at(i).nSize;
+
+            if((nRegionOffset!=-1)&&(nRegionAddress!=-1)&&(nRegionOffset<nDeviceSize))
+            {
+                nRegionSize=qMin(nRegionSize,nDeviceSize-nRegionOffset);
+
+                for(qint64 j=0;j<=(nRegionSize-nPatternSize);j+=nChunkSize)
+                {
+                    CHUNK chunk={};
+                    chunk.nOffset=nRegionOffset+j;
+                    chunk.nAddress=nRegionAddress+j;
+                    chunk.nSize=qMin(nChunkSize,nRegionSize-j-nPatternSize+1);
+                    chunk.nReadSize=chunk.nSize+nPatternSize-1;
+
+                    listChunks.append(chunk);
+
+                    result.nBytes+=chunk.nSize;
+                }
+            }
+        }
+
+        int nThreads=pOptions->nThreads;
+
+        if(nThreads<=0)
+        {
+            nThreads=QThread::idealThreadCount();
+        }
+
+        nThreads=qMin(nThreads,qMax(listChunks.count(),1));
+
+        QThreadPool threadPool;
+        threadPool.setMaxThreadCount(nThreads);
+
+        for(int i=0;i<nThreads;i++)
+        {
+            QtConcurrent::run(&threadPool,this,&XDisasmSearch::_worker);
+        }
+
+        threadPool.waitForDone();
+
+        mutex.lock();
+
+        std::sort(result.listAddresses.begin(),result.listAddresses.end());
+
+        if(pOptions->nResultLimit&&(result.listAddresses.count()>=pOptions->nResultLimit))
+        {
+            result.bLimitReached=true;
+            result.listAddresses=result.listAddresses.mid(0,pOptions->nResultLimit);
+        }
+
+        mutex.unlock();
+    }
+    else
+    {
+        emit errorMessage(QString("%1: %2").arg(tr("Invalid signature")).arg(pOptions->sSignature));
+    }
+
+    mutex.lock();
+    result.nTime=timer.elapsed();
+    mutex.unlock();
+
+    emit processFinished();
+}
+
+void XDisasmSearch::_worker()
+{
+    XDISASM_TRACE("XDisasmSearch::_worker");
+
+    qint64 nPatternSize=pattern.baValues.size();
+
+    QFile file;
+    QIODevice *pWorkerDevice=pDevice;
+
+    if(sFileName!="")
+    {
+        file.setFileName(sFileName);
+
+        if(file.open(QIODevice::ReadOnly))
+        {
+            pWorkerDevice=&file;
+        }
+    }
+
+    bool bLockDevice=(pWorkerDevice==pDevice);
+
+    QByteArray baBuffer;
+    baBuffer.resize(N_CHUNK_SIZE+nPatternSize-1);
+
+    QList<qint64> listResults;
+
+    int nNumberOfChunks=listChunks.count();
+
+    while(!bStop)
+    {
+        int nIndex=nCurrentChunk.fetchAndAddOrdered(1);
+
+        if(nIndex>=nNumberOfChunks)
+        {
+            break;
+        }
+
+        const CHUNK &chunk=listChunks.at(nIndex);
+
+        qint64 nDataSize=0;
+
+        if(bLockDevice) mutexDevice.lock();
+        nDataSize=XBinary::read_array(pWorkerDevice,chunk.nOffset,baBuffer.data(),chunk.nReadSize);
+        if(bLockDevice) mutexDevice.unlock();
+
+        qint64 nPositions=qMin(chunk.nSize,nDataSize-nPatternSize+1);
+
+        if(nPositions>0)
+        {
+            int nCount=listResults.count();
+
+            scan(baBuffer.constData(),nPositions,&pattern,chunk.nAddress,&listResults);
+
+            nCount=listResults.count()-nCount;
+
+            if(pOptions->nResultLimit&&((nNumberOfResults.fetchAndAddOrdered(nCount)+nCount)>=pOptions->nResultLimit))
+            {
+                bStop=true;
+            }
+        }
+    }
+
+    QMutexLocker locker(&mutex);
+
+    result.listAddresses.append(listResults);
+}
+
+int XDisasmSearch::_getByteRank(quint8 nByte)
+{
+    int nResult=0;
+
+    // Frequent bytes in x86 code and padding
+    switch(nByte)
+    {
+        case 0x00:
+        case 0xFF:  nResult=3;  break;
+        case 0xCC:
+        case 0x90:  nResult=2;  break;
+        case 0x0F:
+        case 0x48:
+        case 0x4C:
+        case 0x89:
+        case 0x8B:
+        case 0xE8:  nResult=1;  break;
+    }
+
+    return nResult;
+}
+
+bool XDisasmSearch::compare(const quint8 *pData, const XDisasmSearch::PATTERN *pPattern)
+{
+    bool bResult=true;
+
+    const quint8 *pValues=(const quint8 *)pPattern->baValues.constData();
+    const quint8 *pMasks=(const quint8 *)pPattern->baMasks.constData();
+
+    int nSize=pPattern->baValues.size();
+
+    for(int i=0;i<nSize;i++)
+    {
+        if((pData[i]&pMasks[i])!=pValues[i])
+        {
+            bResult=false;
+
+            break;
+        }
+    }
+
+    return bResult;
+}
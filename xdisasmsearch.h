@@ -0,0 +1,106 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef XDISASMSEARCH_H
+#define XDISASMSEARCH_H
+
+#include <QObject>
+#include <QMutex>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include "xdisasm.h"
+
+// Wildcard byte pattern search over the file-backed regions of a memory map.
+// The signatures are the ones DialogAsmSignature produces: hex digits, a wildcard character and '$' for relative bytes.
+class XDisasmSearch : public QObject
+{
+    Q_OBJECT
+
+    static const qint64 N_CHUNK_SIZE=0x100000;
+
+public:
+    struct PATTERN
+    {
+        QByteArray baValues;
+        QByteArray baMasks; // 0xFF - the byte is defined, 0x00 - wildcard, nibbles are allowed
+        qint32 nAnchor1; // rarest defined bytes, -1 if no byte is fully defined
+        qint32 nAnchor2;
+    };
+
+    struct OPTIONS
+    {
+        QString sSignature;
+        QChar cWild; // in addition to '.', '?' and '$'
+        qint32 nThreads; // 0 - QThread::idealThreadCount()
+        qint32 nResultLimit; // 0 - no limit
+    };
+
+    struct RESULT
+    {
+        bool bValid; // the signature is valid
+        bool bLimitReached;
+        QList<qint64> listAddresses; // sorted
+        qint64 nBytes; // scanned
+        qint64 nTime; // msec
+    };
+
+    explicit XDisasmSearch(QObject *pParent=nullptr);
+    void setData(QIODevice *pDevice,XBinary::_MEMORY_MAP *pMemoryMap,OPTIONS *pOptions);
+    void stop();
+    RESULT getResult();
+    static bool compilePattern(QString sSignature,QChar cWild,PATTERN *pPattern);
+    static void scan(const char *pData,qint64 nPositions,const PATTERN *pPattern,qint64 nAddress,QList<qint64> *pListResults);
+    static bool compare(const quint8 *pData,const PATTERN *pPattern);
+
+public slots:
+    void process();
+
+signals:
+    void errorMessage(QString sText);
+    void processFinished();
+
+private:
+    struct CHUNK
+    {
+        qint64 nOffset;
+        qint64 nAddress;
+        qint64 nSize; // start positions
+        qint64 nReadSize; // nSize + the tail of the last match, inside the region
+    };
+
+    void _worker();
+    static int _getByteRank(quint8 nByte);
+
+private:
+    QIODevice *pDevice;
+    QString sFileName; // the workers open their own file if the device is a file
+    XBinary::_MEMORY_MAP *pMemoryMap;
+    OPTIONS *pOptions;
+    PATTERN pattern;
+    QVector<CHUNK> listChunks;
+    QMutex mutexDevice;
+    QMutex mutex;
+    QAtomicInt nCurrentChunk;
+    QAtomicInt nNumberOfResults;
+    bool bStop;
+    RESULT result;
+};
+
+#endif // XDISASMSEARCH_H
@@ -0,0 +1,278 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "xdisasmsignaturemodel.h"
+
+XDisasmSignatureModel::XDisasmSignatureModel(QIODevice *pDevice, XDisasm::STATS *pStats, qint64 nAddress, QObject *pParent)
+    : QAbstractTableModel(pParent)
+{
+    options={};
+    options.csarch=pStats->csarch;
+    options.csmode=pStats->csmode;
+    options.memoryMap=pStats->memoryMap;
+    options.pDevice=pDevice;
+    options.sm=XDisasm::SM_NORMAL;
+
+    context={};
+    XDisasm::openSignature(&context,&options,nAddress);
+
+    nCount=0;
+}
+
+XDisasmSignatureModel::~XDisasmSignatureModel()
+{
+    XDisasm::closeSignature(&context);
+}
+
+void XDisasmSignatureModel::setCount(qint32 nCount)
+{
+    this->nCount=nCount;
+    options.nCount=nCount;
+
+    qint32 nNumberOfRecords=listRecords.count();
+
+    if(nCount<nNumberOfRecords)
+    {
+        beginRemoveRows(QModelIndex(),nCount,nNumberOfRecords-1);
+
+        XDisasm::resizeSignature(&context,&options,&listRecords,nCount);
+        listChecked.resize(nCount);
+
+        endRemoveRows();
+    }
+    else if(nCount>nNumberOfRecords)
+    {
+        // The context continues after the last record, the number of new records is known only after decoding
+        QList<XDisasm::SIGNATURE_RECORD> listNewRecords;
+        XDisasm::resizeSignature(&context,&options,&listNewRecords,nCount-nNumberOfRecords);
+
+        qint32 nNumberOfNewRecords=listNewRecords.count();
+
+        if(nNumberOfNewRecords)
+        {
+            beginInsertRows(QModelIndex(),nNumberOfRecords,nNumberOfRecords+nNumberOfNewRecords-1);
+
+            listRecords.append(listNewRecords);
+            listChecked.resize(nNumberOfRecords+nNumberOfNewRecords);
+
+            endInsertRows();
+        }
+    }
+}
+
+void XDisasmSignatureModel::setMethod(XDisasm::SM sm)
+{
+    if(options.sm!=sm)
+    {
+        beginResetModel();
+
+        options.sm=sm;
+
+        // The decoder is kept, the walk starts again
+        XDisasm::resizeSignature(&context,&options,&listRecords,0);
+        XDisasm::resizeSignature(&context,&options,&listRecords,nCount);
+
+        listChecked.fill(0,listRecords.count());
+
+        endResetModel();
+    }
+}
+
+qint32 XDisasmSignatureModel::getNumberOfRecords()
+{
+    return listRecords.count();
+}
+
+const XDisasm::SIGNATURE_RECORD *XDisasmSignatureModel::getRecord(qint32 nRow)
+{
+    return &(listRecords.at(nRow));
+}
+
+bool XDisasmSignatureModel::isWild(qint32 nRow, XDisasmSignatureModel::SCOLUMN column)
+{
+    bool bResult=false;
+
+    if(isCheckable(nRow,column)&&isChecked(nRow,column))
+    {
+        bResult=true;
+
+        if(column!=SCOLUMN_OPCODE)
+        {
+            bResult=!isChecked(nRow,SCOLUMN_OPCODE);
+        }
+    }
+
+    return bResult;
+}
+
+QVariant XDisasmSignatureModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    QVariant result;
+
+    if(orientation==Qt::Horizontal)
+    {
+        if(role==Qt::DisplayRole)
+        {
+            switch(section)
+            {
+                case SCOLUMN_ADDRESS:   result=tr("Address");   break;
+                case SCOLUMN_BYTES:     result=tr("Bytes");     break;
+                case SCOLUMN_OPCODE:    result=tr("Opcode");    break;
+            }
+        }
+    }
+
+    return result;
+}
+
+int XDisasmSignatureModel::rowCount(const QModelIndex &parent) const
+{
+    int nResult=listRecords.count();
+
+    if(parent.isValid())
+    {
+        nResult=0;
+    }
+
+    return nResult;
+}
+
+int XDisasmSignatureModel::columnCount(const QModelIndex &parent) const
+{
+    int nResult=__SCOLUMN_SIZE;
+
+    if(parent.isValid())
+    {
+        nResult=0;
+    }
+
+    return nResult;
+}
+
+QVariant XDisasmSignatureModel::data(const QModelIndex &index, int role) const
+{
+    QVariant result;
+
+    if(index.isValid())
+    {
+        int nRow=index.row();
+        int nColumn=index.column();
+
+        const XDisasm::SIGNATURE_RECORD *pRecord=&(listRecords.at(nRow));
+
+        if(role==Qt::DisplayRole)
+        {
+            switch(nColumn)
+            {
+                case SCOLUMN_ADDRESS:   result=XBinary::valueToHex(options.memoryMap.mode,pRecord->nAddress);                    break;
+                case SCOLUMN_BYTES:     result=formatter.bytesToString(pRecord->baOpcode.constData(),pRecord->baOpcode.size());  break;
+                case SCOLUMN_OPCODE:    result=pRecord->sOpcode;                                                                 break;
+                case SCOLUMN_DISP:      result=isCheckable(nRow,nColumn)?QString("d"):QString();                                 break;
+                case SCOLUMN_IMM:       result=isCheckable(nRow,nColumn)?QString("i"):QString();                                 break;
+            }
+        }
+        else if(role==Qt::CheckStateRole)
+        {
+            if(isCheckable(nRow,nColumn))
+            {
+                result=isChecked(nRow,nColumn)?Qt::Checked:Qt::Unchecked;
+            }
+        }
+    }
+
+    return result;
+}
+
+bool XDisasmSignatureModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    bool bResult=false;
+
+    if(index.isValid()&&(role==Qt::CheckStateRole))
+    {
+        int nRow=index.row();
+        int nColumn=index.column();
+
+        if(isCheckable(nRow,nColumn))
+        {
+            if(value.toInt()==Qt::Checked)
+            {
+                listChecked[nRow]|=(1<<nColumn);
+            }
+            else
+            {
+                listChecked[nRow]&=~(1<<nColumn);
+            }
+
+            // The opcode cell enables the displacement and immediate cells of its row
+            emit dataChanged(this->index(nRow,SCOLUMN_OPCODE),this->index(nRow,SCOLUMN_IMM));
+
+            bResult=true;
+        }
+    }
+
+    return bResult;
+}
+
+Qt::ItemFlags XDisasmSignatureModel::flags(const QModelIndex &index) const
+{
+    Qt::ItemFlags result=QAbstractTableModel::flags(index);
+
+    if(index.isValid())
+    {
+        int nRow=index.row();
+        int nColumn=index.column();
+
+        if(isCheckable(nRow,nColumn))
+        {
+            result|=Qt::ItemIsUserCheckable;
+
+            if((nColumn!=SCOLUMN_OPCODE)&&isChecked(nRow,SCOLUMN_OPCODE))
+            {
+                result&=~Qt::ItemIsEnabled;
+            }
+        }
+    }
+
+    return result;
+}
+
+bool XDisasmSignatureModel::isCheckable(qint32 nRow, int nColumn) const
+{
+    bool bResult=false;
+
+    const XDisasm::SIGNATURE_RECORD *pRecord=&(listRecords.at(nRow));
+
+    if(!pRecord->bIsConst)
+    {
+        switch(nColumn)
+        {
+            case SCOLUMN_OPCODE:    bResult=true;                       break;
+            case SCOLUMN_DISP:      bResult=(pRecord->nDispSize!=0);    break;
+            case SCOLUMN_IMM:       bResult=(pRecord->nImmSize!=0);     break;
+        }
+    }
+
+    return bResult;
+}
+
+bool XDisasmSignatureModel::isChecked(qint32 nRow, int nColumn) const
+{
+    return (listChecked.at(nRow)&(1<<nColumn))!=0;
+}
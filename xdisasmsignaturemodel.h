@@ -0,0 +1,71 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef XDISASMSIGNATUREMODEL_H
+#define XDISASMSIGNATUREMODEL_H
+
+#include <QAbstractTableModel>
+#include "xdisasm.h"
+#include "xdisasmrowformatter.h"
+
+// The records of a signature. The decoder stays open, a new count only decodes or drops the records at the end.
+// The opcode, displacement and immediate cells are checkable: checked - replaced by wildcards.
+class XDisasmSignatureModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum SCOLUMN
+    {
+        SCOLUMN_ADDRESS=0,
+        SCOLUMN_BYTES,
+        SCOLUMN_OPCODE,
+        SCOLUMN_DISP,
+        SCOLUMN_IMM,
+        __SCOLUMN_SIZE
+    };
+
+    explicit XDisasmSignatureModel(QIODevice *pDevice,XDisasm::STATS *pStats,qint64 nAddress,QObject *pParent);
+    ~XDisasmSignatureModel();
+    void setCount(qint32 nCount);
+    void setMethod(XDisasm::SM sm);
+    qint32 getNumberOfRecords();
+    const XDisasm::SIGNATURE_RECORD *getRecord(qint32 nRow);
+    bool isWild(qint32 nRow,SCOLUMN column); // the cell is checked and enabled
+    QVariant headerData(int section, Qt::Orientation orientation, int role=Qt::DisplayRole) const override;
+    int rowCount(const QModelIndex &parent=QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent=QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role=Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role=Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+private:
+    bool isCheckable(qint32 nRow,int nColumn) const;
+    bool isChecked(qint32 nRow,int nColumn) const;
+
+    XDisasm::SIGNATURE_OPTIONS options;
+    XDisasm::SIGNATURE_CONTEXT context;
+    mutable XDisasmRowFormatter formatter; // reused by data()
+    qint32 nCount;
+    QList<XDisasm::SIGNATURE_RECORD> listRecords;
+    QVector<quint8> listChecked; // bit (1<<SCOLUMN) per record
+};
+
+#endif // XDISASMSIGNATUREMODEL_H
@@ -0,0 +1,485 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "xdisasmsignaturescanner.h"
+
+XDisasmSignatureScanner::XDisasmSignatureScanner()
+{
+    nMaxSize=0;
+    bCompiled=false;
+
+    for(int i=0;i<256;i++)
+    {
+        rootNodes[i]=0;
+    }
+}
+
+bool XDisasmSignatureScanner::addSignature(QString sName, QString sSignature, QChar cWild)
+{
+    bool bResult=false;
+
+    SIGNATURE signature={};
+    signature.sName=sName;
+
+    if(XDisasmSearch::compilePattern(sSignature,cWild,&(signature.pattern)))
+    {
+        // The longest run of fully defined bytes is the key
+        qint32 nSize=signature.pattern.baMasks.size();
+        qint32 nRunOffset=0;
+        qint32 nRunSize=0;
+
+        for(qint32 i=0;i<nSize;i++)
+        {
+            if((quint8)signature.pattern.baMasks.at(i)==0xFF)
+            {
+                if(nRunSize==0)
+                {
+                    nRunOffset=i;
+                }
+
+                nRunSize++;
+
+                if(nRunSize>signature.nKeySize)
+                {
+                    signature.nKeyOffset=nRunOffset;
+                    signature.nKeySize=nRunSize;
+                }
+            }
+            else
+            {
+                nRunSize=0;
+            }
+        }
+
+        if(signature.nKeySize)
+        {
+            listSignatures.append(signature);
+            nMaxSize=qMax(nMaxSize,nSize);
+            bCompiled=false;
+
+            bResult=true;
+        }
+    }
+
+    return bResult;
+}
+
+qint32 XDisasmSignatureScanner::loadFile(QString sFileName, QChar cWild)
+{
+    qint32 nResult=0;
+
+    QFile file;
+    file.setFileName(sFileName);
+
+    if(file.open(QIODevice::ReadOnly))
+    {
+        QTextStream stream(&file);
+
+        while(!stream.atEnd())
+        {
+            QString sLine=stream.readLine().trimmed();
+
+            int nIndex=sLine.indexOf(QChar('='));
+
+            if((nIndex>0)&&(!sLine.startsWith(QChar('#'))))
+            {
+                if(addSignature(sLine.left(nIndex).trimmed(),sLine.mid(nIndex+1),cWild))
+                {
+                    nResult++;
+                }
+            }
+        }
+
+        file.close();
+    }
+
+    return nResult;
+}
+
+qint32 XDisasmSignatureScanner::getNumberOfSignatures()
+{
+    return listSignatures.count();
+}
+
+QString XDisasmSignatureScanner::getName(qint32 nSignature)
+{
+    return listSignatures.at(nSignature).sName;
+}
+
+void XDisasmSignatureScanner::compile()
+{
+    // Trie over the keys
+    QVector<QVector<EDGE>> listChildren;
+    QVector<QVector<qint32>> listNodeOutputs;
+
+    listChildren.append(QVector<EDGE>());
+    listNodeOutputs.append(QVector<qint32>());
+
+    qint32 nNumberOfSignatures=listSignatures.count();
+
+    for(qint32 i=0;i<nNumberOfSignatures;i++)
+    {
+        const SIGNATURE *pSignature=&(listSignatures.at(i));
+        const quint8 *pKey=(const quint8 *)(pSignature->pattern.baValues.constData()+pSignature->nKeyOffset);
+
+        qint32 nNode=0;
+
+        for(qint32 j=0;j<pSignature->nKeySize;j++)
+        {
+            qint32 nNext=_findEdge(&(listChildren[nNode]),pKey[j]);
+
+            if(nNext==-1)
+            {
+                nNext=listChildren.count();
+
+                EDGE edge={};
+                edge.nByte=pKey[j];
+                edge.nNode=nNext;
+
+                listChildren[nNode].append(edge);
+                listChildren.append(QVector<EDGE>());
+                listNodeOutputs.append(QVector<qint32>());
+            }
+
+            nNode=nNext;
+        }
+
+        listNodeOutputs[nNode].append(i);
+    }
+
+    qint32 nNumberOfNodes=listChildren.count();
+
+    // Fail and output links, breadth first
+    QVector<qint32> listFail(nNumberOfNodes,0);
+    QVector<qint32> listOutputLinks(nNumberOfNodes,-1);
+    QVector<qint32> listQueue;
+    listQueue.reserve(nNumberOfNodes);
+    listQueue.append(0);
+
+    for(qint32 i=0;i<listQueue.count();i++)
+    {
+        qint32 nNode=listQueue.at(i);
+        qint32 nNumberOfEdges=listChildren.at(nNode).count();
+
+        for(qint32 j=0;j<nNumberOfEdges;j++)
+        {
+            EDGE edge=listChildren.at(nNode).at(j);
+
+            if(nNode)
+            {
+                qint32 nFail=listFail.at(nNode);
+                qint32 nTarget=_findEdge(&(listChildren[nFail]),edge.nByte);
+
+                while((nTarget==-1)&&nFail)
+                {
+                    nFail=listFail.at(nFail);
+                    nTarget=_findEdge(&(listChildren[nFail]),edge.nByte);
+                }
+
+                listFail[edge.nNode]=(nTarget!=-1)?nTarget:0;
+            }
+
+            qint32 nFail=listFail.at(edge.nNode);
+
+            listOutputLinks[edge.nNode]=listNodeOutputs.at(nFail).count()?nFail:listOutputLinks.at(nFail);
+
+            listQueue.append(edge.nNode);
+        }
+    }
+
+    // Flat arrays
+    listNodes.clear();
+    listEdges.clear();
+    listOutputs.clear();
+
+    listNodes.reserve(nNumberOfNodes);
+
+    for(qint32 i=0;i<nNumberOfNodes;i++)
+    {
+        std::sort(listChildren[i].begin(),listChildren[i].end(),[](const EDGE &edge1,const EDGE &edge2){return edge1.nByte<edge2.nByte;});
+
+        NODE node={};
+        node.nFirstEdge=listEdges.count();
+        node.nNumberOfEdges=listChildren.at(i).count();
+        node.nFail=listFail.at(i);
+        node.nOutputLink=listOutputLinks.at(i);
+        node.nFirstOutput=listOutputs.count();
+        node.nNumberOfOutputs=listNodeOutputs.at(i).count();
+
+        listEdges+=listChildren.at(i);
+        listOutputs+=listNodeOutputs.at(i);
+
+        listNodes.append(node);
+    }
+
+    for(int i=0;i<256;i++)
+    {
+        rootNodes[i]=0;
+    }
+
+    int nNumberOfRootEdges=listChildren.at(0).count();
+
+    for(int i=0;i<nNumberOfRootEdges;i++)
+    {
+        rootNodes[listChildren.at(0).at(i).nByte]=listChildren.at(0).at(i).nNode;
+    }
+
+    bCompiled=true;
+}
+
+QList<XDisasmSignatureScanner::MATCH> XDisasmSignatureScanner::scan(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap, bool *pbStop)
+{
+    XDISASM_TRACE("XDisasmSignatureScanner::scan");
+
+    QList<MATCH> listResult;
+
+    if(!bCompiled)
+    {
+        compile();
+    }
+
+    if(listSignatures.count())
+    {
+        qint64 nChunkSize=N_CHUNK_SIZE;
+        qint64 nDeviceSize=pDevice->size();
+
+        QByteArray baBuffer;
+        baBuffer.resize(nChunkSize+nMaxSize-1);
+
+        int nNumberOfRecords=pMemoryMap->listRecords.count();
+
+        bool bStop=false;
+
+        if(!pbStop)
+        {
+            pbStop=&bStop;
+        }
+
+        for(int i=0;(i<nNumberOfRecords)&&(!(*pbStop));i++)
+        {
+            qint64 nRegionOffset=pMemoryMap->listRecords.at(i).nOffset;
+            qint64 nRegionAddress=pMemoryMap->listRecords.at(i).nAddress;
+            qint64 nRegionSize=pMemoryMap->listRecords.at(i).nSize;
+
+            if((nRegionOffset!=-1)&&(nRegionAddress!=-1)&&(nRegionOffset<nDeviceSize))
+            {
+                nRegionSize=qMin(nRegionSize,nDeviceSize-nRegionOffset);
+
+                for(qint64 j=0;(j<nRegionSize)&&(!(*pbStop));j+=nChunkSize)
+                {
+                    // The next chunk starts with a fresh state, the tail keeps the matches that cross the border
+                    qint64 nPositions=qMin(nChunkSize,nRegionSize-j);
+                    qint64 nReadSize=qMin(nPositions+nMaxSize-1,nRegionSize-j);
+
+                    qint64 nDataSize=XBinary::read_array(pDevice,nRegionOffset+j,baBuffer.data(),nReadSize);
+
+                    scan(baBuffer.constData(),nDataSize,nPositions,nRegionAddress+j,&listResult);
+                }
+            }
+        }
+    }
+
+    return listResult;
+}
+
+void XDisasmSignatureScanner::scan(const char *pData, qint64 nDataSize, qint64 nPositions, qint64 nAddress, QList<XDisasmSignatureScanner::MATCH> *pListMatches)
+{
+    const quint8 *pBytes=(const quint8 *)pData;
+
+    qint32 nNode=0;
+
+    for(qint64 i=0;i<nDataSize;i++)
+    {
+        nNode=_getNext(nNode,pBytes[i]);
+
+        qint32 nOutputNode=listNodes.at(nNode).nNumberOfOutputs?nNode:listNodes.at(nNode).nOutputLink;
+
+        while(nOutputNode!=-1)
+        {
+            const NODE *pNode=&(listNodes.at(nOutputNode));
+
+            for(qint32 j=0;j<pNode->nNumberOfOutputs;j++)
+            {
+                qint32 nSignature=listOutputs.at(pNode->nFirstOutput+j);
+                const SIGNATURE *pSignature=&(listSignatures.at(nSignature));
+
+                qint64 nStart=i-(pSignature->nKeySize-1)-pSignature->nKeyOffset;
+
+                if( (nStart>=0)&&(nStart<nPositions)&&
+                    ((nStart+pSignature->pattern.baValues.size())<=nDataSize)&&
+                    XDisasmSearch::compare(pBytes+nStart,&(pSignature->pattern)))
+                {
+                    MATCH match={};
+                    match.nAddress=nAddress+nStart;
+                    match.nSignature=nSignature;
+
+                    pListMatches->append(match);
+                }
+            }
+
+            nOutputNode=pNode->nOutputLink;
+        }
+    }
+}
+
+bool XDisasmSignatureScanner::isCodeAddress(XDisasm::STATS *pStats, qint64 nAddress)
+{
+    bool bResult=true;
+
+    // The record at or before the address
+    QMap<qint64,XDisasm::RECORD>::const_iterator iterRecord=pStats->mapRecords.upperBound(nAddress);
+
+    if(iterRecord!=pStats->mapRecords.constBegin())
+    {
+        --iterRecord;
+
+        if((iterRecord.key()+iterRecord.value().nSize)>nAddress)
+        {
+            bResult=(iterRecord.value().type==XDisasm::RECORD_TYPE_OPCODE)&&(iterRecord.key()==nAddress);
+        }
+    }
+
+    QMap<qint64,qint64>::const_iterator iterRange=pStats->mapDataRanges.upperBound(nAddress);
+
+    if(bResult&&(iterRange!=pStats->mapDataRanges.constBegin()))
+    {
+        --iterRange;
+
+        bResult=((iterRange.key()+iterRange.value())<=nAddress);
+    }
+
+    return bResult;
+}
+
+qint32 XDisasmSignatureScanner::filter(XDisasm::STATS *pStats, QList<XDisasmSignatureScanner::MATCH> *pListMatches)
+{
+    qint32 nResult=0;
+
+    QList<MATCH> listMatches;
+
+    int nNumberOfMatches=pListMatches->count();
+
+    for(int i=0;i<nNumberOfMatches;i++)
+    {
+        if(isCodeAddress(pStats,pListMatches->at(i).nAddress))
+        {
+            listMatches.append(pListMatches->at(i));
+        }
+        else
+        {
+            nResult++;
+        }
+    }
+
+    *pListMatches=listMatches;
+
+    return nResult;
+}
+
+qint32 XDisasmSignatureScanner::apply(XDisasm::STATS *pStats, QList<XDisasmSignatureScanner::MATCH> *pListMatches)
+{
+    qint32 nResult=0;
+
+    // A match inside of data or of an instruction would become a permanent root
+    filter(pStats,pListMatches);
+
+    QSet<qint64> stRoots;
+
+    int nNumberOfRoots=pStats->listRoots.count();
+
+    for(int i=0;i<nNumberOfRoots;i++)
+    {
+        stRoots.insert(pStats->listRoots.at(i));
+    }
+
+    int nNumberOfMatches=pListMatches->count();
+
+    for(int i=0;i<nNumberOfMatches;i++)
+    {
+        qint64 nAddress=pListMatches->at(i).nAddress;
+
+        // Names given by the user win, the label list is rebuilt by the next XDisasm run
+        if(!pStats->mapUserLabels.contains(nAddress))
+        {
+            pStats->mapUserLabels.insert(nAddress,XDisasm::addName(pStats,getName(pListMatches->at(i).nSignature)));
+        }
+
+        if(!stRoots.contains(nAddress))
+        {
+            stRoots.insert(nAddress);
+            pStats->listRoots.append(nAddress);
+
+            nResult++;
+        }
+    }
+
+    return nResult;
+}
+
+qint32 XDisasmSignatureScanner::_getNext(qint32 nNode, quint8 nByte)
+{
+    qint32 nResult=0;
+
+    while(true)
+    {
+        if(nNode==0)
+        {
+            nResult=rootNodes[nByte];
+
+            break;
+        }
+
+        const NODE *pNode=&(listNodes.at(nNode));
+        const EDGE *pBegin=listEdges.constData()+pNode->nFirstEdge;
+        const EDGE *pEnd=pBegin+pNode->nNumberOfEdges;
+
+        const EDGE *pEdge=std::lower_bound(pBegin,pEnd,nByte,[](const EDGE &edge,quint8 nValue){return edge.nByte<nValue;});
+
+        if((pEdge!=pEnd)&&(pEdge->nByte==nByte))
+        {
+            nResult=pEdge->nNode;
+
+            break;
+        }
+
+        nNode=pNode->nFail;
+    }
+
+    return nResult;
+}
+
+qint32 XDisasmSignatureScanner::_findEdge(QVector<XDisasmSignatureScanner::EDGE> *pListEdges, quint8 nByte)
+{
+    qint32 nResult=-1;
+
+    int nNumberOfEdges=pListEdges->count();
+
+    for(int i=0;i<nNumberOfEdges;i++)
+    {
+        if(pListEdges->at(i).nByte==nByte)
+        {
+            nResult=pListEdges->at(i).nNode;
+
+            break;
+        }
+    }
+
+    return nResult;
+}
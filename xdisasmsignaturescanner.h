@@ -0,0 +1,91 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef XDISASMSIGNATURESCANNER_H
+#define XDISASMSIGNATURESCANNER_H
+
+#include <QFile>
+#include <QTextStream>
+#include "xdisasmsearch.h"
+
+// Matches a library of signatures in one pass: an Aho-Corasick automaton over the longest
+// fixed run of every signature, the whole signature is verified at each hit.
+class XDisasmSignatureScanner
+{
+    static const qint64 N_CHUNK_SIZE=0x100000;
+
+public:
+    struct SIGNATURE
+    {
+        QString sName;
+        XDisasmSearch::PATTERN pattern;
+        qint32 nKeyOffset; // the fixed run
+        qint32 nKeySize;
+    };
+
+    struct MATCH
+    {
+        qint64 nAddress;
+        qint32 nSignature;
+    };
+
+    XDisasmSignatureScanner();
+    bool addSignature(QString sName,QString sSignature,QChar cWild='.');
+    qint32 loadFile(QString sFileName,QChar cWild='.'); // lines: name=signature, returns the number of valid signatures
+    qint32 getNumberOfSignatures();
+    QString getName(qint32 nSignature);
+    void compile();
+    QList<MATCH> scan(QIODevice *pDevice,XBinary::_MEMORY_MAP *pMemoryMap,bool *pbStop=nullptr);
+    void scan(const char *pData,qint64 nDataSize,qint64 nPositions,qint64 nAddress,QList<MATCH> *pListMatches);
+    static bool isCodeAddress(XDisasm::STATS *pStats,qint64 nAddress); // not decoded as data, not a data range, not inside of an instruction
+    static qint32 filter(XDisasm::STATS *pStats,QList<MATCH> *pListMatches); // keeps the matches at code addresses, returns the number of removed
+    qint32 apply(XDisasm::STATS *pStats,QList<MATCH> *pListMatches); // filtered, user labels and roots for the next run, returns the number of new roots
+
+private:
+    struct NODE
+    {
+        qint32 nFirstEdge;
+        qint32 nNumberOfEdges;
+        qint32 nFail;
+        qint32 nOutputLink; // the nearest node on the fail chain with outputs, -1 if none
+        qint32 nFirstOutput;
+        qint32 nNumberOfOutputs;
+    };
+
+    struct EDGE
+    {
+        quint8 nByte;
+        qint32 nNode;
+    };
+
+    qint32 _getNext(qint32 nNode,quint8 nByte);
+    static qint32 _findEdge(QVector<EDGE> *pListEdges,quint8 nByte);
+
+private:
+    QVector<SIGNATURE> listSignatures;
+    qint32 nMaxSize;
+    bool bCompiled;
+    QVector<NODE> listNodes; // 0 - root
+    QVector<EDGE> listEdges; // sorted by byte per node
+    QVector<qint32> listOutputs; // signature indexes
+    qint32 rootNodes[256];
+};
+
+#endif // XDISASMSIGNATURESCANNER_H
@@ -0,0 +1,347 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "xdisasmstringscanner.h"
+
+#if defined(__SSE2__)||defined(_M_X64)||(defined(_M_IX86_FP)&&(_M_IX86_FP>=2))
+#define XDISASMSTRINGSCANNER_SSE2
+#include <emmintrin.h>
+#endif
+
+XDisasmStringScanner::XDisasmStringScanner()
+{
+    pDevice=0;
+    nMinLength=0;
+    pbStop=0;
+}
+
+QVector<XDisasm::STRING> XDisasmStringScanner::scan(QIODevice *pDevice, XBinary::_MEMORY_MAP *pMemoryMap, qint32 nMinLength, qint32 nThreads, bool *pbStop)
+{
+    XDISASM_TRACE("XDisasmStringScanner::scan");
+
+    this->pDevice=pDevice;
+    this->nMinLength=qMax(nMinLength,1);
+    this->pbStop=pbStop;
+
+    QFile *pFile=dynamic_cast<QFile *>(pDevice);
+
+    sFileName=pFile?pFile->fileName():QString();
+
+    listChunks.clear();
+    listResults.clear();
+    nCurrentChunk=0;
+
+    qint64 nChunkSize=N_CHUNK_SIZE;
+    qint64 nMaxString=N_MAX_STRING;
+    qint64 nDeviceSize=pDevice->size();
+
+    int nNumberOfRecords=pMemoryMap->listRecords.count();
+
+    for(int i=0;i<nNumberOfRecords;i++)
+    {
+        qint64 nRegionOffset=pMemoryMap->listRecords.at(i).nOffset;
+        qint64 nRegionAddress=pMemoryMap->listRecords.at(i).nAddress;
+        qint64 nRegionSize=pMemoryMap->listRecords.at(i).nSize;
+
+        if((nRegionOffset!=-1)&&(nRegionAddress!=-1)&&(nRegionOffset<nDeviceSize))
+        {
+            nRegionSize=qMin(nRegionSize,nDeviceSize-nRegionOffset);
+
+            for(qint64 j=0;j<nRegionSize;j+=nChunkSize)
+            {
+                CHUNK chunk={};
+                chunk.nLead=qMin(j,(qint64)N_LEAD);
+                chunk.nOffset=nRegionOffset+j-chunk.nLead;
+                chunk.nAddress=nRegionAddress+j-chunk.nLead;
+                chunk.nSize=qMin(nChunkSize,nRegionSize-j);
+                chunk.nReadSize=chunk.nLead+chunk.nSize+qMin(nMaxString,nRegionSize-j-chunk.nSize);
+
+                listChunks.append(chunk);
+            }
+        }
+    }
+
+    if(nThreads<=0)
+    {
+        nThreads=QThread::idealThreadCount();
+    }
+
+    nThreads=qMin(nThreads,qMax(listChunks.count(),1));
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(nThreads);
+
+    for(int i=0;i<nThreads;i++)
+    {
+        QtConcurrent::run(&threadPool,this,&XDisasmStringScanner::_worker);
+    }
+
+    threadPool.waitForDone();
+
+    std::sort(listResults.begin(),listResults.end(),_stringLessThan);
+
+    QVector<XDisasm::STRING> listResult;
+    listResult.swap(listResults);
+
+    return listResult;
+}
+
+void XDisasmStringScanner::scan(const char *pData, qint64 nDataSize, qint64 nBegin, qint64 nEnd, qint64 nAddress, qint32 nMinLength, QVector<XDisasm::STRING> *pListStrings)
+{
+    qint64 nNumberOfWords=(nDataSize+63)/64;
+
+    QVector<quint64> listPrintable(nNumberOfWords+1);
+    QVector<quint64> listZero(nNumberOfWords+1);
+    QVector<quint64> listUnicode(nNumberOfWords+1);
+
+    quint64 *pPrintable=listPrintable.data();
+    quint64 *pZero=listZero.data();
+    quint64 *pUnicode=listUnicode.data();
+
+    _getMasks((const quint8 *)pData,nDataSize,pPrintable,pZero);
+
+    // A UTF-16LE character: a printable byte followed by a zero byte
+    for(qint64 i=0;i<nNumberOfWords;i++)
+    {
+        pUnicode[i]=pPrintable[i]&((pZero[i]>>1)|(pZero[i+1]<<63));
+    }
+
+    XDisasm::STRING string={};
+
+    // ANSI: a run of printable bytes and a zero byte
+    for(qint64 i=0;i<nDataSize;)
+    {
+        qint64 nStart=_findBit(pPrintable,nDataSize,i,true);
+
+        if(nStart>=nDataSize)
+        {
+            break;
+        }
+
+        qint64 nRunEnd=_findBit(pPrintable,nDataSize,nStart,false);
+
+        if((nStart>=nBegin)&&(nStart<nEnd)&&((nRunEnd-nStart)>=nMinLength)&&(nRunEnd<nDataSize)&&_isBit(pZero,nRunEnd))
+        {
+            string.nAddress=nAddress+nStart;
+            string.nSize=(qint32)(nRunEnd-nStart+1);
+            string.st=XDisasm::ST_ANSI;
+
+            pListStrings->append(string);
+        }
+
+        i=nRunEnd;
+    }
+
+    // UTF-16LE: the characters are 2 bytes apart, the runs are followed on the mask
+    for(qint64 i=0;i<nDataSize;)
+    {
+        qint64 nStart=_findBit(pUnicode,nDataSize,i,true);
+
+        if(nStart>=nDataSize)
+        {
+            break;
+        }
+
+        qint64 nRunEnd=nStart;
+
+        while((nRunEnd<nDataSize)&&_isBit(pUnicode,nRunEnd))
+        {
+            nRunEnd+=2;
+        }
+
+        qint64 nLength=(nRunEnd-nStart)/2;
+
+        if(nLength>=nMinLength)
+        {
+            if((nStart>=nBegin)&&(nStart<nEnd)&&((nRunEnd+1)<nDataSize)&&_isBit(pZero,nRunEnd)&&_isBit(pZero,nRunEnd+1))
+            {
+                string.nAddress=nAddress+nStart;
+                string.nSize=(qint32)(nRunEnd-nStart+2);
+                string.st=XDisasm::ST_UNICODE;
+
+                pListStrings->append(string);
+            }
+
+            i=nRunEnd;
+        }
+        else
+        {
+            i=nStart+1;
+        }
+    }
+}
+
+void XDisasmStringScanner::_worker()
+{
+    XDISASM_TRACE("XDisasmStringScanner::_worker");
+
+    QFile file;
+    QIODevice *pWorkerDevice=pDevice;
+
+    if(sFileName!="")
+    {
+        file.setFileName(sFileName);
+
+        if(file.open(QIODevice::ReadOnly))
+        {
+            pWorkerDevice=&file;
+        }
+    }
+
+    bool bLockDevice=(pWorkerDevice==pDevice);
+
+    QByteArray baBuffer;
+    baBuffer.resize(N_LEAD+N_CHUNK_SIZE+N_MAX_STRING);
+
+    QVector<XDisasm::STRING> listStrings;
+
+    int nNumberOfChunks=listChunks.count();
+
+    while(!(*pbStop))
+    {
+        int nIndex=nCurrentChunk.fetchAndAddOrdered(1);
+
+        if(nIndex>=nNumberOfChunks)
+        {
+            break;
+        }
+
+        const CHUNK &chunk=listChunks.at(nIndex);
+
+        if(bLockDevice) mutexDevice.lock();
+        qint64 nDataSize=XBinary::read_array(pWorkerDevice,chunk.nOffset,baBuffer.data(),chunk.nReadSize);
+        if(bLockDevice) mutexDevice.unlock();
+
+        if(nDataSize>0)
+        {
+            scan(baBuffer.constData(),nDataSize,chunk.nLead,chunk.nLead+chunk.nSize,chunk.nAddress,nMinLength,&listStrings);
+        }
+    }
+
+    QMutexLocker locker(&mutex);
+
+    listResults+=listStrings;
+}
+
+void XDisasmStringScanner::_getMasks(const quint8 *pData, qint64 nDataSize, quint64 *pPrintable, quint64 *pZero)
+{
+    qint64 i=0;
+
+#ifdef XDISASMSTRINGSCANNER_SSE2
+    // Signed compares: 0x80-0xFF are negative and fail the 0x20 bound
+    const __m128i low=_mm_set1_epi8(0x1F);
+    const __m128i high=_mm_set1_epi8(0x7F);
+    const __m128i tab=_mm_set1_epi8(0x09);
+    const __m128i lf=_mm_set1_epi8(0x0A);
+    const __m128i cr=_mm_set1_epi8(0x0D);
+    const __m128i zero=_mm_setzero_si128();
+
+    for(;(i+64)<=nDataSize;i+=64)
+    {
+        quint64 nPrintable=0;
+        quint64 nZero=0;
+
+        for(int j=0;j<4;j++)
+        {
+            __m128i data=_mm_loadu_si128((const __m128i *)(pData+i+j*16));
+
+            __m128i printable=_mm_and_si128(_mm_cmpgt_epi8(data,low),_mm_cmplt_epi8(data,high));
+            printable=_mm_or_si128(printable,_mm_or_si128(_mm_cmpeq_epi8(data,tab),_mm_or_si128(_mm_cmpeq_epi8(data,lf),_mm_cmpeq_epi8(data,cr))));
+
+            nPrintable|=((quint64)(quint16)_mm_movemask_epi8(printable))<<(j*16);
+            nZero|=((quint64)(quint16)_mm_movemask_epi8(_mm_cmpeq_epi8(data,zero)))<<(j*16);
+        }
+
+        pPrintable[i/64]=nPrintable;
+        pZero[i/64]=nZero;
+    }
+#endif
+
+    for(;i<nDataSize;i+=64)
+    {
+        quint64 nPrintable=0;
+        quint64 nZero=0;
+
+        qint64 nCount=qMin((qint64)64,nDataSize-i);
+
+        for(qint64 j=0;j<nCount;j++)
+        {
+            quint8 nByte=pData[i+j];
+
+            if(((nByte>=0x20)&&(nByte<0x7F))||(nByte==0x09)||(nByte==0x0A)||(nByte==0x0D))
+            {
+                nPrintable|=((quint64)1)<<j;
+            }
+
+            if(nByte==0)
+            {
+                nZero|=((quint64)1)<<j;
+            }
+        }
+
+        pPrintable[i/64]=nPrintable;
+        pZero[i/64]=nZero;
+    }
+}
+
+qint64 XDisasmStringScanner::_findBit(const quint64 *pMask, qint64 nNumberOfBits, qint64 nStart, bool bValue)
+{
+    qint64 nResult=nNumberOfBits;
+
+    qint64 nWord=nStart/64;
+    qint64 nNumberOfWords=(nNumberOfBits+63)/64;
+
+    if(nWord<nNumberOfWords)
+    {
+        quint64 nBits=bValue?pMask[nWord]:~pMask[nWord];
+        nBits&=(~(quint64)0)<<(nStart%64);
+
+        while(true)
+        {
+            if(nBits)
+            {
+                nResult=qMin(nWord*64+qCountTrailingZeroBits(nBits),nNumberOfBits);
+
+                break;
+            }
+
+            nWord++;
+
+            if(nWord>=nNumberOfWords)
+            {
+                break;
+            }
+
+            nBits=bValue?pMask[nWord]:~pMask[nWord];
+        }
+    }
+
+    return nResult;
+}
+
+bool XDisasmStringScanner::_isBit(const quint64 *pMask, qint64 nBit)
+{
+    return (pMask[nBit/64]>>(nBit%64))&1;
+}
+
+bool XDisasmStringScanner::_stringLessThan(const XDisasm::STRING &string1, const XDisasm::STRING &string2)
+{
+    return string1.nAddress<string2.nAddress;
+}
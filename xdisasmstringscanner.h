@@ -0,0 +1,72 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef XDISASMSTRINGSCANNER_H
+#define XDISASMSTRINGSCANNER_H
+
+#include <QFile>
+#include <QMutex>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include "xdisasm.h"
+
+// Finds 0-terminated ANSI and UTF-16LE strings in the file-backed regions of a memory map.
+// The chunks are scanned in parallel; per chunk the bytes are turned into two bit masks
+// (printable, zero) and the runs are found on the masks, 64 bytes at a time.
+class XDisasmStringScanner
+{
+    static const qint64 N_CHUNK_SIZE=0x100000;
+    static const qint64 N_MAX_STRING=0x2000; // bytes, longer strings are not reported
+    static const qint64 N_LEAD=2; // bytes before a chunk: a string that starts there belongs to the previous chunk
+
+public:
+    XDisasmStringScanner();
+    QVector<XDisasm::STRING> scan(QIODevice *pDevice,XBinary::_MEMORY_MAP *pMemoryMap,qint32 nMinLength,qint32 nThreads,bool *pbStop); // sorted by address
+    static void scan(const char *pData,qint64 nDataSize,qint64 nBegin,qint64 nEnd,qint64 nAddress,qint32 nMinLength,QVector<XDisasm::STRING> *pListStrings); // strings that start in [nBegin,nEnd)
+
+private:
+    struct CHUNK
+    {
+        qint64 nOffset; // of the read, nLead bytes before the chunk
+        qint64 nAddress;
+        qint64 nLead;
+        qint64 nSize;
+        qint64 nReadSize;
+    };
+
+    void _worker();
+    static void _getMasks(const quint8 *pData,qint64 nDataSize,quint64 *pPrintable,quint64 *pZero);
+    static qint64 _findBit(const quint64 *pMask,qint64 nNumberOfBits,qint64 nStart,bool bValue); // nNumberOfBits if not found
+    static bool _isBit(const quint64 *pMask,qint64 nBit);
+    static bool _stringLessThan(const XDisasm::STRING &string1,const XDisasm::STRING &string2);
+
+private:
+    QIODevice *pDevice;
+    QString sFileName; // the workers open their own file if the device is a file
+    qint32 nMinLength;
+    bool *pbStop;
+    QVector<CHUNK> listChunks;
+    QAtomicInt nCurrentChunk;
+    QMutex mutexDevice;
+    QMutex mutex;
+    QVector<XDisasm::STRING> listResults;
+};
+
+#endif // XDISASMSTRINGSCANNER_H
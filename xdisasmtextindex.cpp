@@ -0,0 +1,497 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "xdisasmtextindex.h"
+
+XDisasmTextIndex::XDisasmTextIndex(QObject *pParent) : QObject(pParent)
+{
+    pDevice=0;
+    csarch=CS_ARCH_X86;
+    csmode=CS_MODE_32;
+    bStop=false;
+    nNumberOfChunks=0;
+}
+
+XDisasmTextIndex::~XDisasmTextIndex()
+{
+
+}
+
+void XDisasmTextIndex::setData(QIODevice *pDevice, XDisasm::STATS *pStats)
+{
+    this->pDevice=pDevice;
+
+    QFile *pFile=dynamic_cast<QFile *>(pDevice);
+
+    sFileName=pFile?pFile->fileName():QString();
+
+    baDevice.clear();
+
+    if(!pFile)
+    {
+        QBuffer *pBuffer=dynamic_cast<QBuffer *>(pDevice);
+
+        if(pBuffer)
+        {
+            baDevice=pBuffer->data(); // implicitly shared
+        }
+        else
+        {
+            baDevice.resize(pDevice->size());
+            baDevice.resize(qMax(XBinary::read_array(pDevice,0,baDevice.data(),baDevice.size()),(qint64)0));
+        }
+    }
+
+    // Implicitly shared, the analysis can go on while the index is built
+    mapRecords=pStats->mapRecords;
+    csarch=pStats->csarch;
+    csmode=pStats->csmode;
+
+    nReady.storeRelease(0);
+}
+
+void XDisasmTextIndex::stop()
+{
+    bStop=true;
+}
+
+bool XDisasmTextIndex::isReady()
+{
+    return nReady.loadAcquire();
+}
+
+qint64 XDisasmTextIndex::getNumberOfInstructions()
+{
+    qint64 nResult=0;
+
+    if(isReady())
+    {
+        nResult=listAddresses.count();
+    }
+
+    return nResult;
+}
+
+XDisasmTextIndex::RESULT XDisasmTextIndex::query(XDisasmTextIndex::QT queryType, QString sText, qint32 nThreads)
+{
+    XDISASM_TRACE("XDisasmTextIndex::query");
+
+    QElapsedTimer timer;
+    timer.start();
+
+    RESULT result={};
+
+    if(isReady())
+    {
+        sText=sText.trimmed();
+
+        if(queryType==QT_MNEMONIC)
+        {
+            qint32 nKey=hashMnemonics.value(sText.toLower(),-1);
+
+            if(nKey!=-1)
+            {
+                _addRows(&listMnemonicOffsets,&listMnemonicRows,nKey,&(result.listAddresses));
+
+                result.bValid=true;
+            }
+        }
+        else if(queryType==QT_REGISTER)
+        {
+            qint32 nKey=hashRegisters.value(sText.toLower(),-1);
+
+            if(nKey!=-1)
+            {
+                _addRows(&listRegisterOffsets,&listRegisterRows,nKey,&(result.listAddresses));
+
+                result.bValid=true;
+            }
+        }
+        else if(queryType==QT_VALUE)
+        {
+            qint64 nValue=sText.toLongLong(&(result.bValid),0);
+
+            if(result.bValid)
+            {
+                VALUE value={};
+                value.nValue=nValue;
+
+                QVector<VALUE>::const_iterator iterBegin=std::lower_bound(listValues.constBegin(),listValues.constEnd(),value,_valueLessThan);
+
+                QVector<qint32> listRows;
+
+                for(QVector<VALUE>::const_iterator iter=iterBegin;(iter!=listValues.constEnd())&&(iter->nValue==nValue);++iter)
+                {
+                    listRows.append(iter->nRow);
+                }
+
+                std::sort(listRows.begin(),listRows.end());
+                listRows.erase(std::unique(listRows.begin(),listRows.end()),listRows.end());
+
+                int nNumberOfRows=listRows.count();
+
+                for(int i=0;i<nNumberOfRows;i++)
+                {
+                    result.listAddresses.append(listAddresses.at(listRows.at(i)));
+                }
+            }
+        }
+        else if(queryType==QT_REGEX)
+        {
+            regex=QRegularExpression(sText,QRegularExpression::CaseInsensitiveOption);
+
+            result.bValid=regex.isValid();
+
+            if(result.bValid)
+            {
+                bStop=false;
+                listRegexResults.clear();
+                nCurrentChunk=0;
+                nNumberOfChunks=(listAddresses.count()+N_CHUNK_SIZE-1)/N_CHUNK_SIZE;
+
+                if(nThreads<=0)
+                {
+                    nThreads=QThread::idealThreadCount();
+                }
+
+                nThreads=qMin(nThreads,qMax(nNumberOfChunks,1));
+
+                QThreadPool threadPool;
+                threadPool.setMaxThreadCount(nThreads);
+
+                for(int i=0;i<nThreads;i++)
+                {
+                    QtConcurrent::run(&threadPool,this,&XDisasmTextIndex::_regexWorker);
+                }
+
+                threadPool.waitForDone();
+
+                result.listAddresses=listRegexResults;
+                listRegexResults.clear();
+
+                std::sort(result.listAddresses.begin(),result.listAddresses.end());
+            }
+        }
+    }
+
+    result.nTime=timer.elapsed();
+
+    return result;
+}
+
+QString XDisasmTextIndex::queryTypeToString(XDisasmTextIndex::QT queryType)
+{
+    QString sResult;
+
+    switch(queryType)
+    {
+        case QT_MNEMONIC:   sResult=tr("Mnemonic");     break;
+        case QT_REGISTER:   sResult=tr("Register");     break;
+        case QT_VALUE:      sResult=tr("Value");        break;
+        case QT_REGEX:      sResult=tr("Regex");        break;
+    }
+
+    return sResult;
+}
+
+void XDisasmTextIndex::process()
+{
+    XDISASM_TRACE("XDisasmTextIndex::process");
+
+    bStop=false;
+    nReady.storeRelease(0);
+
+    listAddresses.clear();
+    baBytes.clear();
+    listByteOffsets.clear();
+    listValues.clear();
+    hashMnemonics.clear();
+    hashRegisters.clear();
+
+    // The shared device is never read here
+    QFile file;
+    QBuffer buffer;
+    QIODevice *_pDevice=&buffer;
+
+    buffer.setData(baDevice);
+    buffer.open(QIODevice::ReadOnly);
+
+    if(sFileName!="")
+    {
+        file.setFileName(sFileName);
+
+        if(file.open(QIODevice::ReadOnly))
+        {
+            _pDevice=&file;
+        }
+    }
+
+    csh disasm_handle=0;
+
+    if(cs_open(csarch,csmode,&disasm_handle)==CS_ERR_OK)
+    {
+        cs_option(disasm_handle,CS_OPT_DETAIL,CS_OPT_ON);
+
+        for(qint32 i=1;i<X86_INS_ENDING;i++)
+        {
+            const char *pszName=cs_insn_name(disasm_handle,i);
+
+            if(pszName)
+            {
+                hashMnemonics.insert(QString(pszName),i);
+            }
+        }
+
+        for(qint32 i=1;i<X86_REG_ENDING;i++)
+        {
+            const char *pszName=cs_reg_name(disasm_handle,i);
+
+            if(pszName)
+            {
+                hashRegisters.insert(QString(pszName),i);
+            }
+        }
+
+        qint32 nNumberOfRecords=mapRecords.count();
+
+        listAddresses.reserve(nNumberOfRecords);
+        listByteOffsets.reserve(nNumberOfRecords+1);
+        listByteOffsets.append(0);
+
+        QVector<KEY> listMnemonicKeys;
+        QVector<KEY> listRegisterKeys;
+        listMnemonicKeys.reserve(nNumberOfRecords);
+
+        // Instructions are read through a window, they are mostly sequential in the file
+        const qint64 N_WINDOW_SIZE=0x10000;
+
+        QByteArray baWindow;
+        baWindow.resize(N_WINDOW_SIZE);
+        qint64 nWindowOffset=-1;
+        qint64 nWindowSize=0;
+
+        QMap<qint64,XDisasm::RECORD>::const_iterator iter=mapRecords.constBegin();
+
+        for(;(iter!=mapRecords.constEnd())&&(!bStop);++iter)
+        {
+            const XDisasm::RECORD &record=iter.value();
+
+            if(record.type==XDisasm::RECORD_TYPE_OPCODE)
+            {
+                if((nWindowOffset==-1)||(record.nOffset<nWindowOffset)||((record.nOffset+record.nSize)>(nWindowOffset+nWindowSize)))
+                {
+                    nWindowOffset=record.nOffset;
+                    nWindowSize=XBinary::read_array(_pDevice,nWindowOffset,baWindow.data(),N_WINDOW_SIZE);
+                }
+
+                if((record.nOffset+record.nSize)<=(nWindowOffset+nWindowSize))
+                {
+                    const char *pData=baWindow.constData()+(record.nOffset-nWindowOffset);
+
+                    cs_insn *insn;
+                    size_t count=cs_disasm(disasm_handle,(const uint8_t *)pData,record.nSize,iter.key(),1,&insn);
+
+                    if(count>0)
+                    {
+                        qint32 nRow=listAddresses.count();
+
+                        listAddresses.append(iter.key());
+                        baBytes.append(pData,record.nSize);
+                        listByteOffsets.append(baBytes.size());
+
+                        KEY key={};
+                        key.nKey=insn->id;
+                        key.nRow=nRow;
+                        listMnemonicKeys.append(key);
+
+                        qint32 nFirstRegister=listRegisterKeys.count();
+
+                        for(int i=0;i<insn->detail->x86.op_count;i++)
+                        {
+                            const cs_x86_op *pOperand=&(insn->detail->x86.operands[i]);
+
+                            QList<qint32> listRegisters;
+
+                            VALUE value={};
+                            value.nRow=nRow;
+
+                            if(pOperand->type==X86_OP_REG)
+                            {
+                                listRegisters.append(pOperand->reg);
+                            }
+                            else if(pOperand->type==X86_OP_IMM)
+                            {
+                                value.nValue=pOperand->imm;
+                                listValues.append(value);
+                            }
+                            else if(pOperand->type==X86_OP_MEM)
+                            {
+                                listRegisters.append(pOperand->mem.base);
+                                listRegisters.append(pOperand->mem.index);
+
+                                if(pOperand->mem.disp)
+                                {
+                                    value.nValue=pOperand->mem.disp;
+                                    listValues.append(value);
+                                }
+
+                                if(pOperand->mem.base==X86_REG_RIP)
+                                {
+                                    value.nValue=iter.key()+insn->size+pOperand->mem.disp;
+                                    listValues.append(value);
+                                }
+                            }
+
+                            int nNumberOfRegisters=listRegisters.count();
+
+                            for(int j=0;j<nNumberOfRegisters;j++)
+                            {
+                                qint32 nRegister=listRegisters.at(j);
+
+                                bool bPresent=(nRegister==X86_REG_INVALID);
+
+                                for(qint32 k=nFirstRegister;(k<listRegisterKeys.count())&&(!bPresent);k++)
+                                {
+                                    bPresent=(listRegisterKeys.at(k).nKey==nRegister);
+                                }
+
+                                if(!bPresent)
+                                {
+                                    key.nKey=nRegister;
+                                    listRegisterKeys.append(key);
+                                }
+                            }
+                        }
+
+                        cs_free(insn,count);
+                    }
+                }
+            }
+        }
+
+        _buildPostings(&listMnemonicKeys,X86_INS_ENDING,&listMnemonicOffsets,&listMnemonicRows);
+        _buildPostings(&listRegisterKeys,X86_REG_ENDING,&listRegisterOffsets,&listRegisterRows);
+
+        std::sort(listValues.begin(),listValues.end(),_valueLessThan);
+
+        listAddresses.squeeze();
+        baBytes.squeeze();
+        listValues.squeeze();
+
+        cs_close(&disasm_handle);
+    }
+
+    if(!bStop)
+    {
+        nReady.storeRelease(1);
+    }
+
+    emit processFinished();
+}
+
+void XDisasmTextIndex::_buildPostings(QVector<XDisasmTextIndex::KEY> *pListKeys, qint32 nNumberOfKeys, QVector<qint32> *pListOffsets, QVector<qint32> *pListRows)
+{
+    // Counting sort, the rows stay in address order
+    pListOffsets->fill(0,nNumberOfKeys+1);
+    pListRows->resize(pListKeys->count());
+
+    int nCount=pListKeys->count();
+
+    for(int i=0;i<nCount;i++)
+    {
+        (*pListOffsets)[pListKeys->at(i).nKey+1]++;
+    }
+
+    for(qint32 i=0;i<nNumberOfKeys;i++)
+    {
+        (*pListOffsets)[i+1]+=pListOffsets->at(i);
+    }
+
+    QVector<qint32> listFill=*pListOffsets;
+
+    for(int i=0;i<nCount;i++)
+    {
+        (*pListRows)[listFill[pListKeys->at(i).nKey]++]=pListKeys->at(i).nRow;
+    }
+}
+
+void XDisasmTextIndex::_addRows(QVector<qint32> *pListOffsets, QVector<qint32> *pListRows, qint32 nKey, QList<qint64> *pListResults)
+{
+    if((nKey>=0)&&(nKey+1<pListOffsets->count()))
+    {
+        qint32 nEnd=pListOffsets->at(nKey+1);
+
+        for(qint32 i=pListOffsets->at(nKey);i<nEnd;i++)
+        {
+            pListResults->append(listAddresses.at(pListRows->at(i)));
+        }
+    }
+}
+
+bool XDisasmTextIndex::_valueLessThan(const XDisasmTextIndex::VALUE &value1, const XDisasmTextIndex::VALUE &value2)
+{
+    return (value1.nValue<value2.nValue);
+}
+
+void XDisasmTextIndex::_regexWorker()
+{
+    XDISASM_TRACE("XDisasmTextIndex::_regexWorker");
+
+    csh disasm_handle=0;
+
+    if(cs_open(csarch,csmode,&disasm_handle)==CS_ERR_OK)
+    {
+        QRegularExpression _regex=regex;
+
+        QList<qint64> listResults;
+
+        qint32 nNumberOfRows=listAddresses.count();
+
+        while(!bStop)
+        {
+            qint32 nChunk=nCurrentChunk.fetchAndAddOrdered(1);
+
+            if(nChunk>=nNumberOfChunks)
+            {
+                break;
+            }
+
+            qint32 nEnd=qMin(nNumberOfRows,(nChunk+1)*N_CHUNK_SIZE);
+
+            for(qint32 i=nChunk*N_CHUNK_SIZE;i<nEnd;i++)
+            {
+                qint32 nOffset=listByteOffsets.at(i);
+
+                QString sText=XDisasm::getDisasmString(disasm_handle,listAddresses.at(i),(char *)(baBytes.constData()+nOffset),listByteOffsets.at(i+1)-nOffset);
+
+                if(_regex.match(sText).hasMatch())
+                {
+                    listResults.append(listAddresses.at(i));
+                }
+            }
+        }
+
+        cs_close(&disasm_handle);
+
+        QMutexLocker locker(&mutex);
+
+        listRegexResults.append(listResults);
+    }
+}
@@ -0,0 +1,116 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef XDISASMTEXTINDEX_H
+#define XDISASMTEXTINDEX_H
+
+#include <QObject>
+#include <QFile>
+#include <QBuffer>
+#include <QMutex>
+#include <QThreadPool>
+#include <QRegularExpression>
+#include <QtConcurrent>
+#include "xdisasm.h"
+
+// Inverted index over the decoded instructions: mnemonic ids, register ids and values (immediates, displacements).
+// process() builds it from a snapshot of STATS, usually in a background thread.
+class XDisasmTextIndex : public QObject
+{
+    Q_OBJECT
+
+    static const qint32 N_CHUNK_SIZE=0x4000; // instructions per regex task
+
+public:
+    enum QT
+    {
+        QT_MNEMONIC=0,
+        QT_REGISTER,
+        QT_VALUE,
+        QT_REGEX
+    };
+
+    struct RESULT
+    {
+        bool bValid; // the index is ready and the query is valid
+        QList<qint64> listAddresses; // sorted
+        qint64 nTime; // msec
+    };
+
+    explicit XDisasmTextIndex(QObject *pParent=nullptr);
+    ~XDisasmTextIndex();
+    void setData(QIODevice *pDevice,XDisasm::STATS *pStats);
+    void stop();
+    bool isReady();
+    qint64 getNumberOfInstructions();
+    RESULT query(QT queryType,QString sText,qint32 nThreads=0);
+    static QString queryTypeToString(QT queryType);
+
+public slots:
+    void process();
+
+signals:
+    void processFinished();
+
+private:
+    struct KEY
+    {
+        qint32 nKey;
+        qint32 nRow;
+    };
+
+    struct VALUE
+    {
+        qint64 nValue;
+        qint32 nRow;
+    };
+
+    static void _buildPostings(QVector<KEY> *pListKeys,qint32 nNumberOfKeys,QVector<qint32> *pListOffsets,QVector<qint32> *pListRows);
+    void _addRows(QVector<qint32> *pListOffsets,QVector<qint32> *pListRows,qint32 nKey,QList<qint64> *pListResults);
+    static bool _valueLessThan(const VALUE &value1,const VALUE &value2);
+    void _regexWorker();
+
+private:
+    QIODevice *pDevice;
+    QString sFileName; // the worker opens its own file if the device is a file
+    QByteArray baDevice; // otherwise it reads a copy, the model reads the device in the GUI thread meanwhile
+    QMap<qint64,XDisasm::RECORD> mapRecords; // shared copy
+    cs_arch csarch;
+    cs_mode csmode;
+    bool bStop;
+    QAtomicInt nReady;
+    QVector<qint64> listAddresses; // row -> address
+    QByteArray baBytes; // instruction bytes
+    QVector<qint32> listByteOffsets; // row -> baBytes, rows+1
+    QVector<qint32> listMnemonicOffsets;
+    QVector<qint32> listMnemonicRows;
+    QVector<qint32> listRegisterOffsets;
+    QVector<qint32> listRegisterRows;
+    QVector<VALUE> listValues; // sorted by value
+    QHash<QString,qint32> hashMnemonics;
+    QHash<QString,qint32> hashRegisters;
+    QRegularExpression regex; // QT_REGEX
+    qint32 nNumberOfChunks;
+    QAtomicInt nCurrentChunk;
+    QMutex mutex;
+    QList<qint64> listRegexResults;
+};
+
+#endif // XDISASMTEXTINDEX_H
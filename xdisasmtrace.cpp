@@ -0,0 +1,327 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "xdisasmtrace.h"
+
+QAtomicInt XDisasmTrace::nEnabled;
+QElapsedTimer XDisasmTrace::timer;
+QMutex XDisasmTrace::mutexRings;
+QList<XDisasmTrace::RING *> XDisasmTrace::listRings;
+QList<XDisasmTrace::RING *> XDisasmTrace::listFreeRings;
+qint32 XDisasmTrace::nThreadCounter=0;
+thread_local XDisasmTrace::RingOwner XDisasmTrace::currentRing;
+
+XDisasmTrace::RingOwner::~RingOwner()
+{
+    if(pRing)
+    {
+        QMutexLocker locker(&mutexRings);
+
+        pRing->bFinished=true;
+
+        _releaseRings();
+    }
+}
+
+XDisasmTrace::Scope::Scope(const char *pszName)
+{
+    this->pszName=pszName;
+
+    nStart=-1;
+
+    if(isEnabled())
+    {
+        nStart=getTime();
+    }
+}
+
+XDisasmTrace::Scope::~Scope()
+{
+    if(nStart!=-1)
+    {
+        addEvent(pszName,nStart,getTime()-nStart);
+    }
+}
+
+void XDisasmTrace::setEnabled(bool bState)
+{
+    QMutexLocker locker(&mutexRings);
+
+    if(bState&&(!timer.isValid()))
+    {
+        timer.start();
+    }
+
+    nEnabled.storeRelease(bState?1:0);
+}
+
+bool XDisasmTrace::isEnabled()
+{
+    return nEnabled.loadAcquire();
+}
+
+qint64 XDisasmTrace::getTime()
+{
+    return timer.nsecsElapsed();
+}
+
+void XDisasmTrace::addEvent(const char *pszName, qint64 nStart, qint64 nDuration)
+{
+    RING *pRing=currentRing.pRing;
+
+    if(!pRing)
+    {
+        pRing=_getRing();
+    }
+
+    // Only the owner thread writes to the ring
+    quint64 nHead=pRing->nHead.load();
+
+    EVENT *pEvent=&(pRing->events[nHead&(N_RING_SIZE-1)]);
+    pEvent->pszName=pszName;
+    pEvent->nStart=nStart;
+    pEvent->nDuration=nDuration;
+
+    pRing->nHead.storeRelease(nHead+1);
+}
+
+bool XDisasmTrace::writeJson(QIODevice *pDevice)
+{
+    QMutexLocker locker(&mutexRings);
+
+    QTextStream stream(pDevice);
+
+    stream<<"{\"traceEvents\":[";
+
+    bool bFirst=true;
+
+    int nNumberOfRings=listRings.count();
+
+    for(int i=0;i<nNumberOfRings;i++)
+    {
+        RING *pRing=listRings.at(i);
+
+        if(!bFirst)
+        {
+            stream<<",";
+        }
+
+        stream<<QString("\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%1,\"args\":{\"name\":\"%2\"}}").arg(pRing->nThreadId).arg(_escapeJson(pRing->sThreadName));
+
+        bFirst=false;
+
+        quint64 nHead=pRing->nHead.loadAcquire();
+        quint64 nCount=qMin(nHead,(quint64)N_RING_SIZE);
+
+        for(quint64 j=nHead-nCount;j<nHead;j++)
+        {
+            EVENT *pEvent=&(pRing->events[j&(N_RING_SIZE-1)]);
+
+            // Chrome expects microseconds
+            stream<<QString(",\n{\"name\":\"%1\",\"cat\":\"xdisasm\",\"ph\":\"X\",\"pid\":1,\"tid\":%2,\"ts\":%3,\"dur\":%4}")
+                    .arg(pEvent->pszName)
+                    .arg(pRing->nThreadId)
+                    .arg(pEvent->nStart/1000.0,0,'f',3)
+                    .arg(pEvent->nDuration/1000.0,0,'f',3);
+        }
+    }
+
+    stream<<"\n],\"displayTimeUnit\":\"ns\"}\n";
+
+    stream.flush();
+
+    bool bResult=(stream.status()==QTextStream::Ok);
+
+    if(bResult)
+    {
+        for(int i=0;i<nNumberOfRings;i++)
+        {
+            RING *pRing=listRings.at(i);
+
+            pRing->nSaved=pRing->nHead.loadAcquire();
+        }
+
+        _releaseRings();
+    }
+
+    return bResult;
+}
+
+bool XDisasmTrace::save(QString sFileName)
+{
+    bool bResult=false;
+
+    QFile file;
+    file.setFileName(sFileName);
+
+    if(file.open(QIODevice::WriteOnly|QIODevice::Truncate))
+    {
+        bResult=writeJson(&file);
+
+        file.close();
+    }
+
+    return bResult;
+}
+
+void XDisasmTrace::clear()
+{
+    QMutexLocker locker(&mutexRings);
+
+    int nNumberOfRings=listRings.count();
+
+    for(int i=0;i<nNumberOfRings;i++)
+    {
+        RING *pRing=listRings.at(i);
+
+        pRing->nHead.storeRelease(0);
+        pRing->nSaved=0;
+    }
+
+    _releaseRings();
+}
+
+XDisasmTrace::RING *XDisasmTrace::_getRing()
+{
+    QMutexLocker locker(&mutexRings);
+
+    RING *pRing=nullptr;
+
+    if(listFreeRings.count())
+    {
+        pRing=listFreeRings.takeLast();
+    }
+    else if(listRings.count()>=N_MAX_RINGS)
+    {
+        // The events of the finished thread that has been idle the longest are dropped
+        int nOldest=-1;
+        qint64 nOldestTime=0;
+
+        int nNumberOfRings=listRings.count();
+
+        for(int i=0;i<nNumberOfRings;i++)
+        {
+            RING *pCurrent=listRings.at(i);
+
+            if(pCurrent->bFinished)
+            {
+                quint64 nHead=pCurrent->nHead.loadAcquire();
+                qint64 nTime=0;
+
+                if(nHead)
+                {
+                    const EVENT *pEvent=&(pCurrent->events[(nHead-1)&(N_RING_SIZE-1)]);
+
+                    nTime=pEvent->nStart+pEvent->nDuration;
+                }
+
+                if((nOldest==-1)||(nTime<nOldestTime))
+                {
+                    nOldest=i;
+                    nOldestTime=nTime;
+                }
+            }
+        }
+
+        if(nOldest!=-1)
+        {
+            pRing=listRings.takeAt(nOldest);
+        }
+    }
+
+    if(!pRing)
+    {
+        pRing=new RING;
+    }
+
+    nThreadCounter++;
+
+    pRing->nThreadId=nThreadCounter;
+    pRing->sThreadName=QThread::currentThread()->objectName();
+
+    if(pRing->sThreadName=="")
+    {
+        if(QCoreApplication::instance()&&(QThread::currentThread()==QCoreApplication::instance()->thread()))
+        {
+            pRing->sThreadName="Main";
+        }
+        else
+        {
+            pRing->sThreadName=QString("Thread %1").arg(pRing->nThreadId);
+        }
+    }
+
+    pRing->nHead.store(0);
+    pRing->nSaved=0;
+    pRing->bFinished=false;
+
+    listRings.append(pRing);
+
+    currentRing.pRing=pRing;
+
+    return pRing;
+}
+
+void XDisasmTrace::_releaseRings()
+{
+    // mutexRings must be locked. A ring of a finished thread goes to the free list once
+    // all its events are written out; a new thread takes it instead of allocating
+    for(int i=listRings.count()-1;i>=0;i--)
+    {
+        RING *pRing=listRings.at(i);
+
+        if(pRing->bFinished&&(pRing->nSaved==pRing->nHead.loadAcquire()))
+        {
+            listRings.removeAt(i);
+            listFreeRings.append(pRing);
+        }
+    }
+}
+
+QString XDisasmTrace::_escapeJson(QString sString)
+{
+    QString sResult;
+
+    int nNumberOfChars=sString.size();
+
+    for(int i=0;i<nNumberOfChars;i++)
+    {
+        QChar c=sString.at(i);
+
+        if(c==QChar('"'))
+        {
+            sResult+="\\\"";
+        }
+        else if(c==QChar('\\'))
+        {
+            sResult+="\\\\";
+        }
+        else if(c.unicode()<0x20)
+        {
+            sResult+=QString("\\u%1").arg((int)c.unicode(),4,16,QChar('0'));
+        }
+        else
+        {
+            sResult+=c;
+        }
+    }
+
+    return sResult;
+}
@@ -0,0 +1,103 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef XDISASMTRACE_H
+#define XDISASMTRACE_H
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QAtomicInteger>
+#include <QMutex>
+#include <QThread>
+#include <QFile>
+#include <QTextStream>
+
+// Event tracer. Every thread writes complete events into its own ring buffer without locks,
+// the oldest events are overwritten. writeJson produces the Chrome trace event format
+// (chrome://tracing, Perfetto). Call writeJson/clear when the traced threads are idle.
+// The ring of a finished thread is kept until its events are written out, then it is reused.
+// Above N_MAX_RINGS a new thread takes the ring of the finished thread with the oldest events, unsaved or not.
+class XDisasmTrace
+{
+public:
+    static const qint32 N_RING_SIZE=0x10000; // events per thread, power of 2
+    static const qint32 N_MAX_RINGS=64; // more only if more threads are running
+
+    struct EVENT
+    {
+        const char *pszName; // string literal
+        qint64 nStart; // nsec
+        qint64 nDuration; // nsec
+    };
+
+    struct RING
+    {
+        qint32 nThreadId;
+        QString sThreadName;
+        QAtomicInteger<quint64> nHead; // number of events written
+        quint64 nSaved; // nHead at the last writeJson, guarded by mutexRings
+        bool bFinished; // the owner thread has exited, guarded by mutexRings
+        EVENT events[N_RING_SIZE];
+    };
+
+    class Scope
+    {
+    public:
+        explicit Scope(const char *pszName);
+        ~Scope();
+
+    private:
+        const char *pszName;
+        qint64 nStart; // -1 if the tracer is disabled
+    };
+
+    static void setEnabled(bool bState);
+    static bool isEnabled();
+    static qint64 getTime();
+    static void addEvent(const char *pszName,qint64 nStart,qint64 nDuration);
+    static bool writeJson(QIODevice *pDevice);
+    static bool save(QString sFileName);
+    static void clear();
+
+private:
+    class RingOwner
+    {
+    public:
+        ~RingOwner();
+
+        RING *pRing=nullptr;
+    };
+
+    static RING *_getRing();
+    static void _releaseRings();
+    static QString _escapeJson(QString sString);
+
+    static QAtomicInt nEnabled;
+    static QElapsedTimer timer;
+    static QMutex mutexRings;
+    static QList<RING *> listRings;
+    static QList<RING *> listFreeRings;
+    static qint32 nThreadCounter;
+    static thread_local RingOwner currentRing;
+};
+
+#define XDISASM_TRACE(name) XDisasmTrace::Scope xdisasmTraceScope(name)
+
+#endif // XDISASMTRACE_H
@@ -0,0 +1,713 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "xdisasmview.h"
+
+XDisasmView::XDisasmView(QWidget *pParent) : QAbstractScrollArea(pParent)
+{
+    pModel=nullptr;
+    nRowHeight=1;
+    nWheelDelta=0;
+    nTopPosition=0;
+    nCurrentPosition=-1;
+    nSelectionAnchor=-1;
+    nActionTopPosition=-1;
+    bUpdateScrollBars=false;
+    nRowsPosition=-1;
+
+    pHeader=new QHeaderView(Qt::Horizontal,this);
+    pHeader->setSectionsClickable(false);
+    pHeader->setHighlightSections(false);
+
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setMouseTracking(false);
+
+    connect(verticalScrollBar(),SIGNAL(actionTriggered(int)),this,SLOT(_verticalScrollBarActionTriggered(int)));
+    connect(verticalScrollBar(),SIGNAL(valueChanged(int)),this,SLOT(_verticalScrollBarValueChanged(int)));
+    connect(horizontalScrollBar(),SIGNAL(valueChanged(int)),this,SLOT(_horizontalScrollBarValueChanged(int)));
+    connect(pHeader,SIGNAL(sectionResized(int,int,int)),this,SLOT(_sectionResized()));
+
+    _updateGeometry();
+}
+
+void XDisasmView::setModel(XDisasmModel *pModel)
+{
+    if(this->pModel)
+    {
+        disconnect(this->pModel,nullptr,this,nullptr);
+    }
+
+    this->pModel=pModel;
+
+    pHeader->setModel(pModel);
+
+    if(pModel)
+    {
+        connect(pModel,SIGNAL(modelReset()),this,SLOT(reload()));
+    }
+
+    nTopPosition=0;
+    nCurrentPosition=-1;
+    nSelectionAnchor=-1;
+    nActionTopPosition=-1;
+
+    if(_getPositionCount())
+    {
+        nCurrentPosition=0;
+        nSelectionAnchor=0;
+    }
+
+    nRowsPosition=-1;
+    listRows.clear();
+
+    _updateGeometry();
+
+    emit currentPositionChanged(nCurrentPosition);
+}
+
+XDisasmModel *XDisasmView::getModel()
+{
+    return pModel;
+}
+
+QHeaderView *XDisasmView::horizontalHeader()
+{
+    return pHeader;
+}
+
+void XDisasmView::setColumnWidth(int nColumn, int nWidth)
+{
+    pHeader->resizeSection(nColumn,nWidth);
+}
+
+void XDisasmView::reload()
+{
+    if(pModel)
+    {
+        pModel->resetCache();
+    }
+
+    nRowsPosition=-1;
+    listRows.clear();
+
+    qint64 nPositionCount=_getPositionCount();
+
+    if(nPositionCount)
+    {
+        nCurrentPosition=qBound((qint64)0,nCurrentPosition,nPositionCount-1);
+        nSelectionAnchor=qBound((qint64)0,nSelectionAnchor,nPositionCount-1);
+    }
+    else
+    {
+        nCurrentPosition=-1;
+        nSelectionAnchor=-1;
+    }
+
+    nTopPosition=qMin(nTopPosition,_getMaxTopPosition());
+
+    _updateScrollBars();
+
+    viewport()->update();
+}
+
+qint64 XDisasmView::getCurrentPosition()
+{
+    return nCurrentPosition;
+}
+
+void XDisasmView::setCurrentPosition(qint64 nPosition)
+{
+    if((nPosition>=0)&&(nPosition<_getPositionCount()))
+    {
+        if((nPosition<nTopPosition)||(nPosition>=nTopPosition+_getVisibleRows()))
+        {
+            _setTopPosition(nPosition);
+        }
+
+        _moveCurrent(nPosition,false);
+    }
+}
+
+void XDisasmView::getSelection(qint64 *pnStart, qint64 *pnEnd)
+{
+    *pnStart=qMin(nSelectionAnchor,nCurrentPosition);
+    *pnEnd=qMax(nSelectionAnchor,nCurrentPosition);
+}
+
+void XDisasmView::setSelection(qint64 nStart, qint64 nEnd)
+{
+    qint64 nPositionCount=_getPositionCount();
+
+    if(nPositionCount)
+    {
+        nSelectionAnchor=qBound((qint64)0,nStart,nPositionCount-1);
+
+        _moveCurrent(nEnd,true);
+    }
+}
+
+void XDisasmView::selectAll()
+{
+    // The selection is a range of positions, its size does not matter
+    setSelection(0,_getPositionCount()-1);
+}
+
+QColor XDisasmView::windowClassToColor(XDisasm::WC wc)
+{
+    QColor result;
+
+    switch(wc)
+    {
+        case XDisasm::WC_DATA:      result=QColor(255,250,220);     break;
+        case XDisasm::WC_ZERO:      result=QColor(235,235,235);     break;
+        case XDisasm::WC_PACKED:    result=QColor(255,225,225);     break;
+        default:                                                    break;
+    }
+
+    return result;
+}
+
+void XDisasmView::paintEvent(QPaintEvent *pEvent)
+{
+    XDISASM_TRACE("XDisasmView::paintEvent");
+
+    QPainter painter(viewport());
+
+    painter.fillRect(pEvent->rect(),palette().base());
+
+    if(pModel)
+    {
+        _updateRows();
+
+        qint64 nSelectionStart=-1;
+        qint64 nSelectionEnd=-1;
+
+        getSelection(&nSelectionStart,&nSelectionEnd);
+
+        int nWidth=viewport()->width();
+        int nNumberOfRows=listRows.count();
+        int nNumberOfColumns=pHeader->count();
+
+        for(int i=0;i<nNumberOfRows;i++)
+        {
+            qint64 nPosition=nTopPosition+i;
+            QRect rectRow(0,i*nRowHeight,nWidth,nRowHeight);
+
+            bool bSelected=(nPosition>=nSelectionStart)&&(nPosition<=nSelectionEnd);
+
+            if(bSelected)
+            {
+                painter.fillRect(rectRow,palette().highlight());
+                painter.setPen(palette().color(QPalette::HighlightedText));
+            }
+            else
+            {
+                QColor color=windowClassToColor(pModel->getWindowClass(nPosition));
+
+                if(color.isValid())
+                {
+                    painter.fillRect(rectRow,color);
+                }
+
+                painter.setPen(palette().color(QPalette::Text));
+            }
+
+            const XDisasmModel::VEIW_RECORD &record=listRows.at(i);
+
+            for(int j=0;j<nNumberOfColumns;j++)
+            {
+                QString sText;
+
+                switch(j)
+                {
+                    case XDisasmModel::DMCOLUMN_ADDRESS:    sText=record.sAddress;      break;
+                    case XDisasmModel::DMCOLUMN_OFFSET:     sText=record.sOffset;       break;
+                    case XDisasmModel::DMCOLUMN_LABEL:      sText=record.sLabel;        break;
+                    case XDisasmModel::DMCOLUMN_BYTES:      sText=record.sBytes;        break;
+                    case XDisasmModel::DMCOLUMN_OPCODE:     sText=record.sOpcode;       break;
+                }
+
+                if(sText!="")
+                {
+                    QRect rectCell(pHeader->sectionViewportPosition(j)+N_CELL_MARGIN,rectRow.top(),pHeader->sectionSize(j)-2*N_CELL_MARGIN,nRowHeight);
+
+                    if((rectCell.width()>0)&&(rectCell.right()>=0)&&(rectCell.left()<nWidth))
+                    {
+                        painter.drawText(rectCell,Qt::AlignLeft|Qt::AlignVCenter,fontMetrics().elidedText(sText,Qt::ElideRight,rectCell.width()));
+                    }
+                }
+            }
+
+            if(nPosition==nCurrentPosition)
+            {
+                QStyleOptionFocusRect option;
+                option.initFrom(this);
+                option.rect=rectRow;
+                option.backgroundColor=palette().color(bSelected?QPalette::Highlight:QPalette::Base);
+
+                style()->drawPrimitive(QStyle::PE_FrameFocusRect,&option,&painter,this);
+            }
+        }
+    }
+}
+
+void XDisasmView::resizeEvent(QResizeEvent *pEvent)
+{
+    QAbstractScrollArea::resizeEvent(pEvent);
+
+    _updateGeometry();
+}
+
+void XDisasmView::changeEvent(QEvent *pEvent)
+{
+    QAbstractScrollArea::changeEvent(pEvent);
+
+    if(pEvent->type()==QEvent::FontChange)
+    {
+        pHeader->setFont(font());
+
+        _updateGeometry();
+    }
+}
+
+void XDisasmView::keyPressEvent(QKeyEvent *pEvent)
+{
+    qint64 nPosition=0;
+    qint64 nVisibleRows=qMax(_getVisibleRows(),(qint64)1);
+    bool bNavigation=false; // the position may be out of range, _moveCurrent clamps it
+
+    if(nCurrentPosition!=-1)
+    {
+        bNavigation=true;
+
+        switch(pEvent->key())
+        {
+            case Qt::Key_Up:            nPosition=nCurrentPosition-1;               break;
+            case Qt::Key_Down:          nPosition=nCurrentPosition+1;               break;
+            case Qt::Key_PageUp:        nPosition=nCurrentPosition-nVisibleRows;    break;
+            case Qt::Key_PageDown:      nPosition=nCurrentPosition+nVisibleRows;    break;
+            case Qt::Key_Home:          nPosition=0;                                break;
+            case Qt::Key_End:           nPosition=_getPositionCount()-1;            break;
+            default:                    bNavigation=false;                          break;
+        }
+    }
+
+    if(bNavigation)
+    {
+        _moveCurrent(nPosition,pEvent->modifiers()&Qt::ShiftModifier);
+    }
+    else if(pEvent->matches(QKeySequence::SelectAll))
+    {
+        selectAll();
+    }
+    else
+    {
+        QAbstractScrollArea::keyPressEvent(pEvent);
+    }
+}
+
+void XDisasmView::mousePressEvent(QMouseEvent *pEvent)
+{
+    qint64 nPosition=_getPosition(pEvent->pos().y());
+
+    if(nPosition!=-1)
+    {
+        if(pEvent->button()==Qt::LeftButton)
+        {
+            _moveCurrent(nPosition,pEvent->modifiers()&Qt::ShiftModifier);
+        }
+        else if(pEvent->button()==Qt::RightButton)
+        {
+            qint64 nSelectionStart=-1;
+            qint64 nSelectionEnd=-1;
+
+            getSelection(&nSelectionStart,&nSelectionEnd);
+
+            // The context menu works with the selection, a click outside of it selects the row
+            if((nPosition<nSelectionStart)||(nPosition>nSelectionEnd))
+            {
+                _moveCurrent(nPosition,false);
+            }
+        }
+    }
+
+    QAbstractScrollArea::mousePressEvent(pEvent);
+}
+
+void XDisasmView::mouseMoveEvent(QMouseEvent *pEvent)
+{
+    if((pEvent->buttons()&Qt::LeftButton)&&(nCurrentPosition!=-1))
+    {
+        int nY=pEvent->pos().y();
+        qint64 nPosition=-1;
+
+        if(nY<0)
+        {
+            nPosition=nTopPosition-1;
+        }
+        else if(nY>=viewport()->height())
+        {
+            nPosition=nTopPosition+_getVisibleRows();
+        }
+        else
+        {
+            nPosition=qMin(nTopPosition+nY/nRowHeight,_getPositionCount()-1);
+        }
+
+        _moveCurrent(qMax(nPosition,(qint64)0),true);
+    }
+
+    QAbstractScrollArea::mouseMoveEvent(pEvent);
+}
+
+void XDisasmView::wheelEvent(QWheelEvent *pEvent)
+{
+    int nDelta=pEvent->angleDelta().y();
+
+    if(nDelta)
+    {
+        // Touchpads send small steps
+        nWheelDelta+=nDelta;
+
+        int nSteps=nWheelDelta/120;
+
+        nWheelDelta-=nSteps*120;
+
+        if(nSteps)
+        {
+            _setTopPosition(nTopPosition-nSteps*N_WHEEL_ROWS);
+        }
+
+        pEvent->accept();
+    }
+    else
+    {
+        QAbstractScrollArea::wheelEvent(pEvent);
+    }
+}
+
+bool XDisasmView::viewportEvent(QEvent *pEvent)
+{
+    bool bResult=false;
+
+    if((pEvent->type()==QEvent::ToolTip)&&pModel)
+    {
+        QHelpEvent *pHelpEvent=static_cast<QHelpEvent *>(pEvent);
+
+        QString sToolTip;
+
+        if(pModel->getShowOptions()->bShowEntropy)
+        {
+            qint64 nPosition=_getPosition(pHelpEvent->pos().y());
+
+            if(nPosition!=-1)
+            {
+                sToolTip=pModel->getWindowToolTip(nPosition);
+            }
+        }
+
+        if(sToolTip!="")
+        {
+            QToolTip::showText(pHelpEvent->globalPos(),sToolTip,viewport());
+        }
+        else
+        {
+            QToolTip::hideText();
+            pEvent->ignore();
+        }
+
+        bResult=true;
+    }
+    else
+    {
+        bResult=QAbstractScrollArea::viewportEvent(pEvent);
+    }
+
+    return bResult;
+}
+
+void XDisasmView::_verticalScrollBarActionTriggered(int nAction)
+{
+    qint64 nPosition=-1;
+    qint64 nVisibleRows=qMax(_getVisibleRows(),(qint64)1);
+
+    switch(nAction)
+    {
+        case QAbstractSlider::SliderSingleStepAdd:  nPosition=nTopPosition+1;                               break;
+        case QAbstractSlider::SliderSingleStepSub:  nPosition=qMax(nTopPosition-1,(qint64)0);               break;
+        case QAbstractSlider::SliderPageStepAdd:    nPosition=nTopPosition+nVisibleRows;                    break;
+        case QAbstractSlider::SliderPageStepSub:    nPosition=qMax(nTopPosition-nVisibleRows,(qint64)0);    break;
+        case QAbstractSlider::SliderToMinimum:      nPosition=0;                                            break;
+        case QAbstractSlider::SliderToMaximum:      nPosition=_getMaxTopPosition();                         break;
+    }
+
+    // With the proportional mapping a step can be smaller than one value of the scroll bar,
+    // the exact top position is kept and the slider only follows it
+    if(nPosition!=-1)
+    {
+        nPosition=qMin(nPosition,_getMaxTopPosition());
+
+        int nValue=_topPositionToValue(nPosition);
+
+        if(nValue==verticalScrollBar()->value())
+        {
+            nActionTopPosition=-1;
+            verticalScrollBar()->setSliderPosition(nValue);
+
+            if(nTopPosition!=nPosition)
+            {
+                nTopPosition=nPosition;
+                viewport()->update();
+            }
+        }
+        else
+        {
+            nActionTopPosition=nPosition;
+            verticalScrollBar()->setSliderPosition(nValue);
+        }
+    }
+}
+
+void XDisasmView::_verticalScrollBarValueChanged(int nValue)
+{
+    if(!bUpdateScrollBars)
+    {
+        if(nActionTopPosition!=-1)
+        {
+            nTopPosition=nActionTopPosition;
+            nActionTopPosition=-1;
+        }
+        else
+        {
+            nTopPosition=_valueToTopPosition(nValue);
+        }
+
+        viewport()->update();
+    }
+}
+
+void XDisasmView::_horizontalScrollBarValueChanged(int nValue)
+{
+    pHeader->setOffset(nValue);
+
+    viewport()->update();
+}
+
+void XDisasmView::_sectionResized()
+{
+    _updateScrollBars();
+
+    viewport()->update();
+}
+
+qint64 XDisasmView::_getPositionCount()
+{
+    qint64 nResult=0;
+
+    if(pModel)
+    {
+        nResult=pModel->getPositionCount();
+    }
+
+    return nResult;
+}
+
+qint64 XDisasmView::_getVisibleRows()
+{
+    return viewport()->height()/nRowHeight;
+}
+
+qint64 XDisasmView::_getMaxTopPosition()
+{
+    return qMax(_getPositionCount()-_getVisibleRows(),(qint64)0);
+}
+
+qint64 XDisasmView::_getPosition(int nY)
+{
+    qint64 nResult=-1;
+
+    if(nY>=0)
+    {
+        qint64 nPosition=nTopPosition+nY/nRowHeight;
+
+        if(nPosition<_getPositionCount())
+        {
+            nResult=nPosition;
+        }
+    }
+
+    return nResult;
+}
+
+qint64 XDisasmView::_valueToTopPosition(int nValue)
+{
+    qint64 nResult=nValue;
+    qint64 nMaxTopPosition=_getMaxTopPosition();
+
+    if(nMaxTopPosition>N_SCROLL_MAX)
+    {
+        nResult=(qint64)(((double)nValue*nMaxTopPosition)/N_SCROLL_MAX);
+    }
+
+    return nResult;
+}
+
+int XDisasmView::_topPositionToValue(qint64 nPosition)
+{
+    int nResult=(int)nPosition;
+    qint64 nMaxTopPosition=_getMaxTopPosition();
+
+    if(nMaxTopPosition>N_SCROLL_MAX)
+    {
+        nResult=(int)(((double)nPosition*N_SCROLL_MAX)/nMaxTopPosition);
+    }
+
+    return nResult;
+}
+
+void XDisasmView::_setTopPosition(qint64 nPosition)
+{
+    nPosition=qBound((qint64)0,nPosition,_getMaxTopPosition());
+
+    if(nTopPosition!=nPosition)
+    {
+        nTopPosition=nPosition;
+
+        _updateScrollBars();
+
+        viewport()->update();
+    }
+}
+
+void XDisasmView::_moveCurrent(qint64 nPosition, bool bExtend)
+{
+    qint64 nPositionCount=_getPositionCount();
+
+    if(nPositionCount)
+    {
+        nPosition=qBound((qint64)0,nPosition,nPositionCount-1);
+
+        if(!bExtend)
+        {
+            nSelectionAnchor=nPosition;
+        }
+
+        qint64 nVisibleRows=qMax(_getVisibleRows(),(qint64)1);
+
+        if(nPosition<nTopPosition)
+        {
+            _setTopPosition(nPosition);
+        }
+        else if(nPosition>=nTopPosition+nVisibleRows)
+        {
+            _setTopPosition(nPosition-nVisibleRows+1);
+        }
+
+        if(nCurrentPosition!=nPosition)
+        {
+            nCurrentPosition=nPosition;
+
+            emit currentPositionChanged(nPosition);
+        }
+
+        viewport()->update();
+    }
+}
+
+void XDisasmView::_updateGeometry()
+{
+    nRowHeight=qMax(fontMetrics().height()+4,1);
+
+    int nHeaderHeight=pHeader->sizeHint().height();
+
+    setViewportMargins(0,nHeaderHeight,0,0);
+
+    QRect rectViewport=viewport()->geometry();
+
+    pHeader->setGeometry(rectViewport.left(),rectViewport.top()-nHeaderHeight,rectViewport.width(),nHeaderHeight);
+
+    nTopPosition=qMin(nTopPosition,_getMaxTopPosition());
+
+    _updateScrollBars();
+
+    viewport()->update();
+}
+
+void XDisasmView::_updateScrollBars()
+{
+    bUpdateScrollBars=true;
+
+    qint64 nVisibleRows=_getVisibleRows();
+    qint64 nMaxTopPosition=_getMaxTopPosition();
+
+    QScrollBar *pScrollBar=verticalScrollBar();
+
+    if(nMaxTopPosition>N_SCROLL_MAX)
+    {
+        pScrollBar->setRange(0,N_SCROLL_MAX);
+        pScrollBar->setPageStep((int)qMax((qint64)(((double)nVisibleRows*N_SCROLL_MAX)/nMaxTopPosition),(qint64)1));
+    }
+    else
+    {
+        pScrollBar->setRange(0,(int)nMaxTopPosition);
+        pScrollBar->setPageStep((int)nVisibleRows);
+    }
+
+    pScrollBar->setSingleStep(1);
+    pScrollBar->setValue(_topPositionToValue(nTopPosition));
+
+    int nWidth=viewport()->width();
+
+    horizontalScrollBar()->setRange(0,qMax(pHeader->length()-nWidth,0));
+    horizontalScrollBar()->setPageStep(nWidth);
+
+    bUpdateScrollBars=false;
+}
+
+void XDisasmView::_updateRows()
+{
+    qint64 nPositionCount=_getPositionCount();
+    qint64 nNumberOfRows=(viewport()->height()+nRowHeight-1)/nRowHeight;
+
+    nNumberOfRows=qMax(qMin(nNumberOfRows,nPositionCount-nTopPosition),(qint64)0);
+
+    if((nRowsPosition!=nTopPosition)||(listRows.count()!=nNumberOfRows))
+    {
+        // Rows that stay on the screen are not formatted again
+        QVector<XDisasmModel::VEIW_RECORD> listNewRows((int)nNumberOfRows);
+
+        for(int i=0;i<nNumberOfRows;i++)
+        {
+            qint64 nOldIndex=(nTopPosition+i)-nRowsPosition;
+
+            if((nRowsPosition!=-1)&&(nOldIndex>=0)&&(nOldIndex<listRows.count()))
+            {
+                listNewRows[i]=listRows.at((int)nOldIndex);
+            }
+            else
+            {
+                listNewRows[i]=pModel->getViewRecord(nTopPosition+i);
+            }
+        }
+
+        listRows=listNewRows;
+        nRowsPosition=nTopPosition;
+    }
+}
@@ -0,0 +1,109 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef XDISASMVIEW_H
+#define XDISASMVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QHeaderView>
+#include <QScrollBar>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QHelpEvent>
+#include <QToolTip>
+#include <QStyleOptionFocusRect>
+#include "xdisasmmodel.h"
+
+// The listing: paints only the visible rows and works with the 64-bit positions of the model,
+// the model is never asked about the rows that are not on the screen
+class XDisasmView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+    static const int N_SCROLL_MAX=0x40000000; // the scroll bar is int, bigger position counts are mapped proportionally
+    static const int N_WHEEL_ROWS=3;
+    static const int N_CELL_MARGIN=3;
+
+public:
+    explicit XDisasmView(QWidget *pParent=nullptr);
+    void setModel(XDisasmModel *pModel); // 0 - empty view
+    XDisasmModel *getModel();
+    QHeaderView *horizontalHeader();
+    void setColumnWidth(int nColumn,int nWidth);
+    qint64 getCurrentPosition(); // -1 if the view is empty
+    void setCurrentPosition(qint64 nPosition); // the row is scrolled to the top if it is not visible
+    void getSelection(qint64 *pnStart,qint64 *pnEnd); // inclusive, -1 if the view is empty
+    void setSelection(qint64 nStart,qint64 nEnd); // nEnd becomes the current position
+    void selectAll();
+    static QColor windowClassToColor(XDisasm::WC wc);
+
+public slots:
+    void reload(); // the stats of the model have changed
+
+signals:
+    void currentPositionChanged(qint64 nPosition);
+
+protected:
+    void paintEvent(QPaintEvent *pEvent) override;
+    void resizeEvent(QResizeEvent *pEvent) override;
+    void changeEvent(QEvent *pEvent) override;
+    void keyPressEvent(QKeyEvent *pEvent) override;
+    void mousePressEvent(QMouseEvent *pEvent) override;
+    void mouseMoveEvent(QMouseEvent *pEvent) override;
+    void wheelEvent(QWheelEvent *pEvent) override;
+    bool viewportEvent(QEvent *pEvent) override;
+
+private slots:
+    void _verticalScrollBarActionTriggered(int nAction);
+    void _verticalScrollBarValueChanged(int nValue);
+    void _horizontalScrollBarValueChanged(int nValue);
+    void _sectionResized();
+
+private:
+    qint64 _getPositionCount();
+    qint64 _getVisibleRows(); // whole rows
+    qint64 _getMaxTopPosition();
+    qint64 _getPosition(int nY); // -1 if there is no row
+    qint64 _valueToTopPosition(int nValue);
+    int _topPositionToValue(qint64 nPosition);
+    void _setTopPosition(qint64 nPosition);
+    void _moveCurrent(qint64 nPosition,bool bExtend); // bExtend: the anchor of the selection is kept
+    void _updateGeometry();
+    void _updateScrollBars();
+    void _updateRows();
+
+private:
+    XDisasmModel *pModel;
+    QHeaderView *pHeader;
+    int nRowHeight;
+    int nWheelDelta;
+    qint64 nTopPosition;
+    qint64 nCurrentPosition;
+    qint64 nSelectionAnchor;
+    qint64 nActionTopPosition; // -1 if the value of the scroll bar is not set by a step
+    bool bUpdateScrollBars; // the scroll bars are set by the view
+    qint64 nRowsPosition; // position of listRows.at(0), -1 if the cache is empty
+    QVector<XDisasmModel::VEIW_RECORD> listRows; // the visible rows
+};
+
+#endif // XDISASMVIEW_H
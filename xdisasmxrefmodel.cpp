@@ -0,0 +1,177 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#include "xdisasmxrefmodel.h"
+
+XDisasmXrefModel::XDisasmXrefModel(QSharedPointer<XDisasm::STATS> pSnapshot, QObject *pParent)
+    : QAbstractTableModel(pParent)
+{
+    this->pSnapshot=pSnapshot;
+    pStats=pSnapshot.data();
+
+    nAddress=-1;
+    pRefFrom=0;
+    nRefFromCount=0;
+    pRefTo=0;
+    nRefToCount=0;
+}
+
+void XDisasmXrefModel::setAddress(qint64 nAddress)
+{
+    beginResetModel();
+
+    this->nAddress=nAddress;
+
+    pRefFrom=XDisasm::getRefFrom(pStats,nAddress,&nRefFromCount);
+    pRefTo=XDisasm::getRefTo(pStats,nAddress,&nRefToCount);
+
+    endResetModel();
+}
+
+void XDisasmXrefModel::setSnapshot(QSharedPointer<XDisasm::STATS> pSnapshot)
+{
+    beginResetModel();
+
+    this->pSnapshot=pSnapshot;
+    pStats=pSnapshot.data();
+
+    pRefFrom=XDisasm::getRefFrom(pStats,nAddress,&nRefFromCount);
+    pRefTo=XDisasm::getRefTo(pStats,nAddress,&nRefToCount);
+
+    endResetModel();
+}
+
+qint64 XDisasmXrefModel::getAddress()
+{
+    return nAddress;
+}
+
+qint64 XDisasmXrefModel::rowToAddress(int nRow) const
+{
+    qint64 nResult=-1;
+
+    if((nRow>=0)&&(nRow<nRefFromCount))
+    {
+        nResult=pRefFrom[nRow];
+    }
+    else if((nRow>=nRefFromCount)&&(nRow<(nRefFromCount+nRefToCount)))
+    {
+        nResult=pRefTo[nRow-nRefFromCount];
+    }
+
+    return nResult;
+}
+
+QVariant XDisasmXrefModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    QVariant result;
+
+    if(orientation==Qt::Horizontal)
+    {
+        if(role==Qt::DisplayRole)
+        {
+            switch(section)
+            {
+                case XCOLUMN_DIRECTION: result=tr("Direction");     break;
+                case XCOLUMN_ADDRESS:   result=tr("Address");       break;
+                case XCOLUMN_LABEL:     result=tr("Label");         break;
+            }
+        }
+    }
+
+    return result;
+}
+
+int XDisasmXrefModel::rowCount(const QModelIndex &parent) const
+{
+    int nResult=nRefFromCount+nRefToCount;
+
+    if(parent.isValid())
+    {
+        nResult=0;
+    }
+
+    return nResult;
+}
+
+int XDisasmXrefModel::columnCount(const QModelIndex &parent) const
+{
+    int nResult=__XCOLUMN_SIZE;
+
+    if(parent.isValid())
+    {
+        nResult=0;
+    }
+
+    return nResult;
+}
+
+QVariant XDisasmXrefModel::data(const QModelIndex &index, int role) const
+{
+    QVariant result;
+
+    if(index.isValid())
+    {
+        int nRow=index.row();
+
+        qint64 nRefAddress=rowToAddress(nRow);
+
+        if(role==Qt::DisplayRole)
+        {
+            switch(index.column())
+            {
+                case XCOLUMN_DIRECTION:     result=(nRow<nRefFromCount)?tr("From"):tr("To");                        break;
+                case XCOLUMN_ADDRESS:       result=QString("0x%1").arg(nRefAddress,0,16);                           break;
+                case XCOLUMN_LABEL:         result=getNearestLabelString(nRefAddress);                              break;
+            }
+        }
+        else if(role==Qt::UserRole)
+        {
+            result=nRefAddress;
+        }
+    }
+
+    return result;
+}
+
+QString XDisasmXrefModel::getNearestLabelString(qint64 nAddress) const
+{
+    QString sResult;
+
+    // The last label at or before the address
+    const XDisasm::LABEL *pBegin=pStats->listLabels.constData();
+    const XDisasm::LABEL *pEnd=pBegin+pStats->listLabels.count();
+
+    const XDisasm::LABEL *pLabel=std::upper_bound(pBegin,pEnd,nAddress,[](qint64 nValue,const XDisasm::LABEL &label){return nValue<label.nAddress;});
+
+    if(pLabel!=pBegin)
+    {
+        pLabel--;
+
+        sResult=XDisasm::labelToString(pStats,pLabel);
+
+        if(pLabel->nAddress!=nAddress)
+        {
+            sResult+=QString("+0x%1").arg(nAddress-pLabel->nAddress,0,16);
+        }
+    }
+
+    return sResult;
+}
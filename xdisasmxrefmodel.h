@@ -0,0 +1,64 @@
+// copyright (c) 2020 hors<horsicq@gmail.com>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+#ifndef XDISASMXREFMODEL_H
+#define XDISASMXREFMODEL_H
+
+#include <QAbstractTableModel>
+#include "xdisasm.h"
+
+// Cross references of one address: the instructions that refer to it, then its own targets.
+// Rows are read directly from the xref indexes of a STATS snapshot.
+class XDisasmXrefModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum XCOLUMN
+    {
+        XCOLUMN_DIRECTION=0,
+        XCOLUMN_ADDRESS,
+        XCOLUMN_LABEL,
+        __XCOLUMN_SIZE
+    };
+
+    explicit XDisasmXrefModel(QSharedPointer<XDisasm::STATS> pSnapshot,QObject *pParent);
+    void setSnapshot(QSharedPointer<XDisasm::STATS> pSnapshot); // the rows of the current address are read again
+    void setAddress(qint64 nAddress);
+    qint64 getAddress();
+    qint64 rowToAddress(int nRow) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role=Qt::DisplayRole) const override;
+    int rowCount(const QModelIndex &parent=QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent=QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role=Qt::DisplayRole) const override;
+
+private:
+    QString getNearestLabelString(qint64 nAddress) const;
+
+    QSharedPointer<XDisasm::STATS> pSnapshot; // keeps the indexes of pRefFrom and pRefTo alive
+    XDisasm::STATS *pStats;
+    qint64 nAddress;
+    const qint64 *pRefFrom;
+    qint32 nRefFromCount;
+    const qint64 *pRefTo;
+    qint32 nRefToCount;
+};
+
+#endif // XDISASMXREFMODEL_H